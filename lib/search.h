@@ -18,6 +18,7 @@ typedef enum mc_search_cbret_t mc_search_cbret_t;
 typedef mc_search_cbret_t (*mc_search_fn) (const void *user_data, gsize char_offset,
                                            int *current_char);
 typedef mc_search_cbret_t (*mc_update_fn) (const void *user_data, gsize char_offset);
+typedef const char *(*mc_search_span_fn) (const void *user_data, gsize char_offset, gsize * len);
 
 #define MC_SEARCH__NUM_REPLACE_ARGS 64
 
@@ -84,6 +85,10 @@ typedef struct mc_search_struct
     /* function, used for getting data. NULL if not used */
     mc_search_fn search_fn;
 
+    /* function, used for getting data by contiguous spans, preferred to search_fn if both are set.
+       Returns NULL beyond the end of data. NULL if not used */
+    mc_search_span_fn span_fn;
+
     /* function, used for updatin current search status. NULL if not used */
     mc_update_fn update_fn;
 
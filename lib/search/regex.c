@@ -900,7 +900,40 @@ mc_search__run_regex (mc_search_t * lc_mc_search, const void *user_data,
         g_string_set_size (lc_mc_search->regex_buffer, 0);
         lc_mc_search->start_buffer = current_pos;
 
-        if (lc_mc_search->search_fn != NULL)
+        if (lc_mc_search->span_fn != NULL)
+        {
+            /* copy data to regex buffer by spans up to the end of line */
+            ret = MC_SEARCH_CB_OK;
+
+            while (virtual_pos <= end_search)
+            {
+                const char *span, *nl;
+                gsize len;
+
+                span = lc_mc_search->span_fn (user_data, virtual_pos, &len);
+                if (span == NULL)
+                {
+                    /* stop search symbol beyond the end of data */
+                    g_string_append_c (lc_mc_search->regex_buffer, '\n');
+                    virtual_pos++;
+                    break;
+                }
+
+                len = MIN (len, end_search - virtual_pos + 1);
+                nl = memchr (span, '\n', len);
+                if (nl != NULL)
+                    len = nl - span + 1;
+
+                g_string_append_len (lc_mc_search->regex_buffer, span, len);
+                virtual_pos += len;
+
+                if (nl != NULL)
+                    break;
+            }
+
+            current_pos = virtual_pos;
+        }
+        else if (lc_mc_search->search_fn != NULL)
         {
             while (TRUE)
             {
@@ -99,16 +99,17 @@
 #define LINE_STATE_COLOR          mc_skin_color__cache[58]
 #define BOOK_MARK_COLOR           mc_skin_color__cache[59]
 #define BOOK_MARK_FOUND_COLOR     mc_skin_color__cache[60]
+#define EDITOR_SPELL_COLOR        mc_skin_color__cache[61]
 
 /* Diff colors */
-#define DFF_ADD_COLOR             mc_skin_color__cache[61]
-#define DFF_CHG_COLOR             mc_skin_color__cache[62]
-#define DFF_CHH_COLOR             mc_skin_color__cache[63]
-#define DFF_CHD_COLOR             mc_skin_color__cache[64]
-#define DFF_DEL_COLOR             mc_skin_color__cache[65]
-#define DFF_ERROR_COLOR           mc_skin_color__cache[66]
-
-#define MC_SKIN_COLOR_CACHE_COUNT 67
+#define DFF_ADD_COLOR             mc_skin_color__cache[62]
+#define DFF_CHG_COLOR             mc_skin_color__cache[63]
+#define DFF_CHH_COLOR             mc_skin_color__cache[64]
+#define DFF_CHD_COLOR             mc_skin_color__cache[65]
+#define DFF_DEL_COLOR             mc_skin_color__cache[66]
+#define DFF_ERROR_COLOR           mc_skin_color__cache[67]
+
+#define MC_SKIN_COLOR_CACHE_COUNT 68
 
 /*** enums ***************************************************************************************/
 
@@ -68,6 +68,7 @@ static const mc_skin_colors_old_t old_colors[] = {
     {"editlinestate", "editor", "editlinestate"},
     {"editmarked", "editor", "editmarked"},
     {"editnormal", "editor", "_default_"},
+    {"editspell", "editor", "editspell"},
     {"editwhitespace", "editor", "editwhitespace"},
     {"errdhotfocus", "error", "errdhotfocus"},
     {"errdhotnormal", "error", "errdhotnormal"},
@@ -310,6 +310,7 @@ mc_skin_color_cache_init (void)
 
     BOOK_MARK_COLOR = mc_skin_color_get ("editor", "bookmark");
     BOOK_MARK_FOUND_COLOR = mc_skin_color_get ("editor", "bookmarkfound");
+    EDITOR_SPELL_COLOR = mc_skin_color_get ("editor", "editspell");
 
     DFF_ADD_COLOR = mc_skin_color_get ("diffviewer", "added");
     DFF_CHG_COLOR = mc_skin_color_get ("diffviewer", "changedline");
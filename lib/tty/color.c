@@ -61,6 +61,9 @@ gboolean use_colors = FALSE;
 
 static GHashTable *mc_tty_color__hashtable = NULL;
 
+/* incremented each time temporary color pairs are freed */
+static unsigned int tty_color_tmp_generation = 0;
+
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 
@@ -216,6 +219,19 @@ void
 tty_color_free_all_tmp (void)
 {
     tty_color_free_all (TRUE);
+    tty_color_tmp_generation++;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get the generation of temporary color pairs. Indexes of temporary color pairs allocated
+ * in some generation are valid until the generation is changed.
+ */
+
+unsigned int
+tty_color_get_tmp_generation (void)
+{
+    return tty_color_tmp_generation;
 }
 
 /* --------------------------------------------------------------------------------------------- */
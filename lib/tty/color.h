@@ -40,6 +40,7 @@ int tty_try_alloc_color_pair2 (const char *, const char *, const char *, gboolea
 
 void tty_color_free_all_tmp (void);
 void tty_color_free_all_non_tmp (void);
+unsigned int tty_color_get_tmp_generation (void);
 
 void tty_setcolor (int color);
 void tty_lowlevel_setcolor (int color);
@@ -44,6 +44,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #ifdef __linux__
 #ifdef HAVE_LINUX_FS_H
@@ -730,6 +731,53 @@ vfs_preallocate (int dest_vfs_fd, off_t src_fsize, off_t dest_fsize)
     return posix_fallocate (*(int *) dest_fd, dest_fsize, src_fsize - dest_fsize);
 
 #endif /* HAVE_POSIX_FALLOCATE */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get system file descriptor of local file opened by mc_open().
+ *
+ * @param vfs_fd mc VFS file handler
+ *
+ * @return file descriptor, -1 if file is not local
+ */
+
+int
+vfs_get_local_fd (int vfs_fd)
+{
+    void *fd = NULL;
+    struct vfs_class *vclass;
+
+    vclass = vfs_class_find_by_handle (vfs_fd, &fd);
+    if (vclass == NULL || (vclass->flags & VFSF_LOCAL) == 0 || fd == NULL)
+        return (-1);
+
+    return *(int *) fd;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Flush data of local file opened by mc_open() to the storage device.
+ *
+ * @param vfs_fd mc VFS file handler
+ *
+ * @return 0 if success or file is not local, -1 otherwise
+ */
+
+int
+vfs_fdatasync (int vfs_fd)
+{
+    int fd;
+
+    fd = vfs_get_local_fd (vfs_fd);
+    if (fd == -1)
+        return 0;
+
+#ifdef HAVE_FDATASYNC
+    return fdatasync (fd);
+#else
+    return fsync (fd);
+#endif
 }
 
  /* --------------------------------------------------------------------------------------------- */
@@ -303,6 +303,8 @@ void vfs_setup_cwd (void);
 char *_vfs_get_cwd (void);
 
 int vfs_preallocate (int dest_desc, off_t src_fsize, off_t dest_fsize);
+int vfs_get_local_fd (int vfs_fd);
+int vfs_fdatasync (int vfs_fd);
 
 int vfs_clone_file (int dest_vfs_fd, int src_vfs_fd);
 
@@ -56,85 +56,6 @@
 /*** file scope variables ************************************************************************/
 
 /*** file scope functions ************************************************************************/
-/* --------------------------------------------------------------------------------------------- */
-
-/** note, if there is more than one bookmark on a line, then they are
-   appended after each other and the last one is always the one found
-   by book_mark_found() i.e. last in is the one seen */
-
-static edit_book_mark_t *
-double_marks (WEdit * edit, edit_book_mark_t * p)
-{
-    (void) edit;
-
-    if (p->next != NULL)
-        while (p->next->line == p->line)
-            p = p->next;
-    return p;
-}
-
-/* --------------------------------------------------------------------------------------------- */
-/** returns the first bookmark on or before this line */
-
-edit_book_mark_t *
-book_mark_find (WEdit * edit, long line)
-{
-    edit_book_mark_t *p;
-
-    if (edit->book_mark == NULL)
-    {
-        /* must have an imaginary top bookmark at line -1 to make things less complicated  */
-        edit->book_mark = g_new0 (edit_book_mark_t, 1);
-        edit->book_mark->line = -1;
-        return edit->book_mark;
-    }
-
-    for (p = edit->book_mark; p != NULL; p = p->next)
-    {
-        if (p->line > line)
-            break;              /* gone past it going downward */
-
-        if (p->next != NULL)
-        {
-            if (p->next->line > line)
-            {
-                edit->book_mark = p;
-                return double_marks (edit, p);
-            }
-        }
-        else
-        {
-            edit->book_mark = p;
-            return double_marks (edit, p);
-        }
-    }
-
-    for (p = edit->book_mark; p != NULL; p = p->prev)
-    {
-        if (p->next != NULL && p->next->line <= line)
-            break;              /* gone past it going upward */
-
-        if (p->line <= line)
-        {
-            if (p->next != NULL)
-            {
-                if (p->next->line > line)
-                {
-                    edit->book_mark = p;
-                    return double_marks (edit, p);
-                }
-            }
-            else
-            {
-                edit->book_mark = p;
-                return double_marks (edit, p);
-            }
-        }
-    }
-
-    return NULL;                /* can't get here */
-}
-
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -151,18 +72,13 @@ book_mark_find (WEdit * edit, long line)
 gboolean
 book_mark_query_color (WEdit * edit, long line, int c)
 {
-    if (edit->book_mark != NULL)
-    {
-        edit_book_mark_t *p;
+    guint i;
 
-        for (p = book_mark_find (edit, line); p != NULL; p = p->prev)
-        {
-            if (p->line != line)
-                return FALSE;
-            if (p->c == c)
-                return TRUE;
-        }
-    }
+    for (i = edit_markers_find (&edit->book_marks, line);
+         i < edit_markers_count (&edit->book_marks)
+         && edit_markers_get_pos (&edit->book_marks, i) == line; i++)
+        if (edit_markers_get_value (&edit->book_marks, i) == c)
+            return TRUE;
 
     return FALSE;
 }
@@ -173,32 +89,7 @@ book_mark_query_color (WEdit * edit, long line, int c)
 void
 book_mark_insert (WEdit * edit, long line, int c)
 {
-    edit_book_mark_t *p, *q;
-
-    p = book_mark_find (edit, line);
-#if 0
-    if (p->line == line)
-    {
-        /* already exists, so just change the color */
-        if (p->c != c)
-        {
-            p->c = c;
-            edit->force |= REDRAW_LINE;
-        }
-        return;
-    }
-#endif
-    /* create list entry */
-    q = g_new (edit_book_mark_t, 1);
-    q->line = line;
-    q->c = c;
-    q->next = p->next;
-    /* insert into list */
-    q->prev = p;
-    if (p->next != NULL)
-        p->next->prev = q;
-    p->next = q;
-
+    edit_markers_insert (&edit->book_marks, line, c);
     edit->force |= REDRAW_LINE;
 }
 
@@ -215,30 +106,24 @@ book_mark_insert (WEdit * edit, long line, int c)
 gboolean
 book_mark_clear (WEdit * edit, long line, int c)
 {
-    edit_book_mark_t *p, *q;
+    guint i, found = 0;
     gboolean r = FALSE;
 
-    if (edit->book_mark == NULL)
-        return r;
-
-    for (p = book_mark_find (edit, line); p != NULL; p = q)
-    {
-        q = p->prev;
-        if (p->line == line && (p->c == c || c == -1))
+    /* if there is more than one bookmark on a line, the last one is removed */
+    for (i = edit_markers_find (&edit->book_marks, line);
+         i < edit_markers_count (&edit->book_marks)
+         && edit_markers_get_pos (&edit->book_marks, i) == line; i++)
+        if (edit_markers_get_value (&edit->book_marks, i) == c || c == -1)
         {
+            found = i;
             r = TRUE;
-            edit->book_mark = p->prev;
-            p->prev->next = p->next;
-            if (p->next != NULL)
-                p->next->prev = p->prev;
-            g_free (p);
-            edit->force |= REDRAW_LINE;
-            break;
         }
+
+    if (r)
+    {
+        edit_markers_remove (&edit->book_marks, found);
+        edit->force |= REDRAW_LINE;
     }
-    /* if there is only our dummy book mark left, clear it for speed */
-    if (edit->book_mark->line == -1 && edit->book_mark->next == NULL)
-        MC_PTR_FREE (edit->book_mark);
 
     return r;
 }
@@ -249,61 +134,67 @@ book_mark_clear (WEdit * edit, long line, int c)
 void
 book_mark_flush (WEdit * edit, int c)
 {
-    edit_book_mark_t *p, *q;
-
-    if (edit->book_mark == NULL)
-        return;
-
-    while (edit->book_mark->prev != NULL)
-        edit->book_mark = edit->book_mark->prev;
-
-    for (q = edit->book_mark->next; q != NULL; q = p)
-    {
-        p = q->next;
-        if (q->c == c || c == -1)
-        {
-            q->prev->next = q->next;
-            if (p != NULL)
-                p->prev = q->prev;
-            g_free (q);
-        }
-    }
-    if (edit->book_mark->next == NULL)
-        MC_PTR_FREE (edit->book_mark);
+    if (c == -1)
+        edit_markers_clean (&edit->book_marks);
+    else
+        edit_markers_remove_value (&edit->book_marks, c);
 
     edit->force |= REDRAW_PAGE;
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** shift down bookmarks after this line */
+/**
+ * Shift bookmarks after this line when lines are inserted or deleted below it. Bookmarks on
+ * deleted lines are moved to this line.
+ *
+ * @param edit editor object
+ * @param line line the change is made in
+ * @param delta number of inserted lines, negative if lines are deleted
+ */
 
 void
-book_mark_inc (WEdit * edit, long line)
+book_mark_shift (WEdit * edit, long line, long delta)
 {
-    if (edit->book_mark != NULL)
-    {
-        edit_book_mark_t *p;
+    edit_markers_shift (&edit->book_marks, line, delta);
+}
 
-        p = book_mark_find (edit, line);
-        for (p = p->next; p != NULL; p = p->next)
-            p->line++;
-    }
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the nearest bookmark below this line
+ *
+ * @param edit editor object
+ * @param line line to search from
+ * @return line of bookmark, -1 if there is no bookmark below
+ */
+
+long
+book_mark_get_next (WEdit * edit, long line)
+{
+    guint i;
+
+    i = edit_markers_find (&edit->book_marks, line + 1);
+
+    return (i < edit_markers_count (&edit->book_marks) ?
+            (long) edit_markers_get_pos (&edit->book_marks, i) : -1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** shift up bookmarks after this line */
+/**
+ * Find the nearest bookmark above this line
+ *
+ * @param edit editor object
+ * @param line line to search from
+ * @return line of bookmark, -1 if there is no bookmark above
+ */
 
-void
-book_mark_dec (WEdit * edit, long line)
+long
+book_mark_get_prev (WEdit * edit, long line)
 {
-    if (edit->book_mark != NULL)
-    {
-        edit_book_mark_t *p;
+    guint i;
 
-        p = book_mark_find (edit, line);
-        for (p = p->next; p != NULL; p = p->next)
-            p->line--;
-    }
+    i = edit_markers_find (&edit->book_marks, line);
+
+    return (i != 0 ? (long) edit_markers_get_pos (&edit->book_marks, i - 1) : -1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -312,21 +203,23 @@ book_mark_dec (WEdit * edit, long line)
 void
 book_mark_serialize (WEdit * edit, int color)
 {
+    guint i;
+
     if (edit->serialized_bookmarks != NULL)
         g_array_set_size (edit->serialized_bookmarks, 0);
 
-    if (edit->book_mark != NULL)
-    {
-        edit_book_mark_t *p;
+    for (i = 0; i < edit_markers_count (&edit->book_marks); i++)
+        if (edit_markers_get_value (&edit->book_marks, i) == color)
+        {
+            size_t line;
 
-        if (edit->serialized_bookmarks == NULL)
-            edit->serialized_bookmarks = g_array_sized_new (FALSE, FALSE, sizeof (size_t),
-                                                            MAX_SAVED_BOOKMARKS);
+            if (edit->serialized_bookmarks == NULL)
+                edit->serialized_bookmarks = g_array_sized_new (FALSE, FALSE, sizeof (size_t),
+                                                                MAX_SAVED_BOOKMARKS);
 
-        for (p = book_mark_find (edit, 0); p != NULL; p = p->next)
-            if (p->c == color && p->line >= 0)
-                g_array_append_val (edit->serialized_bookmarks, p->line);
-    }
+            line = (size_t) edit_markers_get_pos (&edit->book_marks, i);
+            g_array_append_val (edit->serialized_bookmarks, line);
+        }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -40,10 +40,7 @@
 #define EDIT_TOP_EXTREME 0
 #define EDIT_BOTTOM_EXTREME 0
 
-/* Initial size of the undo stack, in bytes */
-#define START_STACK_SIZE 32
-
-/* Some codes that may be pushed onto or returned from the undo stack */
+/* Some codes that may be pushed onto or returned from the undo journal */
 #define CURS_LEFT       601
 #define CURS_RIGHT      602
 #define DELCHAR         603
@@ -118,6 +115,14 @@ typedef struct edit_search_options_t
     gboolean all_codepages;
 } edit_search_options_t;
 
+/* replacement of range of text: offset is relative to the text before all replacements */
+typedef struct edit_change_t
+{
+    off_t offset;
+    off_t deleted;              /* length of replaced text */
+    off_t inserted;             /* length of new text */
+} edit_change_t;
+
 typedef struct edit_stack_type
 {
     long line;
@@ -137,7 +142,6 @@ extern edit_stack_type edit_history_moveto[MAX_HISTORY_MOVETO];
 
 extern int option_line_state_width;
 
-extern int option_max_undo;
 extern gboolean option_auto_syntax;
 
 extern gboolean search_create_bookmark;
@@ -159,6 +163,7 @@ void edit_save_mode_cmd (void);
 off_t edit_move_forward3 (const WEdit * edit, off_t current, long cols, off_t upto);
 void edit_scroll_screen_over_cursor (WEdit * edit);
 void edit_render_keypress (WEdit * edit);
+void edit_render_cache_clean (WEdit * edit);
 void edit_scroll_upward (WEdit * edit, long i);
 void edit_scroll_downward (WEdit * edit, long i);
 void edit_scroll_right (WEdit * edit, long i);
@@ -182,9 +187,16 @@ int edit_delete (WEdit * edit, gboolean byte_delete);
 int edit_backspace (WEdit * edit, gboolean byte_delete);
 void edit_insert (WEdit * edit, int c);
 void edit_insert_over (WEdit * edit);
+void edit_insert_string (WEdit * edit, const char *text, gsize len);
+void edit_insert_string_ahead (WEdit * edit, const char *text, gsize len);
+void edit_delete_range (WEdit * edit, off_t start, off_t finish);
+void edit_replace_range (WEdit * edit, off_t start, off_t finish, const char *text, gsize len);
+void edit_replace_buffer (WEdit * edit, edit_buffer_t * buf, const GArray * changes);
 void edit_cursor_move (WEdit * edit, off_t increment);
 void edit_push_undo_action (WEdit * edit, long c);
 void edit_push_redo_action (WEdit * edit, long c);
+void edit_push_undo_action_run (WEdit * edit, long c, off_t count);
+void edit_push_undo_text (WEdit * edit, long action, const char *text, gsize len);
 void edit_push_key_press (WEdit * edit);
 void edit_insert_ahead (WEdit * edit, int c);
 off_t edit_write_stream (WEdit * edit, FILE * f);
@@ -195,6 +207,8 @@ gboolean edit_save_as_cmd (WEdit * edit);
 WEdit *edit_init (WEdit * edit, int y, int x, int lines, int cols,
                   const vfs_path_t * filename_vpath, long line);
 gboolean edit_clean (WEdit * edit);
+gboolean edit_load_file_part (WEdit * edit);
+void edit_check_mapped_file (WEdit * edit);
 gboolean edit_ok_to_exit (WEdit * edit);
 file_suitable_rank_t edit_check_file_suitable (const vfs_path_t * fs_path);
 gboolean edit_load_cmd (WDialog * h, const void *data);
@@ -211,6 +225,7 @@ void edit_replace_cmd (WEdit * edit, gboolean again);
 void edit_search_cmd (WEdit * edit, gboolean again);
 mc_search_cbret_t edit_search_cmd_callback (const void *user_data, gsize char_offset,
                                             int *current_char);
+const char *edit_search_span_callback (const void *user_data, gsize char_offset, gsize * len);
 mc_search_cbret_t edit_search_update_callback (const void *user_data, gsize char_offset);
 
 void edit_complete_word_cmd (WEdit * edit);
@@ -219,7 +234,9 @@ void edit_select_object_from_tags (WEdit * edit, etags_jump_type_t type);
 #ifdef HAVE_ASPELL
 int edit_suggest_current_word (WEdit * edit);
 void edit_spellcheck_file (WEdit * edit);
-void edit_set_spell_lang (void);
+void edit_set_spell_lang (WEdit * edit);
+gboolean edit_spellcheck_prescan_pending (const WEdit * edit);
+gboolean edit_spellcheck_prescan (WEdit * edit, off_t len);
 #endif
 
 gboolean edit_save_block (WEdit * edit, const char *filename, off_t start, off_t finish);
@@ -272,15 +289,20 @@ void edit_set_filename (WEdit * edit, const vfs_path_t * name_vpath);
 
 void edit_load_syntax (WEdit * edit, GPtrArray * pnames, const char *type);
 void edit_free_syntax_rules (WEdit * edit);
+void edit_syntax_changed (WEdit * edit, off_t offset, off_t deleted, off_t inserted);
 int edit_get_syntax_color (WEdit * edit, off_t byte_index);
+int edit_get_syntax_context (WEdit * edit, off_t byte_index);
+void edit_get_syntax_rule (WEdit * edit, off_t byte_index, struct edit_syntax_rule_t *rule);
+gboolean edit_syntax_prescan_pending (const WEdit * edit);
+gboolean edit_syntax_prescan (WEdit * edit, off_t len);
 
 void book_mark_insert (WEdit * edit, long line, int c);
 gboolean book_mark_query_color (WEdit * edit, long line, int c);
-struct edit_book_mark_t *book_mark_find (WEdit * edit, long line);
 gboolean book_mark_clear (WEdit * edit, long line, int c);
 void book_mark_flush (WEdit * edit, int c);
-void book_mark_inc (WEdit * edit, long line);
-void book_mark_dec (WEdit * edit, long line);
+void book_mark_shift (WEdit * edit, long line, long delta);
+long book_mark_get_next (WEdit * edit, long line);
+long book_mark_get_prev (WEdit * edit, long line);
 void book_mark_serialize (WEdit * edit, int color);
 void book_mark_restore (WEdit * edit, int color);
 
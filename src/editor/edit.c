@@ -51,6 +51,7 @@
 #include "lib/tty/key.h"        /* is_idle() */
 #include "lib/skin.h"           /* EDITOR_NORMAL_COLOR */
 #include "lib/fileloc.h"        /* EDIT_HOME_BLOCK_FILE */
+#include "lib/mcconfig.h"       /* mc_config_get_data_path() */
 #include "lib/vfs/vfs.h"
 #include "lib/strutil.h"        /* utf string functions */
 #include "lib/sub-util.h"       /* load_file_position(), save_file_position() */
@@ -85,7 +86,6 @@ gboolean option_backspace_through_tabs = FALSE;
 gboolean option_fake_half_tabs = TRUE;
 int option_save_mode = EDIT_QUICK_SAVE;
 gboolean option_save_position = TRUE;
-int option_max_undo = 32768;
 gboolean option_persistent_selections = TRUE;
 gboolean option_cursor_beyond_eol = FALSE;
 gboolean option_line_state = FALSE;
@@ -100,10 +100,14 @@ char *option_other_file_2_exts;
 gboolean enable_show_tabs_tws = TRUE;
 gboolean option_check_nl_at_eof = FALSE;
 gboolean option_group_undo = FALSE;
+gboolean option_persistent_undo = FALSE;
+gboolean option_spell_on_the_fly = FALSE;
 gboolean show_right_margin = FALSE;
 
 char *option_backup_ext = NULL;
 char *option_filesize_threshold = NULL;
+char *option_mmap_threshold = NULL;
+char *option_max_undo_size = NULL;
 
 unsigned int edit_stack_iterator = 0;
 edit_stack_type edit_history_moveto[MAX_HISTORY_MOVETO];
@@ -114,6 +118,9 @@ const char VERTICAL_MAGIC[] = { '\1', '\1', '\1', '\1', '\n' };
 
 #define TEMP_BUF_LEN 1024
 
+/* number of bytes of file from slow VFS loaded at once */
+#define LOAD_FILE_CHUNK (256 * 1024)
+
 #define space_width 1
 
 /*** file scope type declarations ****************************************************************/
@@ -142,6 +149,8 @@ static const struct edit_filters
 };
 
 static const off_t option_filesize_default_threshold = 64 * 1024 * 1024;        /* 64 MB */
+static const off_t option_mmap_default_threshold = 64 * 1024 * 1024;    /* 64 MB */
+static const off_t option_max_undo_default_size = 8 * 1024 * 1024;     /* 8 MB */
 
 /* --------------------------------------------------------------------------------------------- */
 /*** file scope functions ************************************************************************/
@@ -174,6 +183,210 @@ edit_load_status_update_cb (status_msg_t * sm)
     return status_msg_common_update (sm);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Map large local file into buffers instead of reading it.
+ * Lines of the mapped file are counted later, when the editor is idle.
+ *
+ * @return TRUE if file was mapped, FALSE if it should be read.
+ */
+
+static gboolean
+edit_load_file_mapped (edit_buffer_t * buf, const vfs_path_t * filename_vpath)
+{
+    uintmax_t threshold;
+    gboolean err = FALSE;
+    int file;
+    struct stat st;
+    gboolean ret;
+
+    /* option can be changed by reload of the config, so it is parsed every time */
+    threshold = parse_integer (option_mmap_threshold, &err);
+    if (err)
+        threshold = option_mmap_default_threshold;
+
+    /* zero threshold disables mapping */
+    if (threshold == 0 || (uintmax_t) buf->size < threshold)
+        return FALSE;
+
+    file = open (vfs_path_as_str (filename_vpath), O_RDONLY | O_BINARY);
+    if (file < 0)
+        return FALSE;
+
+    ret = fstat (file, &st) == 0 && st.st_size == buf->size
+        && edit_buffer_map_file (buf, file, buf->size);
+
+    /* mapping remains valid after file is closed */
+    close (file);
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get memory cap of undo and redo journals.
+ *
+ * @return cap in bytes, 0 if journals are unlimited
+ */
+
+static gsize
+edit_get_max_undo_size (void)
+{
+    static uintmax_t size = UINTMAX_MAX;
+
+    if (size == UINTMAX_MAX)
+    {
+        gboolean err = FALSE;
+
+        size = parse_integer (option_max_undo_size, &err);
+        if (err)
+            size = option_max_undo_default_size;
+    }
+
+    return (gsize) MIN (size, G_MAXSIZE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Prepare indexes of text for the change of buffer. Called before the range is removed.
+ *
+ * @param edit editor object
+ * @param offset offset of the change
+ * @param deleted number of bytes to be removed at the offset
+ */
+
+static void
+edit_text_changing (WEdit * edit, off_t offset, off_t deleted)
+{
+    edit_words_update (&edit->words, &edit->buffer, offset, offset + deleted, -1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update indexes of text after the change of buffer.
+ *
+ * @param edit editor object
+ * @param offset offset of the change
+ * @param deleted number of bytes removed at the offset
+ * @param inserted number of bytes inserted at the offset
+ */
+
+static void
+edit_text_changed (WEdit * edit, off_t offset, off_t deleted, off_t inserted)
+{
+    edit_words_update (&edit->words, &edit->buffer, offset, offset + inserted, 1);
+    edit_syntax_changed (edit, offset, deleted, inserted);
+    edit_brackets_update (&edit->brackets, offset, deleted, inserted);
+    edit_columns_update (edit->columns, offset, deleted, inserted);
+    edit_spell_update (&edit->spell, offset, deleted, inserted);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Keep the top of the page on a line start after lines following the offset were loaded.
+ */
+
+static void
+edit_load_file_update (WEdit * edit, off_t offset)
+{
+    if (edit->start_display > offset)
+    {
+        edit->start_display =
+            edit_buffer_get_bol (&edit->buffer, MIN (edit->start_display, edit->buffer.size));
+        edit->start_line = edit_buffer_count_lines (&edit->buffer, 0, edit->start_display);
+    }
+
+    /* the indexes of words and brackets are built again when needed */
+    edit_words_clean (&edit->words);
+    edit_brackets_clean (&edit->brackets);
+    edit_text_changed (edit, offset, edit->buffer.size - offset, edit->buffer.size - offset);
+    edit->caches_valid = FALSE;
+    edit->force |= REDRAW_PAGE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Stop loading file in background. The loaded part of file is kept in the editor, but the editor
+ * is detached from the file, so that the file cannot be overwritten with its part.
+ */
+
+static void
+edit_load_file_stop (WEdit * edit)
+{
+    off_t offset;
+
+    offset = edit->buffer.load_offset;
+    edit_buffer_load_stop (&edit->buffer);
+    mc_close (edit->load_file);
+    edit_set_filename (edit, NULL);
+    edit_load_file_update (edit, offset);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Load the rest of file being loaded in background, showing the progress.
+ *
+ * @return TRUE if whole file is loaded, FALSE if loading failed or was cancelled
+ */
+
+static gboolean
+edit_load_file_finish (WEdit * edit)
+{
+    edit_buffer_read_file_status_msg_t rsm;
+    status_msg_t *sm = STATUS_MSG (&rsm);
+    gboolean ret = TRUE;
+
+    rsm.first = TRUE;
+    rsm.buf = &edit->buffer;
+    rsm.loaded = edit->buffer.load_offset;
+
+    status_msg_init (sm, _("Load file"), 1.0, simple_status_msg_init_cb,
+                     edit_load_status_update_cb, NULL);
+
+    while (ret && edit_buffer_loading_pending (&edit->buffer))
+    {
+        ret = edit_load_file_part (edit);
+        rsm.loaded = edit->buffer.load_offset;
+
+        if (ret && edit_buffer_loading_pending (&edit->buffer) && sm->update (sm) == B_CANCEL)
+        {
+            edit_load_file_stop (edit);
+            ret = FALSE;
+        }
+    }
+
+    status_msg_deinit (sm);
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Start loading large file from slow VFS: load its first part only, the rest is loaded
+ * by edit_load_file_part() when the editor is idle.
+ *
+ * @return FALSE on error.
+ */
+
+static gboolean
+edit_load_file_background (WEdit * edit)
+{
+    edit->load_file = mc_open (edit->filename_vpath, O_RDONLY | O_BINARY);
+    if (edit->load_file < 0)
+    {
+        gchar *errmsg;
+
+        errmsg = g_strdup_printf (_("Cannot open %s for reading"),
+                                  vfs_path_as_str (edit->filename_vpath));
+        edit_error_dialog (_("Error"), errmsg);
+        g_free (errmsg);
+        return FALSE;
+    }
+
+    edit_buffer_load_start (&edit->buffer);
+
+    return edit_load_file_part (edit);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Load file OR text into buffers.  Set cursor to the beginning of file.
@@ -189,6 +402,9 @@ edit_load_file_fast (edit_buffer_t * buf, const vfs_path_t * filename_vpath)
     edit_buffer_read_file_status_msg_t rsm;
     gboolean aborted;
 
+    if (edit_load_file_mapped (buf, filename_vpath))
+        return TRUE;
+
     file = mc_open (filename_vpath, O_RDONLY | O_BINARY);
     if (file < 0)
     {
@@ -414,6 +630,7 @@ check_file_access (WEdit * edit, const vfs_path_t * filename_vpath, struct stat
  *
  * Fast loading (edit_load_file_fast) is used when the file size is
  * known.  In this case the data is read into the buffers by blocks.
+ * Local files larger than editor_mmap_threshold are mapped instead.
  * If the file size is not known, the data is loaded byte by byte in
  * edit_insert_file.
  *
@@ -424,6 +641,7 @@ static gboolean
 edit_load_file (WEdit * edit)
 {
     gboolean fast_load = TRUE;
+    gboolean background_load = FALSE;
 
     /* Cannot do fast load if a filter is used */
     if (edit_find_filter (edit->filename_vpath) >= 0)
@@ -448,6 +666,10 @@ edit_load_file (WEdit * edit)
             edit_clean (edit);
             return FALSE;
         }
+
+        /* don't keep user waiting until large file is loaded */
+        background_load = !fast_load && !vfs_file_is_local (edit->filename_vpath)
+            && edit_find_filter (edit->filename_vpath) < 0 && edit->stat1.st_size > LOAD_FILE_CHUNK;
     }
     else
     {
@@ -465,6 +687,16 @@ edit_load_file (WEdit * edit)
             return FALSE;
         }
     }
+    else if (background_load)
+    {
+        edit_buffer_init (&edit->buffer, edit->stat1.st_size);
+
+        if (!edit_load_file_background (edit))
+        {
+            edit_clean (edit);
+            return FALSE;
+        }
+    }
     else
     {
         edit_buffer_init (&edit->buffer, 0);
@@ -544,106 +776,140 @@ edit_save_position (WEdit * edit)
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** Clean the WEdit stricture except the widget part */
+/**
+ * Get file status for persistent undo.
+ *
+ * @param edit editor object
+ * @param st pointer to the stat structure to fill
+ *
+ * @return TRUE if undo history of the file can be kept on disk, FALSE otherwise
+ */
 
-static void
-edit_purge_widget (WEdit * edit)
+static gboolean
+edit_stat_undo_file (const WEdit * edit, struct stat *st)
 {
-    size_t len = sizeof (WEdit) - sizeof (Widget);
-    char *start = (char *) edit + sizeof (Widget);
-    memset (start, 0, len);
+    return (option_persistent_undo && edit->filename_vpath != NULL
+            && *(vfs_path_get_by_index (edit->filename_vpath, 0)->path) != '\0'
+            && vfs_file_is_local (edit->filename_vpath) && mc_stat (edit->filename_vpath, st) == 0
+            && st->st_size == edit->buffer.size);
 }
 
 /* --------------------------------------------------------------------------------------------- */
-
-/*
-   TODO: if the user undos until the stack bottom, and the stack has not wrapped,
-   then the file should be as it was when he loaded up. Then set edit->modified to 0.
+/**
+ * Get path to the undo or redo log of the file.
+ *
+ * @param edit editor object
+ * @param suffix log name suffix
+ *
+ * @return newly allocated path
  */
 
-static long
-edit_pop_undo_action (WEdit * edit)
+static char *
+edit_get_undo_log_path (const WEdit * edit, const char *suffix)
 {
-    long c;
-    unsigned long sp = edit->undo_stack_pointer;
+    char *checksum, *name, *path;
 
-    if (sp == edit->undo_stack_bottom)
-        return STACK_BOTTOM;
+    checksum =
+        g_compute_checksum_for_string (G_CHECKSUM_MD5, vfs_path_as_str (edit->filename_vpath), -1);
+    name = g_strconcat (checksum, suffix, (char *) NULL);
+    path = mc_build_filename (mc_config_get_data_path (), EDIT_HOME_UNDO_DIR, name, (char *) NULL);
+    g_free (name);
+    g_free (checksum);
 
-    sp = (sp - 1) & edit->undo_stack_size_mask;
-    c = edit->undo_stack[sp];
-    if (c >= 0)
-    {
-        /*      edit->undo_stack[sp] = '@'; */
-        edit->undo_stack_pointer = (edit->undo_stack_pointer - 1) & edit->undo_stack_size_mask;
-        return c;
-    }
+    return path;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Restore undo or redo journal from its log.
+ *
+ * The journal is recorded relative to the cursor position at the moment of saving,
+ * so the cursor movement from there to the current position is added to it.
+ *
+ * @param edit editor object
+ * @param undo undo or redo journal
+ * @param suffix log name suffix
+ * @param st status of the edited file
+ */
+
+static void
+edit_load_undo_log (WEdit * edit, edit_undo_t * undo, const char *suffix, const struct stat *st)
+{
+    char *path;
+    off_t cursor;
 
-    if (sp == edit->undo_stack_bottom)
-        return STACK_BOTTOM;
+    path = edit_get_undo_log_path (edit, suffix);
 
-    c = edit->undo_stack[(sp - 1) & edit->undo_stack_size_mask];
-    if (edit->undo_stack[sp] == -2)
+    if (edit_undo_load (undo, path, st->st_size, st->st_mtime, &cursor))
     {
-        /*      edit->undo_stack[sp] = '@'; */
-        edit->undo_stack_pointer = sp;
+        if (cursor > edit->buffer.curs1)
+            edit_undo_push (undo, CURS_RIGHT, cursor - edit->buffer.curs1);
+        else
+            edit_undo_push (undo, CURS_LEFT, edit->buffer.curs1 - cursor);
     }
-    else
-        edit->undo_stack[sp]++;
 
-    return c;
+    g_free (path);
 }
 
-static long
-edit_pop_redo_action (WEdit * edit)
-{
-    long c;
-    unsigned long sp = edit->redo_stack_pointer;
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Restore undo and redo history of the file saved by edit_save_undo().
+ *
+ * @param edit editor object
+ */
 
-    if (sp == edit->redo_stack_bottom)
-        return STACK_BOTTOM;
+static void
+edit_load_undo (WEdit * edit)
+{
+    struct stat st;
 
-    sp = (sp - 1) & edit->redo_stack_size_mask;
-    c = edit->redo_stack[sp];
-    if (c >= 0)
+    if (edit_stat_undo_file (edit, &st))
     {
-        edit->redo_stack_pointer = (edit->redo_stack_pointer - 1) & edit->redo_stack_size_mask;
-        return c;
+        edit_load_undo_log (edit, &edit->undo, ".undo", &st);
+        edit_load_undo_log (edit, &edit->redo, ".redo", &st);
     }
-
-    if (sp == edit->redo_stack_bottom)
-        return STACK_BOTTOM;
-
-    c = edit->redo_stack[(sp - 1) & edit->redo_stack_size_mask];
-    if (edit->redo_stack[sp] == -2)
-        edit->redo_stack_pointer = sp;
-    else
-        edit->redo_stack[sp]++;
-
-    return c;
 }
 
-static long
-get_prev_undo_action (WEdit * edit)
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Save undo and redo history of the file next to saved file positions.
+ *
+ * The history matches the file on disk only if the file isn't modified.
+ *
+ * @param edit editor object
+ */
+
+static void
+edit_save_undo (WEdit * edit)
 {
-    long c;
-    unsigned long sp = edit->undo_stack_pointer;
+    struct stat st;
+    char *path;
 
-    if (sp == edit->undo_stack_bottom)
-        return STACK_BOTTOM;
+    if (!edit->loading_done || edit->modified || !edit_stat_undo_file (edit, &st))
+        return;
 
-    sp = (sp - 1) & edit->undo_stack_size_mask;
-    c = edit->undo_stack[sp];
-    if (c >= 0)
-        return c;
+    path = edit_get_undo_log_path (edit, ".undo");
+    (void) edit_undo_save (&edit->undo, path, st.st_size, st.st_mtime, edit->buffer.curs1);
+    g_free (path);
 
-    if (sp == edit->undo_stack_bottom)
-        return STACK_BOTTOM;
+    path = edit_get_undo_log_path (edit, ".redo");
+    (void) edit_undo_save (&edit->redo, path, st.st_size, st.st_mtime, edit->buffer.curs1);
+    g_free (path);
+}
 
-    c = edit->undo_stack[(sp - 1) & edit->undo_stack_size_mask];
-    return c;
+/* --------------------------------------------------------------------------------------------- */
+/** Clean the WEdit stricture except the widget part */
+
+static void
+edit_purge_widget (WEdit * edit)
+{
+    size_t len = sizeof (WEdit) - sizeof (Widget);
+    char *start = (char *) edit + sizeof (Widget);
+    memset (start, 0, len);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
 /* --------------------------------------------------------------------------------------------- */
 /** is called whenever a modification is made by one of the four routines below */
 
@@ -716,21 +982,23 @@ edit_find_line (WEdit * edit, long line)
     long i, j = 0;
     long m = 2000000000;        /* what is the magic number? */
 
+    if (line <= 0)
+        return 0;
+
+    /* buffer keeps line index, unless lines of mapped file are being counted */
+    if (!edit_buffer_lines_pending (&edit->buffer))
+        return edit_buffer_get_forward_offset (&edit->buffer, 0, line, 0);
+
     if (!edit->caches_valid)
     {
         memset (edit->line_numbers, 0, sizeof (edit->line_numbers));
         memset (edit->line_offsets, 0, sizeof (edit->line_offsets));
-        /* three offsets that we *know* are line 0 at 0 and these two: */
+        /* offsets that we *know* are line 0 at 0 and this one
+           (the last line is unknown until lines are counted): */
         edit->line_numbers[1] = edit->buffer.curs_line;
         edit->line_offsets[1] = edit_buffer_get_current_bol (&edit->buffer);
-        edit->line_numbers[2] = edit->buffer.lines;
-        edit->line_offsets[2] = edit_buffer_get_bol (&edit->buffer, edit->buffer.size);
         edit->caches_valid = TRUE;
     }
-    if (line >= edit->buffer.lines)
-        return edit->line_offsets[2];
-    if (line <= 0)
-        return 0;
     /* find the closest known point */
     for (i = 0; i < N_LINE_CACHES; i++)
     {
@@ -1176,19 +1444,23 @@ edit_do_undo (WEdit * edit)
     long ac;
     long count = 0;
 
+    /* redo restores display as it was before undo */
+    if (edit_undo_peek (&edit->undo) != STACK_BOTTOM)
+        edit_undo_push (&edit->redo, KEY_PRESS + edit->start_display, 1);
+
     edit->undo_stack_disable = 1;       /* don't record undo's onto undo stack! */
     edit->over_col = 0;
-    while ((ac = edit_pop_undo_action (edit)) < KEY_PRESS)
+    while ((ac = edit_undo_pop (&edit->undo)) < KEY_PRESS)
     {
         switch ((int) ac)
         {
         case STACK_BOTTOM:
             goto done_undo;
         case CURS_RIGHT:
-            edit_cursor_move (edit, 1);
+            edit_cursor_move (edit, 1 + edit_undo_pop_run (&edit->undo, ac));
             break;
         case CURS_LEFT:
-            edit_cursor_move (edit, -1);
+            edit_cursor_move (edit, -1 - edit_undo_pop_run (&edit->undo, ac));
             break;
         case BACKSPACE:
         case BACKSPACE_BR:
@@ -1265,17 +1537,17 @@ edit_do_redo (WEdit * edit)
         return;
 
     edit->over_col = 0;
-    while ((ac = edit_pop_redo_action (edit)) < KEY_PRESS)
+    while ((ac = edit_undo_pop (&edit->redo)) < KEY_PRESS)
     {
         switch ((int) ac)
         {
         case STACK_BOTTOM:
             goto done_redo;
         case CURS_RIGHT:
-            edit_cursor_move (edit, 1);
+            edit_cursor_move (edit, 1 + edit_undo_pop_run (&edit->redo, ac));
             break;
         case CURS_LEFT:
-            edit_cursor_move (edit, -1);
+            edit_cursor_move (edit, -1 - edit_undo_pop_run (&edit->redo, ac));
             break;
         case BACKSPACE:
             edit_backspace (edit, TRUE);
@@ -1344,9 +1616,9 @@ edit_group_undo (WEdit * edit)
     long cur_ac = KEY_PRESS;
     while (ac != STACK_BOTTOM && ac == cur_ac)
     {
-        cur_ac = get_prev_undo_action (edit);
+        cur_ac = edit_undo_peek (&edit->undo);
         edit_do_undo (edit);
-        ac = get_prev_undo_action (edit);
+        ac = edit_undo_peek (&edit->undo);
         /* exit from cycle if option_group_undo is not set,
          * and make single UNDO operation
          */
@@ -1543,54 +1815,31 @@ check_and_wrap_line (WEdit * edit)
 static off_t
 edit_get_bracket (WEdit * edit, gboolean in_screen, unsigned long furthest_bracket_search)
 {
-    const char *const b = "{}{[][()(", *p;
-    int i = 1, inc = -1, c, d, n = 0;
-    unsigned long j = 0;
-    off_t q;
+    off_t start = 0, finish = edit->buffer.size;
 
     edit_update_curs_row (edit);
-    c = edit_buffer_get_current_byte (&edit->buffer);
-    p = strchr (b, c);
-    /* not on a bracket at all */
-    if (p == NULL || *p == '\0')
-        return -1;
-    /* the matching bracket */
-    d = p[1];
-    /* going left or right? */
-    if (strchr ("{[(", c) != NULL)
-        inc = 1;
-    /* no limit */
-    if (furthest_bracket_search == 0)
-        furthest_bracket_search--;      /* ULONG_MAX */
-    for (q = edit->buffer.curs1 + inc;; q += inc)
+
+    if (in_screen)
     {
-        int a;
+        long lines;
+        off_t eos;
+
+        /* the end of the last line of screen */
+        lines = WIDGET (edit)->lines - edit->curs_row + 1;
+        eos = edit_buffer_get_forward_offset (&edit->buffer, edit->buffer.curs1, lines, 0);
+        if (edit_buffer_count_lines (&edit->buffer, edit->buffer.curs1, eos) == lines)
+            finish = eos;
+        start = edit->start_display;
+    }
 
-        /* out of buffer? */
-        if (q >= edit->buffer.size || q < 0)
-            break;
-        a = edit_buffer_get_byte (&edit->buffer, q);
-        /* don't want to eat CPU */
-        if (j++ > furthest_bracket_search)
-            break;
-        /* out of screen? */
-        if (in_screen)
-        {
-            if (q < edit->start_display)
-                break;
-            /* count lines if searching downward */
-            if (inc > 0 && a == '\n')
-                if (n++ >= WIDGET (edit)->lines - edit->curs_row)       /* out of screen */
-                    break;
-        }
-        /* count bracket depth */
-        i += (a == c) - (a == d);
-        /* return if bracket depth is zero */
-        if (i == 0)
-            return q;
+    /* don't want to eat CPU */
+    if (furthest_bracket_search != 0)
+    {
+        start = MAX (start, edit->buffer.curs1 - (off_t) furthest_bracket_search - 1);
+        finish = MIN (finish, edit->buffer.curs1 + (off_t) furthest_bracket_search + 2);
     }
-    /* no match */
-    return -1;
+
+    return edit_brackets_find (edit, edit->buffer.curs1, start, finish);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -1774,14 +2023,145 @@ edit_insert_column_from_file (WEdit * edit, int file, off_t * start_pos, off_t *
             }
         }
     }
-    *col1 = col;
-    *col2 = col + width;
-    *start_pos = cursor;
-    *end_pos = edit->buffer.curs1;
-    edit_cursor_move (edit, cursor - edit->buffer.curs1);
-    g_free (data);
+    *col1 = col;
+    *col2 = col + width;
+    *start_pos = cursor;
+    *end_pos = edit->buffer.curs1;
+    edit_cursor_move (edit, cursor - edit->buffer.curs1);
+    g_free (data);
+
+    return blocklen;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether command only moves the cursor or scrolls the page, so it can be executed while
+ * the file is being loaded in background.
+ */
+
+static gboolean
+edit_is_view_command (long command)
+{
+    switch (command)
+    {
+    case CK_TopOnScreen:
+    case CK_BottomOnScreen:
+    case CK_Top:
+    case CK_Bottom:
+    case CK_PageUp:
+    case CK_PageDown:
+    case CK_Home:
+    case CK_End:
+    case CK_Up:
+    case CK_Down:
+    case CK_Left:
+    case CK_Right:
+    case CK_WordLeft:
+    case CK_WordRight:
+    case CK_ParagraphUp:
+    case CK_ParagraphDown:
+    case CK_ScrollUp:
+    case CK_ScrollDown:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Translate offset in the text to the offset in the same text after replacements. Offsets inside
+ * or at the end of replaced range are moved to its start, as if the range was deleted and the new
+ * text was inserted before them.
+ *
+ * @param changes replacements sorted by offset
+ * @param offset offset in the text before replacements
+ *
+ * @return offset in the text after replacements
+ */
+
+static off_t
+edit_changes_map_offset (const GArray * changes, off_t offset)
+{
+    off_t delta = 0;
+    guint i;
+
+    for (i = 0; i < changes->len; i++)
+    {
+        const edit_change_t *c = &g_array_index (changes, edit_change_t, i);
+
+        if (offset <= c->offset)
+            break;
+
+        if (offset <= c->offset + c->deleted)
+            return c->offset + delta;
+
+        delta += c->inserted - c->deleted;
+    }
+
+    return offset + delta;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Insert string at the cursor by spans. The whole string is recorded as one undo record and
+ * the page is redrawn once.
+ *
+ * @param edit editor object
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ * @param ahead if TRUE, the cursor stays before the string, like with edit_insert_ahead()
+ */
+
+static void
+edit_insert_text (WEdit * edit, const char *text, gsize len, gboolean ahead)
+{
+    const char *p, *end;
+    off_t curs1;
+    long lines = 0;
+
+    if (len == 0)
+        return;
+
+    curs1 = edit->buffer.curs1;
+
+    if (edit->loading_done)
+        edit_modification (edit);
+
+    edit_text_changing (edit, curs1, 0);
+
+    /* bookmarks below the cursor line are shifted down by new lines */
+    for (p = text, end = text + len; (p = memchr (p, '\n', end - p)) != NULL; p++)
+        lines++;
+    book_mark_shift (edit, edit->buffer.curs_line, lines);
+
+    if (ahead)
+    {
+        edit_buffer_insert_string_ahead (&edit->buffer, text, len);
+        edit_push_undo_action_run (edit, DELCHAR, (off_t) len);
+        edit->mark1 += (edit->mark1 >= curs1) ? (off_t) len : 0;
+        edit->mark2 += (edit->mark2 >= curs1) ? (off_t) len : 0;
+    }
+    else
+    {
+        edit_buffer_insert_string (&edit->buffer, text, len);
+        edit->buffer.curs_line += lines;
+        edit_push_undo_action_run (edit, BACKSPACE, (off_t) len);
+        edit->mark1 += (edit->mark1 > curs1) ? (off_t) len : 0;
+        edit->mark2 += (edit->mark2 > curs1) ? (off_t) len : 0;
+    }
+
+    edit->buffer.lines += lines;
+
+    if (curs1 < edit->start_display)
+    {
+        edit->start_display += len;
+        edit->start_line += lines;
+    }
 
-    return blocklen;
+    edit_text_changed (edit, curs1, 0, (off_t) len);
+
+    edit->force |= REDRAW_PAGE;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2159,13 +2539,13 @@ edit_init (WEdit * edit, int y, int x, int lines, int cols, const vfs_path_t * f
     /* set file name before load file */
     edit_set_filename (edit, filename_vpath);
 
-    edit->undo_stack_size = START_STACK_SIZE;
-    edit->undo_stack_size_mask = START_STACK_SIZE - 1;
-    edit->undo_stack = g_malloc0 ((edit->undo_stack_size + 10) * sizeof (long));
-
-    edit->redo_stack_size = START_STACK_SIZE;
-    edit->redo_stack_size_mask = START_STACK_SIZE - 1;
-    edit->redo_stack = g_malloc0 ((edit->redo_stack_size + 10) * sizeof (long));
+    edit_undo_init (&edit->undo, edit_get_max_undo_size ());
+    edit_undo_init (&edit->redo, edit_get_max_undo_size ());
+    edit_words_init (&edit->words);
+    edit_brackets_init (&edit->brackets);
+    edit->columns = g_new (edit_columns_t, 1);
+    edit_columns_init (edit->columns);
+    edit_spell_init (&edit->spell);
 
 #ifdef HAVE_CHARSET
     edit->utf8 = FALSE;
@@ -2199,6 +2579,7 @@ edit_init (WEdit * edit, int y, int x, int lines, int cols, const vfs_path_t * f
         edit_move_to_line (edit, line - 1);
     }
 
+    edit_load_undo (edit);
     edit_load_macro_cmd (edit);
 
     return edit;
@@ -2230,10 +2611,22 @@ edit_clean (WEdit * edit)
     edit_free_syntax_rules (edit);
     book_mark_flush (edit, -1);
 
+    if (option_persistent_undo)
+        edit_save_undo (edit);
+
+    if (edit_buffer_loading_pending (&edit->buffer))
+        mc_close (edit->load_file);
+
     edit_buffer_clean (&edit->buffer);
 
-    g_free (edit->undo_stack);
-    g_free (edit->redo_stack);
+    edit_undo_clean (&edit->undo);
+    edit_undo_clean (&edit->redo);
+    edit_words_clean (&edit->words);
+    edit_brackets_clean (&edit->brackets);
+    edit_columns_clean (edit->columns);
+    MC_PTR_FREE (edit->columns);
+    edit_spell_clean (&edit->spell);
+    edit_render_cache_clean (edit);
     vfs_path_free (edit->filename_vpath);
     vfs_path_free (edit->dir_vpath);
     vfs_path_free (edit->otherfile_vpath);
@@ -2250,6 +2643,68 @@ edit_clean (WEdit * edit)
     return TRUE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Load the next part of file being loaded in background. On error, the editor keeps the loaded
+ * part of file, but is detached from the file.
+ *
+ * @return FALSE on error, TRUE otherwise
+ */
+
+gboolean
+edit_load_file_part (WEdit * edit)
+{
+    off_t offset;
+
+    if (!edit_buffer_loading_pending (&edit->buffer))
+        return TRUE;
+
+    offset = edit->buffer.load_offset;
+
+    if (edit_buffer_load_part (&edit->buffer, edit->load_file, LOAD_FILE_CHUNK) < 0)
+    {
+        gchar *errmsg;
+
+        errmsg = g_strdup_printf (_("Error reading %s"), vfs_path_as_str (edit->filename_vpath));
+        edit_error_dialog (_("Error"), errmsg);
+        g_free (errmsg);
+
+        edit_load_file_stop (edit);
+        return FALSE;
+    }
+
+    if (!edit_buffer_loading_pending (&edit->buffer))
+        mc_close (edit->load_file);
+
+    edit_load_file_update (edit, offset);
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Detach the editor from the mapped file if the file was truncated by another process.
+ * The lost part of file remains in the editor as null bytes.
+ */
+
+void
+edit_check_mapped_file (WEdit * edit)
+{
+    gchar *errmsg;
+
+    if (!edit_buffer_map_truncated (&edit->buffer))
+        return;
+
+    edit_buffer_unmap (&edit->buffer);
+    edit_load_file_update (edit, 0);
+
+    errmsg =
+        g_strdup_printf (_("File %s was truncated by another process.\n"
+                           "Its lost part is replaced with null bytes."),
+                         vfs_path_as_str (edit->filename_vpath));
+    edit_error_dialog (_("Error"), errmsg);
+    g_free (errmsg);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 /**
@@ -2316,27 +2771,11 @@ edit_set_codeset (WEdit * edit)
 /* --------------------------------------------------------------------------------------------- */
 
 /**
- * Recording stack for undo:
- * The following is an implementation of a compressed stack. Identical
- * pushes are recorded by a negative prefix indicating the number of times the
- * same char was pushed. This saves space for repeated curs-left or curs-right
- * delete etc.
+ * Recording journal for undo:
+ * Actions are recorded into the journal as codes. Identical pushes are recorded
+ * as runs, and pushes of bytes are recorded as runs of bytes, see editundo.c.
  *
- * eg:
- *
- * pushed:       stored:
- *
- * a
- * b             a
- * b            -3
- * b             b
- * c  -->       -4
- * c             c
- * c             d
- * c
- * d
- *
- * If the stack long int is 0-255 it represents a normal insert (from a backspace),
+ * If the code is 0-255 it represents a normal insert (from a backspace),
  * 256-512 is an insert ahead (from a delete), If it is betwen 600 and 700 it is one
  * of the cursor functions define'd in edit-impl.h. 1000 through 700'000'000 is to
  * set edit->mark1 position. 700'000'000 through 1400'000'000 is to set edit->mark2
@@ -2344,7 +2783,7 @@ edit_set_codeset (WEdit * edit)
  *
  * The only way the cursor moves or the buffer is changed is through the routines:
  * insert, backspace, insert_ahead, delete, and cursor_move.
- * These record the reverse undo movements onto the stack each time they are
+ * These record the reverse undo movements onto the journal each time they are
  * called.
  *
  * Each key press results in a set of actions (insert; delete ...). So each time
@@ -2353,7 +2792,7 @@ edit_set_codeset (WEdit * edit)
  * over KEY_PRESS. We then assign this number less KEY_PRESS to start_display. So undo
  * tracks scrolling and key actions exactly. (KEY_PRESS is about (2^31) * (2/3) = 1400'000'000)
  *
- *
+ * While undoing, the actions are recorded into the redo journal instead.
  *
  * @param edit editor object
  * @param c code of the action
@@ -2362,170 +2801,66 @@ edit_set_codeset (WEdit * edit)
 void
 edit_push_undo_action (WEdit * edit, long c)
 {
-    unsigned long sp = edit->undo_stack_pointer;
-    unsigned long spm1;
-    long *t;
-
-    /* first enlarge the stack if necessary */
-    if (sp > edit->undo_stack_size - 10)
-    {                           /* say */
-        if (option_max_undo < 256)
-            option_max_undo = 256;
-        if (edit->undo_stack_size < (unsigned long) option_max_undo)
-        {
-            t = g_realloc (edit->undo_stack, (edit->undo_stack_size * 2 + 10) * sizeof (long));
-            if (t)
-            {
-                edit->undo_stack = t;
-                edit->undo_stack_size <<= 1;
-                edit->undo_stack_size_mask = edit->undo_stack_size - 1;
-            }
-        }
-    }
-    spm1 = (edit->undo_stack_pointer - 1) & edit->undo_stack_size_mask;
+    edit_push_undo_action_run (edit, c, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_push_redo_action (WEdit * edit, long c)
+{
+    edit_undo_push (&edit->redo, c, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Push the same action onto the undo journal several times.
+ *
+ * Identical pushes are stored as a run, so the cost doesn't depend on count.
+ *
+ * @param edit editor object
+ * @param c code of the action
+ * @param count number of repetitions
+ */
+
+void
+edit_push_undo_action_run (WEdit * edit, long c, off_t count)
+{
     if (edit->undo_stack_disable)
     {
-        edit_push_redo_action (edit, KEY_PRESS);
-        edit_push_redo_action (edit, c);
+        edit_undo_push (&edit->redo, c, count);
         return;
     }
 
     if (edit->redo_stack_reset)
-        edit->redo_stack_bottom = edit->redo_stack_pointer = 0;
-
-    if (edit->undo_stack_bottom != sp
-        && spm1 != edit->undo_stack_bottom
-        && ((sp - 2) & edit->undo_stack_size_mask) != edit->undo_stack_bottom)
-    {
-        long d;
-        if (edit->undo_stack[spm1] < 0)
-        {
-            d = edit->undo_stack[(sp - 2) & edit->undo_stack_size_mask];
-            if (d == c && edit->undo_stack[spm1] > -1000000000)
-            {
-                if (c < KEY_PRESS)      /* --> no need to push multiple do-nothings */
-                    edit->undo_stack[spm1]--;
-                return;
-            }
-        }
-        else
-        {
-            d = edit->undo_stack[spm1];
-            if (d == c)
-            {
-                if (c >= KEY_PRESS)
-                    return;     /* --> no need to push multiple do-nothings */
-                edit->undo_stack[sp] = -2;
-                goto check_bottom;
-            }
-        }
-    }
-    edit->undo_stack[sp] = c;
-
-  check_bottom:
-    edit->undo_stack_pointer = (edit->undo_stack_pointer + 1) & edit->undo_stack_size_mask;
-
-    /* if the sp wraps round and catches the undo_stack_bottom then erase
-     * the first set of actions on the stack to make space - by moving
-     * undo_stack_bottom forward one "key press" */
-    c = (edit->undo_stack_pointer + 2) & edit->undo_stack_size_mask;
-    if ((unsigned long) c == edit->undo_stack_bottom ||
-        (((unsigned long) c + 1) & edit->undo_stack_size_mask) == edit->undo_stack_bottom)
-        do
-        {
-            edit->undo_stack_bottom = (edit->undo_stack_bottom + 1) & edit->undo_stack_size_mask;
-        }
-        while (edit->undo_stack[edit->undo_stack_bottom] < KEY_PRESS
-               && edit->undo_stack_bottom != edit->undo_stack_pointer);
+        edit_undo_reset (&edit->redo);
 
-    /*If a single key produced enough pushes to wrap all the way round then we would notice that the [undo_stack_bottom] does not contain KEY_PRESS. The stack is then initialised: */
-    if (edit->undo_stack_pointer != edit->undo_stack_bottom
-        && edit->undo_stack[edit->undo_stack_bottom] < KEY_PRESS)
-    {
-        edit->undo_stack_bottom = edit->undo_stack_pointer = 0;
-    }
+    edit_undo_push (&edit->undo, c, count);
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Push insertions of bytes onto the undo journal at once.
+ *
+ * @param edit editor object
+ * @param action 0 to insert bytes before the cursor, 256 to insert them after it
+ * @param text bytes in the order they would be pushed one by one
+ * @param len number of bytes
+ */
 
 void
-edit_push_redo_action (WEdit * edit, long c)
+edit_push_undo_text (WEdit * edit, long action, const char *text, gsize len)
 {
-    unsigned long sp = edit->redo_stack_pointer;
-    unsigned long spm1;
-    long *t;
-    /* first enlarge the stack if necessary */
-    if (sp > edit->redo_stack_size - 10)
-    {                           /* say */
-        if (option_max_undo < 256)
-            option_max_undo = 256;
-        if (edit->redo_stack_size < (unsigned long) option_max_undo)
-        {
-            t = g_realloc (edit->redo_stack, (edit->redo_stack_size * 2 + 10) * sizeof (long));
-            if (t)
-            {
-                edit->redo_stack = t;
-                edit->redo_stack_size <<= 1;
-                edit->redo_stack_size_mask = edit->redo_stack_size - 1;
-            }
-        }
-    }
-    spm1 = (edit->redo_stack_pointer - 1) & edit->redo_stack_size_mask;
-
-    if (edit->redo_stack_bottom != sp
-        && spm1 != edit->redo_stack_bottom
-        && ((sp - 2) & edit->redo_stack_size_mask) != edit->redo_stack_bottom)
+    if (edit->undo_stack_disable)
     {
-        long d;
-        if (edit->redo_stack[spm1] < 0)
-        {
-            d = edit->redo_stack[(sp - 2) & edit->redo_stack_size_mask];
-            if (d == c && edit->redo_stack[spm1] > -1000000000)
-            {
-                if (c < KEY_PRESS)      /* --> no need to push multiple do-nothings */
-                    edit->redo_stack[spm1]--;
-                return;
-            }
-        }
-        else
-        {
-            d = edit->redo_stack[spm1];
-            if (d == c)
-            {
-                if (c >= KEY_PRESS)
-                    return;     /* --> no need to push multiple do-nothings */
-                edit->redo_stack[sp] = -2;
-                goto redo_check_bottom;
-            }
-        }
+        edit_undo_push_text (&edit->redo, action, text, len);
+        return;
     }
-    edit->redo_stack[sp] = c;
-
-  redo_check_bottom:
-    edit->redo_stack_pointer = (edit->redo_stack_pointer + 1) & edit->redo_stack_size_mask;
-
-    /* if the sp wraps round and catches the redo_stack_bottom then erase
-     * the first set of actions on the stack to make space - by moving
-     * redo_stack_bottom forward one "key press" */
-    c = (edit->redo_stack_pointer + 2) & edit->redo_stack_size_mask;
-    if ((unsigned long) c == edit->redo_stack_bottom ||
-        (((unsigned long) c + 1) & edit->redo_stack_size_mask) == edit->redo_stack_bottom)
-        do
-        {
-            edit->redo_stack_bottom = (edit->redo_stack_bottom + 1) & edit->redo_stack_size_mask;
-        }
-        while (edit->redo_stack[edit->redo_stack_bottom] < KEY_PRESS
-               && edit->redo_stack_bottom != edit->redo_stack_pointer);
 
-    /*
-     * If a single key produced enough pushes to wrap all the way round then
-     * we would notice that the [redo_stack_bottom] does not contain KEY_PRESS.
-     * The stack is then initialised:
-     */
+    if (edit->redo_stack_reset)
+        edit_undo_reset (&edit->redo);
 
-    if (edit->redo_stack_pointer != edit->redo_stack_bottom
-        && edit->redo_stack[edit->redo_stack_bottom] < KEY_PRESS)
-        edit->redo_stack_bottom = edit->redo_stack_pointer = 0;
+    edit_undo_push_text (&edit->undo, action, text, len);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2551,7 +2886,7 @@ edit_insert (WEdit * edit, int c)
     /* now we must update some info on the file and check if a redraw is required */
     if (c == '\n')
     {
-        book_mark_inc (edit, edit->buffer.curs_line);
+        book_mark_shift (edit, edit->buffer.curs_line, 1);
         edit->buffer.curs_line++;
         edit->buffer.lines++;
         edit->force |= REDRAW_LINE_ABOVE | REDRAW_AFTER_CURSOR;
@@ -2566,9 +2901,10 @@ edit_insert (WEdit * edit, int c)
     /* update markers */
     edit->mark1 += (edit->mark1 > edit->buffer.curs1) ? 1 : 0;
     edit->mark2 += (edit->mark2 > edit->buffer.curs1) ? 1 : 0;
-    edit->last_get_rule += (edit->last_get_rule > edit->buffer.curs1) ? 1 : 0;
 
+    edit_text_changing (edit, edit->buffer.curs1, 0);
     edit_buffer_insert (&edit->buffer, c);
+    edit_text_changed (edit, edit->buffer.curs1 - 1, 0, 1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2586,7 +2922,7 @@ edit_insert_ahead (WEdit * edit, int c)
     edit_modification (edit);
     if (c == '\n')
     {
-        book_mark_inc (edit, edit->buffer.curs_line);
+        book_mark_shift (edit, edit->buffer.curs_line, 1);
         edit->buffer.lines++;
         edit->force |= REDRAW_AFTER_CURSOR;
     }
@@ -2598,9 +2934,10 @@ edit_insert_ahead (WEdit * edit, int c)
 
     edit->mark1 += (edit->mark1 >= edit->buffer.curs1) ? 1 : 0;
     edit->mark2 += (edit->mark2 >= edit->buffer.curs1) ? 1 : 0;
-    edit->last_get_rule += (edit->last_get_rule >= edit->buffer.curs1) ? 1 : 0;
 
+    edit_text_changing (edit, edit->buffer.curs1, 0);
     edit_buffer_insert_ahead (&edit->buffer, c);
+    edit_text_changed (edit, edit->buffer.curs1, 0, 1);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -2643,6 +2980,8 @@ edit_delete (WEdit * edit, gboolean byte_delete)
     if (edit->mark2 != edit->mark1)
         edit_push_markers (edit);
 
+    edit_text_changing (edit, edit->buffer.curs1, char_length);
+
     for (i = 1; i <= char_length; i++)
     {
         if (edit->mark1 > edit->buffer.curs1)
@@ -2652,18 +2991,18 @@ edit_delete (WEdit * edit, gboolean byte_delete)
         }
         if (edit->mark2 > edit->buffer.curs1)
             edit->mark2--;
-        if (edit->last_get_rule > edit->buffer.curs1)
-            edit->last_get_rule--;
 
         p = edit_buffer_delete (&edit->buffer);
 
         edit_push_undo_action (edit, p + 256);
     }
 
+    edit_text_changed (edit, edit->buffer.curs1, char_length, 0);
+
     edit_modification (edit);
     if (p == '\n')
     {
-        book_mark_dec (edit, edit->buffer.curs_line);
+        book_mark_shift (edit, edit->buffer.curs_line, -1);
         edit->buffer.lines--;
         edit->force |= REDRAW_AFTER_CURSOR;
     }
@@ -2703,6 +3042,8 @@ edit_backspace (WEdit * edit, gboolean byte_delete)
     (void) byte_delete;
 #endif
 
+    edit_text_changing (edit, edit->buffer.curs1 - char_length, char_length);
+
     for (i = 1; i <= char_length; i++)
     {
         if (edit->mark1 >= edit->buffer.curs1)
@@ -2712,17 +3053,16 @@ edit_backspace (WEdit * edit, gboolean byte_delete)
         }
         if (edit->mark2 >= edit->buffer.curs1)
             edit->mark2--;
-        if (edit->last_get_rule >= edit->buffer.curs1)
-            edit->last_get_rule--;
 
         p = edit_buffer_backspace (&edit->buffer);
 
         edit_push_undo_action (edit, p);
     }
+    edit_text_changed (edit, edit->buffer.curs1, char_length, 0);
     edit_modification (edit);
     if (p == '\n')
     {
-        book_mark_dec (edit, edit->buffer.curs_line);
+        book_mark_shift (edit, edit->buffer.curs_line, -1);
         edit->buffer.curs_line--;
         edit->buffer.lines--;
         edit->force |= REDRAW_AFTER_CURSOR;
@@ -2739,59 +3079,282 @@ edit_backspace (WEdit * edit, gboolean byte_delete)
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** moves the cursor right or left: increment positive or negative respectively */
+/**
+ * Insert string at the cursor and move the cursor after it. The whole string is recorded
+ * as one undo record and the page is redrawn once.
+ *
+ * @param edit editor object
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ */
 
 void
-edit_cursor_move (WEdit * edit, off_t increment)
+edit_insert_string (WEdit * edit, const char *text, gsize len)
 {
-    if (increment < 0)
+    edit_insert_text (edit, text, len, FALSE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Insert string at the cursor and leave the cursor before it, as edit_insert_ahead() does
+ * for every byte.
+ *
+ * @param edit editor object
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ */
+
+void
+edit_insert_string_ahead (WEdit * edit, const char *text, gsize len)
+{
+    edit_insert_text (edit, text, len, TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Delete range of bytes and move the cursor to its start. Bytes are removed from the buffer
+ * and recorded in the undo journal by spans. The page is redrawn once.
+ *
+ * @param edit editor object
+ * @param start offset of the first byte to delete
+ * @param finish offset of the byte following the last one to delete
+ */
+
+void
+edit_delete_range (WEdit * edit, off_t start, off_t finish)
+{
+    off_t len, p;
+    long lines;
+
+    start = MAX (start, 0);
+    finish = MIN (finish, edit->buffer.size);
+    if (start >= finish)
+        return;
+
+    len = finish - start;
+
+    edit_cursor_move (edit, start - edit->buffer.curs1);
+
+    if (edit->mark2 != edit->mark1)
+        edit_push_markers (edit);
+
+    edit_modification (edit);
+
+    edit_text_changing (edit, start, len);
+
+    /* bytes are recorded in the order edit_delete() would push them */
+    for (p = start; p < finish;)
     {
-        for (; increment < 0 && edit->buffer.curs1 != 0; increment++)
-        {
-            int c;
+        const char *s;
+        off_t n;
 
-            edit_push_undo_action (edit, CURS_RIGHT);
+        s = edit_buffer_get_span (&edit->buffer, p, &n);
+        n = MIN (n, finish - p);
+        edit_push_undo_text (edit, 256, s, (gsize) n);
+        p += n;
+    }
 
-            c = edit_buffer_get_previous_byte (&edit->buffer);
-            edit_buffer_insert_ahead (&edit->buffer, c);
-            c = edit_buffer_backspace (&edit->buffer);
-            if (c == '\n')
-            {
-                edit->buffer.curs_line--;
-                edit->force |= REDRAW_LINE_BELOW;
-            }
-        }
+    if (edit->mark1 > start)
+    {
+        p = MIN (edit->mark1 - start, len);
+        edit->mark1 -= p;
+        edit->end_mark_curs -= p;
     }
-    else
+    if (edit->mark2 > start)
+        edit->mark2 -= MIN (edit->mark2 - start, len);
+
+    if (start < edit->start_display)
+    {
+        p = MIN (edit->start_display - start, len);
+        edit->start_line -= edit_buffer_count_lines (&edit->buffer, start, start + p);
+        edit->start_display -= p;
+    }
+
+    lines = edit_buffer_count_lines (&edit->buffer, start, finish);
+    book_mark_shift (edit, edit->buffer.curs_line, -lines);
+
+    edit_buffer_delete_bytes (&edit->buffer, len);
+    edit->buffer.lines -= lines;
+
+    edit_text_changed (edit, start, len, 0);
+    edit->force |= REDRAW_PAGE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Replace range of bytes with string and move the cursor after it.
+ *
+ * @param edit editor object
+ * @param start offset of the first byte to replace
+ * @param finish offset of the byte following the last one to replace
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ */
+
+void
+edit_replace_range (WEdit * edit, off_t start, off_t finish, const char *text, gsize len)
+{
+    edit_delete_range (edit, start, finish);
+    edit_cursor_move (edit, MAX (start, 0) - edit->buffer.curs1);
+    edit_insert_string (edit, text, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Replace the text with the new one made of the same text with some ranges replaced.
+ *
+ * The buffer is swapped at once instead of being changed range by range. The undo journal,
+ * markers and bookmarks are updated as if the ranges were replaced one by one from the beginning
+ * of the text, so all replacements are undone at once as well. The cursor is moved after the last
+ * new text.
+ *
+ * @param edit editor object
+ * @param buf buffer with the whole new text and the cursor at its end. It is taken over
+ *            by the editor and must not be cleaned by the caller
+ * @param changes replacements sorted by offset, not overlapping
+ */
+
+void
+edit_replace_buffer (WEdit * edit, edit_buffer_t * buf, const GArray * changes)
+{
+    const edit_change_t *first, *last;
+    off_t curs, finish;
+    off_t delta = 0;
+    off_t line_offset = 0;
+    long line = 0;
+    guint i;
+
+    if (changes->len == 0)
+    {
+        edit_buffer_clean (buf);
+        return;
+    }
+
+    first = &g_array_index (changes, edit_change_t, 0);
+    last = &g_array_index (changes, edit_change_t, changes->len - 1);
+    finish = last->offset + last->deleted;
+
+    if (edit->mark2 != edit->mark1)
+        edit_push_markers (edit);
+
+    edit_modification (edit);
+
+    curs = edit->buffer.curs1;
+
+    for (i = 0; i < changes->len; i++)
     {
-        for (; increment > 0 && edit->buffer.curs2 != 0; increment--)
+        const edit_change_t *c = &g_array_index (changes, edit_change_t, i);
+        off_t offset, p;
+
+        /* offset of change in the new text */
+        offset = c->offset + delta;
+
+        if (offset > curs)
+            edit_push_undo_action_run (edit, CURS_LEFT, offset - curs);
+        else if (offset < curs)
+            edit_push_undo_action_run (edit, CURS_RIGHT, curs - offset);
+
+        for (p = c->offset; p < c->offset + c->deleted;)
         {
-            int c;
+            const char *s;
+            off_t len;
 
-            edit_push_undo_action (edit, CURS_LEFT);
+            s = edit_buffer_get_span (&edit->buffer, p, &len);
+            len = MIN (len, c->offset + c->deleted - p);
+            edit_push_undo_text (edit, 256, s, (gsize) len);
+            p += len;
+        }
 
-            c = edit_buffer_get_current_byte (&edit->buffer);
-            edit_buffer_insert (&edit->buffer, c);
-            c = edit_buffer_delete (&edit->buffer);
-            if (c == '\n')
-            {
-                edit->buffer.curs_line++;
-                edit->force |= REDRAW_LINE_ABOVE;
-            }
+        if (c->inserted != 0)
+            edit_push_undo_action_run (edit, BACKSPACE, c->inserted);
+
+        if (edit_markers_count (&edit->book_marks) != 0)
+        {
+            long n;
+
+            line += edit_buffer_count_lines (buf, line_offset, offset);
+
+            n = edit_buffer_count_lines (&edit->buffer, c->offset, c->offset + c->deleted);
+            book_mark_shift (edit, line, -n);
+            n = edit_buffer_count_lines (buf, offset, offset + c->inserted);
+            book_mark_shift (edit, line, n);
+            line += n;
+
+            line_offset = offset + c->inserted;
         }
+
+        curs = offset + c->inserted;
+        delta += c->inserted - c->deleted;
     }
+
+    edit->mark1 = edit_changes_map_offset (changes, edit->mark1);
+    edit->mark2 = edit_changes_map_offset (changes, edit->mark2);
+    edit->end_mark_curs = edit_changes_map_offset (changes, edit->end_mark_curs);
+    edit->start_display = edit_changes_map_offset (changes, edit->start_display);
+
+    /* swap buffers */
+    buf->lines = edit_buffer_count_lines (buf, 0, buf->size);
+    buf->curs_line = buf->lines;
+    edit_buffer_move_gap (buf, curs - buf->curs1);
+    buf->generation = edit->buffer.generation + 1;
+
+    edit_buffer_clean (&edit->buffer);
+    edit->buffer = *buf;
+
+    edit->start_display = edit_buffer_get_bol (&edit->buffer, edit->start_display);
+    edit->start_line = edit_buffer_count_lines (&edit->buffer, 0, edit->start_display);
+
+    /* the index of words is built again when needed */
+    edit_words_clean (&edit->words);
+    edit_text_changed (edit, first->offset, finish - first->offset, curs - first->offset);
+
+    edit->force |= REDRAW_COMPLETELY;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/** moves the cursor right or left: increment positive or negative respectively */
+
+void
+edit_cursor_move (WEdit * edit, off_t increment)
+{
+    long curs_line;
+
+    /* cursor doesn't leave the loaded part of file */
+    if (edit_buffer_loading_pending (&edit->buffer))
+        increment = MIN (increment, edit->buffer.load_offset - edit->buffer.curs1);
+
+    if (increment == 0)
+        return;
+
+    curs_line = edit->buffer.curs_line;
+    increment = edit_buffer_move_gap (&edit->buffer, increment);
+
+    /* the whole jump is recorded as a single run of cursor movements */
+    if (increment < 0)
+        edit_push_undo_action_run (edit, CURS_RIGHT, -increment);
+    else
+        edit_push_undo_action_run (edit, CURS_LEFT, increment);
+
+    if (edit->buffer.curs_line < curs_line)
+        edit->force |= REDRAW_LINE_BELOW;
+    else if (edit->buffer.curs_line > curs_line)
+        edit->force |= REDRAW_LINE_ABOVE;
 }
 
 /* --------------------------------------------------------------------------------------------- */
 /* If cols is zero this returns the count of columns from current to upto. */
 /* If upto is zero returns index of cols across from current. */
+/* In long lines the walk is resumed from checkpoints of the column index. */
 
 off_t
 edit_move_forward3 (const WEdit * edit, off_t current, long cols, off_t upto)
 {
-    off_t p, q;
+    off_t p, q, next_point;
     long col;
 
+    p = edit_columns_lookup (edit->columns, current, cols, upto, &col);
+    next_point = p + EDIT_COLUMN_STEP;
+
     if (upto != 0)
     {
         q = upto;
@@ -2800,7 +3363,7 @@ edit_move_forward3 (const WEdit * edit, off_t current, long cols, off_t upto)
     else
         q = edit->buffer.size + 2;
 
-    for (col = 0, p = current; p < q; p++)
+    for (; p < q; p++)
     {
         int c, orig_c;
 
@@ -2814,6 +3377,12 @@ edit_move_forward3 (const WEdit * edit, off_t current, long cols, off_t upto)
 
         orig_c = c = edit_buffer_get_byte (&edit->buffer, p);
 
+        if (p >= next_point && orig_c >= 0 && orig_c < 0x80 && orig_c != '\n')
+        {
+            edit_columns_add (edit->columns, current, p, col);
+            next_point = p + EDIT_COLUMN_STEP;
+        }
+
 #ifdef HAVE_CHARSET
         if (edit->utf8)
         {
@@ -3298,6 +3867,11 @@ edit_execute_cmd (WEdit * edit, long command, int char_for_insertion)
 {
     Widget *w = WIDGET (edit);
     GSList *slang_code = NULL;
+
+    /* the file is modified or searched as a whole: wait until it is loaded */
+    if (edit_buffer_loading_pending (&edit->buffer) && !edit_is_view_command (command))
+        (void) edit_load_file_finish (edit);
+
     /* Check if the command is a S-Lang script registered command */
     if ((slang_code = get_command_callback (command)) != NULL)
     {
@@ -3806,34 +4380,20 @@ edit_execute_cmd (WEdit * edit, long command, int char_for_insertion)
         edit->force |= REDRAW_PAGE;
         break;
     case CK_BookmarkNext:
-        if (edit->book_mark != NULL)
-        {
-            edit_book_mark_t *p;
-
-            p = book_mark_find (edit, edit->buffer.curs_line);
-            if (p->next != NULL)
-            {
-                p = p->next;
-                if (p->line >= edit->start_line + w->lines || p->line < edit->start_line)
-                    edit_move_display (edit, p->line - w->lines / 2);
-                edit_move_to_line (edit, p->line);
-            }
-        }
-        break;
     case CK_BookmarkPrev:
-        if (edit->book_mark != NULL)
         {
-            edit_book_mark_t *p;
+            long line;
+
+            if (command == CK_BookmarkNext)
+                line = book_mark_get_next (edit, edit->buffer.curs_line);
+            else
+                line = book_mark_get_prev (edit, edit->buffer.curs_line);
 
-            p = book_mark_find (edit, edit->buffer.curs_line);
-            while (p->line == edit->buffer.curs_line)
-                if (p->prev != NULL)
-                    p = p->prev;
-            if (p->line >= 0)
+            if (line >= 0)
             {
-                if (p->line >= edit->start_line + w->lines || p->line < edit->start_line)
-                    edit_move_display (edit, p->line - w->lines / 2);
-                edit_move_to_line (edit, p->line);
+                if (line >= edit->start_line + w->lines || line < edit->start_line)
+                    edit_move_display (edit, line - w->lines / 2);
+                edit_move_to_line (edit, line);
             }
         }
         break;
@@ -3967,7 +4527,7 @@ edit_execute_cmd (WEdit * edit, long command, int char_for_insertion)
         edit_spellcheck_file (edit);
         break;
     case CK_SpellCheckSelectLang:
-        edit_set_spell_lang ();
+        edit_set_spell_lang (edit);
         break;
 #endif
 
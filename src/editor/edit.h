@@ -46,10 +46,15 @@ extern gboolean option_line_state;
 extern int option_save_mode;
 extern gboolean option_save_position;
 extern gboolean option_syntax_highlighting;
+extern gboolean option_syntax_prescan;
 extern gboolean option_group_undo;
+extern gboolean option_persistent_undo;
+extern gboolean option_spell_on_the_fly;
 extern gboolean option_completion_collect_other_files;
 extern char *option_backup_ext;
 extern char *option_filesize_threshold;
+extern char *option_mmap_threshold;
+extern char *option_max_undo_size;
 extern char *option_stop_format_chars;
 
 extern gboolean edit_confirm_save;
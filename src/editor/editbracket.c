@@ -0,0 +1,608 @@
+/*
+   Index of brackets of editor buffer for bracket matching.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: index of brackets of editor buffer for bracket matching.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <string.h>
+
+#include "lib/global.h"
+
+#include "edit-impl.h"
+#include "editwidget.h"
+#include "editbracket.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * The text is split into chunks of about BRACKET_CHUNK_SIZE bytes. For every kind of brackets
+ * a chunk keeps the difference between numbers of opening and closing brackets in it and the
+ * lowest depth of nesting reached inside it relative to its start. Matching bracket is searched
+ * by whole chunks: a chunk is skipped at once if the depth doesn't reach zero in it, otherwise
+ * it is scanned byte by byte.
+ *
+ * Chunks are summarized on first use. A change of text invalidates only chunks it touches: the
+ * change is added to or removed from the length of chunk, the following chunks are not moved.
+ * Lengths of chunks are also kept in Fenwick tree (binary indexed tree), element 0 of tree is
+ * unused, chunk i is kept in element i + 1. So the chunk containing an offset is found, and the
+ * length of chunk is changed, in logarithmic time. The tree is built again in linear time when
+ * chunks are added or removed, which happens once per several kilobytes of changed text.
+ *
+ * With syntax highlighting, only brackets in the default context of syntax rules are counted,
+ * so brackets inside strings and comments are ignored. The summary of chunk depends on the
+ * state of syntax parser at its start: not only the context, but also a keyword or a context
+ * delimiter being passed determine contexts of the following bytes. So the summary is made
+ * again if that state is changed by some change of text above. Brackets inside other contexts
+ * are matched only by brackets in the same context, without the index.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/* size of new chunks */
+#define BRACKET_CHUNK_SIZE 4096
+
+/* number of kinds of brackets */
+#define BRACKET_KINDS 3
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    off_t len;                  /* length of text */
+    gboolean valid;             /* FALSE if the text was changed since it was summarized */
+    edit_syntax_rule_t rule;    /* syntax state at the start of text, end relative to start */
+    long net[BRACKET_KINDS];    /* number of opening brackets minus number of closing ones */
+    long min[BRACKET_KINDS];    /* lowest depth of nesting at any byte, not above zero */
+} edit_bracket_chunk_t;
+
+/*** file scope variables ************************************************************************/
+
+static const char brackets_open[] = "{[(";
+static const char brackets_close[] = "}])";
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get kind and direction of bracket.
+ *
+ * @return 1 for opening bracket, -1 for closing one, 0 if the byte is not a bracket
+ */
+
+static inline int
+edit_bracket_get_kind (int c, int *kind)
+{
+    const char *p;
+
+    if (c == '\0')
+        return 0;
+
+    p = strchr (brackets_open, c);
+    if (p != NULL)
+    {
+        *kind = p - brackets_open;
+        return 1;
+    }
+
+    p = strchr (brackets_close, c);
+    if (p != NULL)
+    {
+        *kind = p - brackets_close;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline const void *
+edit_brackets_get_rules (const WEdit * edit)
+{
+    return option_syntax_highlighting ? (const void *) edit->rules : NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline int
+edit_brackets_get_context (WEdit * edit, off_t offset)
+{
+    return edit_brackets_get_rules (edit) != NULL ? edit_get_syntax_context (edit, offset) : 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get state of syntax parser at the offset. The end of keyword or context delimiter is made
+ * relative to the offset, so the state doesn't depend on the position of text.
+ */
+
+static void
+edit_brackets_get_state (WEdit * edit, off_t offset, edit_syntax_rule_t * rule)
+{
+    if (edit_brackets_get_rules (edit) == NULL)
+        memset (rule, 0, sizeof (*rule));
+    else
+    {
+        edit_get_syntax_rule (edit, offset, rule);
+        rule->end = MAX (rule->end - offset, 0);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_brackets_state_equal (const edit_syntax_rule_t * a, const edit_syntax_rule_t * b)
+{
+    return (a->keyword == b->keyword && a->end == b->end && a->context == b->context
+            && a->_context == b->_context && a->border == b->border);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Build Fenwick tree of lengths of chunks in linear time.
+ */
+
+static void
+edit_brackets_lengths_build (edit_brackets_t * brackets)
+{
+    GArray *tree = brackets->lengths;
+    guint n;
+
+    g_array_set_size (tree, brackets->chunks->len + 1);
+    memset (tree->data, 0, tree->len * sizeof (off_t));
+
+    for (n = 1; n < tree->len; n++)
+    {
+        guint parent;
+
+        g_array_index (tree, off_t, n) +=
+            g_array_index (brackets->chunks, edit_bracket_chunk_t, n - 1).len;
+
+        parent = n + (n & (~n + 1));
+        if (parent < tree->len)
+            g_array_index (tree, off_t, parent) += g_array_index (tree, off_t, n);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Change length of chunk.
+ *
+ * @param index index of chunk
+ * @param delta value to add to the length
+ */
+
+static void
+edit_brackets_add_len (edit_brackets_t * brackets, guint index, off_t delta)
+{
+    GArray *tree = brackets->lengths;
+    guint n;
+
+    g_array_index (brackets->chunks, edit_bracket_chunk_t, index).len += delta;
+
+    for (n = index + 1; n < tree->len; n += n & (~n + 1))
+        g_array_index (tree, off_t, n) += delta;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_brackets_build (edit_brackets_t * brackets, const WEdit * edit)
+{
+    off_t offset;
+
+    brackets->chunks = g_array_new (FALSE, TRUE, sizeof (edit_bracket_chunk_t));
+    brackets->lengths = g_array_new (FALSE, FALSE, sizeof (off_t));
+    brackets->rules = edit_brackets_get_rules (edit);
+
+    for (offset = 0; offset < edit->buffer.size; offset += BRACKET_CHUNK_SIZE)
+    {
+        edit_bracket_chunk_t c;
+
+        memset (&c, 0, sizeof (c));
+        c.len = MIN (edit->buffer.size - offset, BRACKET_CHUNK_SIZE);
+        g_array_append_val (brackets->chunks, c);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find chunk containing the offset.
+ *
+ * @param start offset of the start of found chunk is returned here
+ * @return index of chunk, or the number of chunks if the offset is beyond the text
+ */
+
+static guint
+edit_brackets_find_chunk (edit_brackets_t * brackets, off_t offset, off_t * start)
+{
+    const GArray *tree;
+    guint pos = 0;
+    guint step;
+
+    if (brackets->lengths->len == 0)
+        edit_brackets_lengths_build (brackets);
+
+    tree = brackets->lengths;
+    *start = 0;
+
+    for (step = 1; step * 2 < tree->len; step *= 2)
+        ;
+
+    /* the last chunk ending not beyond the offset */
+    for (; step != 0; step /= 2)
+        if (pos + step < tree->len && *start + g_array_index (tree, off_t, pos + step) <= offset)
+        {
+            pos += step;
+            *start += g_array_index (tree, off_t, pos);
+        }
+
+    return pos;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Summarize brackets of chunk if it was changed or the syntax context at its start is changed.
+ *
+ * @return the chunk
+ */
+
+static edit_bracket_chunk_t *
+edit_brackets_summarize (edit_brackets_t * brackets, WEdit * edit, guint index, off_t start)
+{
+    edit_bracket_chunk_t *c;
+    edit_syntax_rule_t rule;
+    long depth[BRACKET_KINDS];
+    off_t offset, finish;
+    int k;
+
+    c = &g_array_index (brackets->chunks, edit_bracket_chunk_t, index);
+    edit_brackets_get_state (edit, start, &rule);
+
+    if (c->valid && edit_brackets_state_equal (&c->rule, &rule))
+        return c;
+
+    for (k = 0; k < BRACKET_KINDS; k++)
+        depth[k] = c->min[k] = 0;
+
+    for (offset = start, finish = start + c->len; offset < finish;)
+    {
+        const char *s;
+        off_t len, i;
+
+        s = edit_buffer_get_span (&edit->buffer, offset, &len);
+        if (s == NULL)
+            break;
+
+        len = MIN (len, finish - offset);
+
+        for (i = 0; i < len; i++)
+        {
+            int dir;
+
+            dir = edit_bracket_get_kind ((unsigned char) s[i], &k);
+            if (dir != 0 && edit_brackets_get_context (edit, offset + i) == 0)
+            {
+                depth[k] += dir;
+                c->min[k] = MIN (c->min[k], depth[k]);
+            }
+        }
+
+        offset += len;
+    }
+
+    for (k = 0; k < BRACKET_KINDS; k++)
+        c->net[k] = depth[k];
+
+    c->rule = rule;
+    c->valid = TRUE;
+
+    return c;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Scan text byte by byte for the bracket which brings depth to zero.
+ *
+ * @param kind kind of brackets to count
+ * @param dir direction of search: 1 forward, -1 backward
+ * @param context syntax context of brackets to count
+ * @param depth depth of nesting, updated with brackets passed
+ * @return offset of found bracket, -1 if not found in the range
+ */
+
+static off_t
+edit_brackets_scan (WEdit * edit, off_t start, off_t finish, int kind, int dir, int context,
+                    long *depth)
+{
+    while (start < finish)
+    {
+        const char *s;
+        off_t len, i;
+
+        if (dir > 0)
+        {
+            s = edit_buffer_get_span (&edit->buffer, start, &len);
+            if (s == NULL)
+                break;
+            len = MIN (len, finish - start);
+        }
+        else
+        {
+            s = edit_buffer_get_span_backward (&edit->buffer, finish, &len);
+            if (s == NULL)
+                break;
+            len = MIN (len, finish - start);
+            s -= len;
+        }
+
+        for (i = 0; i < len; i++)
+        {
+            off_t j, q;
+            int k, d;
+
+            j = dir > 0 ? i : len - 1 - i;
+            d = edit_bracket_get_kind ((unsigned char) s[j], &k);
+            if (d == 0 || k != kind)
+                continue;
+
+            q = (dir > 0 ? start : finish - len) + j;
+            if (edit_brackets_get_context (edit, q) != context)
+                continue;
+
+            *depth += d * dir;
+            if (*depth == 0)
+                return q;
+        }
+
+        if (dir > 0)
+            start += len;
+        else
+            finish -= len;
+    }
+
+    return -1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_brackets_init (edit_brackets_t * brackets)
+{
+    brackets->chunks = NULL;
+    brackets->lengths = NULL;
+    brackets->rules = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_brackets_clean (edit_brackets_t * brackets)
+{
+    if (brackets->chunks != NULL)
+    {
+        g_array_free (brackets->chunks, TRUE);
+        brackets->chunks = NULL;
+        g_array_free (brackets->lengths, TRUE);
+        brackets->lengths = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update the index when the text is changed. Only chunks touched by the change are summarized
+ * again.
+ *
+ * @param brackets index of brackets
+ * @param offset offset of the change
+ * @param deleted number of bytes removed at the offset
+ * @param inserted number of bytes inserted at the offset
+ */
+
+void
+edit_brackets_update (edit_brackets_t * brackets, off_t offset, off_t deleted, off_t inserted)
+{
+    GArray *chunks = brackets->chunks;
+    edit_bracket_chunk_t *c;
+    off_t start;
+    guint i;
+
+    if (chunks == NULL)
+        return;
+
+    i = edit_brackets_find_chunk (brackets, offset, &start);
+
+    /* deleted text may span several chunks */
+    while (deleted > 0 && i < chunks->len)
+    {
+        off_t d;
+
+        c = &g_array_index (chunks, edit_bracket_chunk_t, i);
+        d = MIN (deleted, c->len - (offset - start));
+        edit_brackets_add_len (brackets, i, -d);
+        c->valid = FALSE;
+        deleted -= d;
+
+        /* the rest of deleted text starts the next chunk */
+        if (c->len == 0)
+        {
+            g_array_remove_index (chunks, i);
+            g_array_set_size (brackets->lengths, 0);
+        }
+        else
+        {
+            start += c->len;
+            i++;
+        }
+    }
+
+    if (inserted <= 0)
+        return;
+
+    /* text inserted between chunks goes to the preceding one */
+    i = edit_brackets_find_chunk (brackets, offset, &start);
+    if (i != 0 && offset == start)
+        i--;
+
+    if (i == chunks->len)
+    {
+        edit_bracket_chunk_t n;
+
+        memset (&n, 0, sizeof (n));
+        g_array_append_val (chunks, n);
+        g_array_set_size (brackets->lengths, 0);
+    }
+
+    edit_brackets_add_len (brackets, i, inserted);
+    c = &g_array_index (chunks, edit_bracket_chunk_t, i);
+    c->valid = FALSE;
+
+    /* split chunk grown too long */
+    if (c->len > 2 * BRACKET_CHUNK_SIZE)
+    {
+        edit_bracket_chunk_t *rest;
+        guint n, j;
+
+        n = (guint) (c->len / BRACKET_CHUNK_SIZE - 1);
+        c->len -= BRACKET_CHUNK_SIZE * (off_t) n;
+
+        rest = g_new0 (edit_bracket_chunk_t, n);
+        for (j = 0; j < n; j++)
+            rest[j].len = BRACKET_CHUNK_SIZE;
+        g_array_insert_vals (chunks, i + 1, rest, n);
+        g_free (rest);
+        g_array_set_size (brackets->lengths, 0);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the bracket matching the one at the offset.
+ *
+ * @param edit editor object
+ * @param offset offset of bracket
+ * @param start offset of the first byte to search in
+ * @param finish offset of the byte following the last one to search in
+ *
+ * @return offset of the matching bracket, -1 if the byte at offset is not a bracket or no match
+ *         is found in the range
+ */
+
+off_t
+edit_brackets_find (WEdit * edit, off_t offset, off_t start, off_t finish)
+{
+    edit_brackets_t *brackets = &edit->brackets;
+    off_t cstart, pos;
+    long depth = 1;
+    int kind, dir, context;
+    guint i;
+
+    if (offset < 0 || offset >= edit->buffer.size)
+        return -1;
+
+    dir = edit_bracket_get_kind (edit_buffer_get_byte (&edit->buffer, offset), &kind);
+    if (dir == 0)
+        return -1;
+
+    start = MAX (start, 0);
+    finish = MIN (finish, edit->buffer.size);
+
+    context = edit_brackets_get_context (edit, offset);
+    /* brackets inside strings and comments */
+    if (context != 0)
+        return (dir > 0) ? edit_brackets_scan (edit, offset + 1, finish, kind, 1, context, &depth)
+            : edit_brackets_scan (edit, start, offset, kind, -1, context, &depth);
+
+    if (brackets->chunks != NULL && brackets->rules != edit_brackets_get_rules (edit))
+        edit_brackets_clean (brackets);
+    if (brackets->chunks == NULL)
+        edit_brackets_build (brackets, edit);
+
+    i = edit_brackets_find_chunk (brackets, offset, &cstart);
+    if (i == brackets->chunks->len)
+        return -1;
+
+    if (dir > 0)
+    {
+        /* the rest of chunk of bracket */
+        pos = MIN (cstart + g_array_index (brackets->chunks, edit_bracket_chunk_t, i).len, finish);
+        pos = edit_brackets_scan (edit, offset + 1, pos, kind, 1, 0, &depth);
+        if (pos >= 0)
+            return pos;
+
+        for (cstart += g_array_index (brackets->chunks, edit_bracket_chunk_t, i).len, i++;
+             i < brackets->chunks->len && cstart < finish; i++)
+        {
+            const edit_bracket_chunk_t *c;
+
+            c = edit_brackets_summarize (brackets, edit, i, cstart);
+
+            if (depth + c->min[kind] > 0 && cstart + c->len <= finish)
+                depth += c->net[kind];
+            else
+            {
+                pos = edit_brackets_scan (edit, cstart, MIN (cstart + c->len, finish), kind, 1,
+                                          0, &depth);
+                if (pos >= 0)
+                    return pos;
+            }
+
+            cstart += c->len;
+        }
+    }
+    else
+    {
+        pos = edit_brackets_scan (edit, MAX (cstart, start), offset, kind, -1, 0, &depth);
+        if (pos >= 0)
+            return pos;
+
+        while (i-- != 0 && cstart > start)
+        {
+            const edit_bracket_chunk_t *c;
+
+            cstart -= g_array_index (brackets->chunks, edit_bracket_chunk_t, i).len;
+            c = edit_brackets_summarize (brackets, edit, i, cstart);
+
+            /* the highest depth is reached at the start of chunk going backward */
+            if (depth - (c->net[kind] - c->min[kind]) > 0 && cstart >= start)
+                depth -= c->net[kind];
+            else
+            {
+                pos = edit_brackets_scan (edit, MAX (cstart, start), cstart + c->len, kind, -1,
+                                          0, &depth);
+                if (pos >= 0)
+                    return pos;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
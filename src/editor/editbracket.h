@@ -0,0 +1,38 @@
+/** \file
+ *  \brief Header: index of brackets of editor buffer for bracket matching
+ */
+
+#ifndef MC__EDIT_BRACKET_H
+#define MC__EDIT_BRACKET_H
+
+#include "edit.h"               /* WEdit */
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_brackets_struct
+{
+    GArray *chunks;             /* summaries of consecutive parts of text, NULL if the index
+                                   is not built */
+    GArray *lengths;            /* Fenwick tree of lengths of chunks, empty if it has to be built
+                                   again */
+    const void *rules;          /* syntax rules the summaries were made with, NULL if none */
+} edit_brackets_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_brackets_init (edit_brackets_t * brackets);
+void edit_brackets_clean (edit_brackets_t * brackets);
+
+void edit_brackets_update (edit_brackets_t * brackets, off_t offset, off_t deleted,
+                           off_t inserted);
+off_t edit_brackets_find (WEdit * edit, off_t offset, off_t start, off_t finish);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_BRACKET_H */
@@ -35,102 +35,857 @@
 #include <string.h>
 #include <ctype.h>
 #include <sys/types.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>             /* sysconf() */
+#endif
+#ifdef HAVE_WRITEV
+#include <errno.h>
+#include <limits.h>             /* IOV_MAX */
+#include <sys/uio.h>
+#endif
+#if defined (__GNUC__) && defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__GNUC__) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lib/global.h"
+
+#include "lib/vfs/vfs.h"
+
+#include "edit-impl.h"
+#include "editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ *
+ * here's a quick sketch of the layout: (don't run this through indent.)
+ *
+ *                                       |
+ * \0\0\0\0\0m e _ f i l e . \nf i n . \n|T h i s _ i s _ s o\0\0\0\0\0\0\0\0\0
+ * ______________________________________|______________________________________
+ *                                       |
+ * ...  |  b2[2]   |  b2[1]   |  b2[0]   |  b1[0]   |  b1[1]   |  b1[2]   | ...
+ *      |->        |->        |->        |->        |->        |->        |
+ *                                       |
+ *           _<------------------------->|<----------------->_
+ *                       curs2           |       curs1
+ *           ^                           |                   ^
+ *           |                          ^|^                  |
+ *         cursor                       |||                cursor
+ *                                      |||
+ *                              file end|||file beginning
+ *                                       |
+ *                                       |
+ *
+ *           _
+ * This_is_some_file
+ * fin.
+ *
+ *
+ * This is called a "gap buffer".
+ *
+ * Since b2 blocks are aligned to the end of file, all full blocks of a file loaded by
+ * edit_buffer_map_file() can point directly into a read-only private mapping of that file.
+ * Such blocks are never written to: before the first modification the block is copied
+ * to the heap (see edit_buffer_get_block_for_write()).
+ *
+ * Another process can truncate the mapped file, e.g. a log rotated by copying and truncating.
+ * Reading a page past the new end of file raises SIGBUS. The handler of SIGBUS replaces such
+ * pages with null bytes and marks the mapping, so that the editor detaches the buffer from file
+ * (see edit_buffer_unmap()) and reports the loss. Writes of other processes to the parts of
+ * file not copied to the heap yet are seen in the buffer until it is detached.
+ *
+ * See also:
+ * http://en.wikipedia.org/wiki/Gap_buffer
+ * http://stackoverflow.com/questions/4199694/data-structure-for-text-editor
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/*
+ * The editor keeps data in two arrays of buffers.
+ * All buffers have the same size, which must be a power of 2.
+ */
+
+/* Configurable: log2 of the buffer size in bytes */
+#ifndef S_EDIT_BUF_SIZE
+#define S_EDIT_BUF_SIZE 16
+#endif
+
+/* Size of the buffer */
+#define EDIT_BUF_SIZE (((off_t) 1) << S_EDIT_BUF_SIZE)
+
+/* Buffer mask (used to find cursor position relative to the buffer) */
+#define M_EDIT_BUF_SIZE (EDIT_BUF_SIZE - 1)
+
+/* Moves over fewer lines are faster to do by scanning than by line index */
+#define LINE_INDEX_MIN_LINES 16
+
+/* Max number of blocks written to local file by single system call */
+#if defined (IOV_MAX) && IOV_MAX < 64
+#define WRITE_FILE_IOV IOV_MAX
+#else
+#define WRITE_FILE_IOV 64
+#endif
+
+/* Max number of released blocks kept for reuse (4 MB) */
+#define BLOCK_POOL_MAX 64
+
+#if defined (HAVE_MMAP) && !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/*** file scope type declarations ****************************************************************/
+
+#ifdef HAVE_MMAP
+/* file mapping of buffer, as seen by the handler of SIGBUS */
+typedef struct
+{
+    const char *map;
+    off_t size;
+    volatile sig_atomic_t truncated;    /* part of the mapping was lost and replaced */
+} edit_buffer_mapping_t;
+#endif
+
+/*** file scope variables ************************************************************************/
+
+/* all blocks of the part of file not loaded yet point here; it is filled with newlines */
+static char edit_buffer_unloaded_block[EDIT_BUF_SIZE];
+
+/* blocks released by all buffers, linked through their first bytes */
+static void *edit_buffer_pool = NULL;
+static edit_buffer_pool_stats_t edit_buffer_pool_stats;
+
+#ifdef HAVE_MMAP
+/* file mappings of all buffers, looked through by the handler of SIGBUS */
+static GSList *edit_buffer_mappings = NULL;
+/* action of SIGBUS before the first file was mapped */
+static struct sigaction edit_buffer_sigbus_saved;
+static size_t edit_buffer_page_size;
+#endif
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get pointer to byte at specified index
+  *
+  * @param buf pointer to editor buffer
+  * @param byte_index byte index
+  *
+  * @return NULL if byte_index is negative or larger than file size; pointer to byte otherwise.
+  */
+static char *
+edit_buffer_get_byte_ptr (const edit_buffer_t * buf, off_t byte_index)
+{
+    void *b;
+
+    if (byte_index >= (buf->curs1 + buf->curs2) || byte_index < 0)
+        return NULL;
+
+    if (byte_index >= buf->curs1)
+    {
+        off_t p;
+
+        p = buf->curs1 + buf->curs2 - byte_index - 1;
+        b = g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE);
+        return (char *) b + EDIT_BUF_SIZE - 1 - (p & M_EDIT_BUF_SIZE);
+    }
+
+    b = g_ptr_array_index (buf->b1, byte_index >> S_EDIT_BUF_SIZE);
+    return (char *) b + (byte_index & M_EDIT_BUF_SIZE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Count newline characters in memory area.
+  * SSE2 or AVX2 instructions are used if the compiler targets them.
+  *
+  * @param s pointer to memory area
+  * @param len size of memory area
+  *
+  * @return number of '\n' characters in memory area
+  */
+
+static long
+edit_buffer_count_newlines (const char *s, size_t len)
+{
+    const char *end;
+    long lines = 0;
+
+#if defined (__GNUC__) && defined (__AVX2__)
+    const __m256i nl = _mm256_set1_epi8 ('\n');
+
+    for (; len >= sizeof (__m256i); s += sizeof (__m256i), len -= sizeof (__m256i))
+    {
+        __m256i v;
+
+        v = _mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i *) s), nl);
+        lines += __builtin_popcount ((unsigned int) _mm256_movemask_epi8 (v));
+    }
+#elif defined (__GNUC__) && defined (__SSE2__)
+    const __m128i nl = _mm_set1_epi8 ('\n');
+
+    for (; len >= sizeof (__m128i); s += sizeof (__m128i), len -= sizeof (__m128i))
+    {
+        __m128i v;
+
+        v = _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) s), nl);
+        lines += __builtin_popcount ((unsigned int) _mm_movemask_epi8 (v));
+    }
+#endif
+
+    /* the tail or the whole area if there are no vector instructions */
+    for (end = s + len; (s = memchr (s, '\n', end - s)) != NULL; s++)
+        lines++;
+
+    return lines;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Find the last occurrence of character in memory area
+  *
+  * @param s pointer to memory area
+  * @param c character to find
+  * @param len size of memory area
+  *
+  * @return pointer to found character or NULL if not found
+  */
+
+static const char *
+edit_buffer_memrchr (const char *s, int c, size_t len)
+{
+#ifdef HAVE_MEMRCHR
+    return (const char *) memrchr (s, c, len);
+#else
+    while (len-- != 0)
+        if (s[len] == (char) c)
+            return s + len;
+
+    return NULL;
+#endif
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*
+ * Line index.
+ *
+ * Number of newlines in every block is kept in Fenwick tree (binary indexed tree), one tree per
+ * array of blocks. Element 0 of tree is unused, block i is kept in element i + 1. Since blocks
+ * are added and removed only at the end of arrays, trees are updated in O(log n) by all buffer
+ * modifications. Trees are built on demand, when line index is queried first time.
+ */
+
+/**
+  * Get number of newlines in first blocks
+  *
+  * @param tree line index tree
+  * @param n number of blocks
+  *
+  * @return number of newlines in blocks [0, n)
+  */
+
+static long
+edit_buffer_line_index_sum (const GArray * tree, guint n)
+{
+    long sum = 0;
+
+    for (; n != 0; n &= n - 1)
+        sum += g_array_index (tree, long, n);
+
+    return sum;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get number of newlines in all blocks
+  *
+  * @param tree line index tree
+  *
+  * @return number of newlines in all blocks
+  */
+
+static inline long
+edit_buffer_line_index_total (const GArray * tree)
+{
+    return edit_buffer_line_index_sum (tree, tree->len - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Change number of newlines in block
+  *
+  * @param tree line index tree
+  * @param index index of block
+  * @param delta value to add to number of newlines in block
+  */
+
+static void
+edit_buffer_line_index_add (GArray * tree, guint index, long delta)
+{
+    guint n;
+
+    if (tree->len == 0 || delta == 0)
+        return;
+
+    for (n = index + 1; n < tree->len; n += n & (~n + 1))
+        g_array_index (tree, long, n) += delta;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Register new block added to the end of array
+  *
+  * @param tree line index tree
+  * @param count number of newlines in block
+  */
+
+static void
+edit_buffer_line_index_push (GArray * tree, long count)
+{
+    guint n;
+
+    if (tree->len == 0)
+        return;
+
+    n = tree->len;
+    count += edit_buffer_line_index_sum (tree, n - 1) - edit_buffer_line_index_sum (tree,
+                                                                                    n & (n - 1));
+    g_array_append_val (tree, count);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Unregister the last block removed from array
+  *
+  * @param tree line index tree
+  */
+
+static inline void
+edit_buffer_line_index_pop (GArray * tree)
+{
+    if (tree->len != 0)
+        g_array_set_size (tree, tree->len - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Find block containing newline with specified number
+  *
+  * @param tree line index tree
+  * @param count number of newline, must be in range [1, total number of newlines]
+  *
+  * @return index of block. In count, number of newline inside block is returned.
+  */
+
+static guint
+edit_buffer_line_index_search (const GArray * tree, long *count)
+{
+    guint pos = 0;
+    guint step;
+
+    for (step = 1; step * 2 < tree->len; step *= 2)
+        ;
+
+    for (; step != 0; step /= 2)
+        if (pos + step < tree->len && g_array_index (tree, long, pos + step) < *count)
+        {
+            pos += step;
+            *count -= g_array_index (tree, long, pos);
+        }
+
+    return pos;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get valid data area of block: the last block of b1 is filled from the beginning,
+  * the last block of b2 is filled up to the end, all other blocks are full.
+  *
+  * @param buf pointer to editor buffer
+  * @param blocks b1 or b2 array of buf
+  * @param index index of block
+  * @param len size of data area
+  *
+  * @return pointer to data area
+  */
+
+static const char *
+edit_buffer_get_block_data (const edit_buffer_t * buf, const GPtrArray * blocks, guint index,
+                            off_t * len)
+{
+    const char *b;
+
+    b = (const char *) g_ptr_array_index (blocks, index);
+
+    if (index != blocks->len - 1)
+        *len = EDIT_BUF_SIZE;
+    else if (blocks == buf->b1)
+        *len = ((buf->curs1 - 1) & M_EDIT_BUF_SIZE) + 1;
+    else
+    {
+        *len = ((buf->curs2 - 1) & M_EDIT_BUF_SIZE) + 1;
+        b += EDIT_BUF_SIZE - *len;
+    }
+
+    return b;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Build line index if it isn't built yet.
+  *
+  * @param buf pointer to editor buffer
+  *
+  * @return TRUE if line index can be used, FALSE if lines of mapped file are not counted yet
+  */
+
+static gboolean
+edit_buffer_line_index_prepare (const edit_buffer_t * buf)
+{
+    guint i;
+
+    /* don't read whole mapped file while it is counted in background */
+    if (edit_buffer_lines_pending (buf))
+        return FALSE;
+
+    if (buf->lines1->len != 0)
+        return TRUE;
+
+    g_array_set_size (buf->lines1, 1);
+    g_array_index (buf->lines1, long, 0) = 0;
+    g_array_set_size (buf->lines2, 1);
+    g_array_index (buf->lines2, long, 0) = 0;
+
+    for (i = 0; i < buf->b1->len; i++)
+    {
+        const char *b;
+        off_t len;
+
+        b = edit_buffer_get_block_data (buf, buf->b1, i, &len);
+        edit_buffer_line_index_push (buf->lines1, edit_buffer_count_newlines (b, (size_t) len));
+    }
+
+    for (i = 0; i < buf->b2->len; i++)
+    {
+        const char *b;
+        off_t len;
+
+        b = edit_buffer_get_block_data (buf, buf->b2, i, &len);
+        edit_buffer_line_index_push (buf->lines2, edit_buffer_count_newlines (b, (size_t) len));
+    }
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get number of newlines before specified offset using line index
+  *
+  * @param buf pointer to editor buffer
+  * @param offset byte offset in range [0, buf->size]
+  *
+  * @return number of newlines in range [0, offset)
+  */
+
+static long
+edit_buffer_line_index_count (const edit_buffer_t * buf, off_t offset)
+{
+    long lines;
+    off_t m;
+    guint i;
+
+    if (offset <= buf->curs1)
+    {
+        i = (guint) (offset >> S_EDIT_BUF_SIZE);
+        lines = edit_buffer_line_index_sum (buf->lines1, i);
+        if ((offset & M_EDIT_BUF_SIZE) != 0)
+            lines += edit_buffer_count_newlines (g_ptr_array_index (buf->b1, i),
+                                                 (size_t) (offset & M_EDIT_BUF_SIZE));
+        return lines;
+    }
+
+    /* number of newlines in b2 before offset is counted from the end of file */
+    m = buf->size - offset;
+    i = (guint) (m >> S_EDIT_BUF_SIZE);
+    lines = edit_buffer_line_index_sum (buf->lines2, i);
+    if ((m & M_EDIT_BUF_SIZE) != 0)
+        lines += edit_buffer_count_newlines ((const char *) g_ptr_array_index (buf->b2, i) +
+                                             EDIT_BUF_SIZE - (m & M_EDIT_BUF_SIZE),
+                                             (size_t) (m & M_EDIT_BUF_SIZE));
+
+    return edit_buffer_line_index_total (buf->lines1) + edit_buffer_line_index_total (buf->lines2)
+        - lines;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Find offset of line beginning using line index
+  *
+  * @param buf pointer to editor buffer
+  * @param line line number, must be in range [1, total number of newlines]
+  *
+  * @return offset of the first byte of line
+  */
+
+static off_t
+edit_buffer_line_index_find (const edit_buffer_t * buf, long line)
+{
+    const char *b, *s;
+    off_t len;
+    long total1, count;
+    guint i;
+
+    total1 = edit_buffer_line_index_total (buf->lines1);
+
+    if (line <= total1)
+    {
+        count = line;
+        i = edit_buffer_line_index_search (buf->lines1, &count);
+        b = edit_buffer_get_block_data (buf, buf->b1, i, &len);
+    }
+    else
+    {
+        /* in b2, newlines are numbered from the end of file */
+        count = edit_buffer_line_index_total (buf->lines2) - (line - total1) + 1;
+        i = edit_buffer_line_index_search (buf->lines2, &count);
+        b = edit_buffer_get_block_data (buf, buf->b2, i, &len);
+        count = edit_buffer_count_newlines (b, (size_t) len) - count + 1;
+    }
+
+    for (s = b; (s = memchr (s, '\n', b + len - s)) != NULL && --count != 0; s++)
+        ;
+
+    if (line <= total1)
+        return ((off_t) i << S_EDIT_BUF_SIZE) + (s - b) + 1;
+
+    /* s points to byte in b2 block: get its offset from the end of file */
+    return buf->size - ((off_t) i << S_EDIT_BUF_SIZE) - (b + len - s) + 1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Check whether block points into file mapping or is a placeholder of the part of file
+  * not loaded yet
+  *
+  * @param buf pointer to editor buffer
+  * @param b block
+  *
+  * @return TRUE if block is not owned by buffer, FALSE if it is allocated in the heap
+  */
+
+static inline gboolean
+edit_buffer_block_is_mapped (const edit_buffer_t * buf, const void *b)
+{
+    return ((const char *) b == edit_buffer_unloaded_block
+            || (buf->map != NULL && (const char *) b >= buf->map
+                && (const char *) b < buf->map + buf->map_size));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Allocate block, reusing one released before if possible. Block content is undefined.
+  *
+  * @return pointer to block
+  */
+
+static void *
+edit_buffer_alloc_block (void)
+{
+    void *b;
+
+    b = edit_buffer_pool;
+
+    if (b == NULL)
+    {
+        b = g_malloc (EDIT_BUF_SIZE);
+        edit_buffer_pool_stats.allocated++;
+    }
+    else
+    {
+        edit_buffer_pool = *(void **) b;
+        edit_buffer_pool_stats.cached--;
+        edit_buffer_pool_stats.reused++;
+    }
+
+    return b;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Release block allocated by edit_buffer_alloc_block(): keep it for reuse or free it
+  *
+  * @param b block
+  */
+
+static void
+edit_buffer_release_block (void *b)
+{
+    if (edit_buffer_pool_stats.cached < BLOCK_POOL_MAX)
+    {
+        *(void **) b = edit_buffer_pool;
+        edit_buffer_pool = b;
+        edit_buffer_pool_stats.cached++;
+    }
+    else
+    {
+        g_free (b);
+        edit_buffer_pool_stats.freed++;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get block to be modified. If block points into file mapping, it is replaced with its copy.
+  *
+  * @param buf pointer to editor buffer
+  * @param blocks b1 or b2 array of buf
+  * @param index index of block in array
+  *
+  * @return pointer to writable block
+  */
+
+static void *
+edit_buffer_get_block_for_write (edit_buffer_t * buf, GPtrArray * blocks, guint index)
+{
+    void *b;
+
+    b = g_ptr_array_index (blocks, index);
+
+    if (edit_buffer_block_is_mapped (buf, b))
+    {
+        b = memcpy (edit_buffer_alloc_block (), b, EDIT_BUF_SIZE);
+        g_ptr_array_index (blocks, index) = b;
+    }
+
+    return b;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Release block if it is not a part of file mapping
+  *
+  * @param buf pointer to editor buffer
+  * @param b block
+  */
+
+static void
+edit_buffer_free_block (const edit_buffer_t * buf, void *b)
+{
+    if (!edit_buffer_block_is_mapped (buf, b))
+        edit_buffer_release_block (b);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Free all blocks of array and array itself
+  *
+  * @param buf pointer to editor buffer
+  * @param blocks b1 or b2 array of buf
+  */
+
+static void
+edit_buffer_free_blocks (const edit_buffer_t * buf, GPtrArray * blocks)
+{
+    guint i;
+
+    for (i = 0; i < blocks->len; i++)
+        edit_buffer_free_block (buf, g_ptr_array_index (blocks, i));
+
+    g_ptr_array_free (blocks, TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+#ifdef HAVE_WRITEV
+/**
+ * Write editor buffer content to local file, gathering blocks into as few system calls
+ * as possible.
+ *
+ * @param buf pointer to editor buffer
+ * @param fd system file descriptor
+ *
+ * @return number of written bytes, -1 if nothing was written because of error
+ */
+
+static off_t
+edit_buffer_writev (const edit_buffer_t * buf, int fd)
+{
+    struct iovec iov[WRITE_FILE_IOV];
+    off_t ret = 0;
+    off_t pos = 0;
+
+    while (pos < buf->size)
+    {
+        struct iovec *v = iov;
+        int n;
+
+        for (n = 0; n < WRITE_FILE_IOV && pos < buf->size; n++)
+        {
+            off_t len;
+
+            iov[n].iov_base = (void *) edit_buffer_get_span (buf, pos, &len);
+            iov[n].iov_len = (size_t) len;
+            pos += len;
+        }
+
+        while (n > 0)
+        {
+            ssize_t sz;
+
+            sz = writev (fd, v, n);
+            if (sz < 0 && errno == EINTR)
+                continue;
+            if (sz <= 0)
+                return (ret != 0 ? ret : sz);
+
+            ret += sz;
+
+            /* skip the written vectors and the written part of the next one */
+            for (; n > 0 && (size_t) sz >= v->iov_len; v++, n--)
+                sz -= (ssize_t) v->iov_len;
+            if (n > 0)
+            {
+                v->iov_base = (char *) v->iov_base + sz;
+                v->iov_len -= (size_t) sz;
+            }
+        }
+    }
+
+    return ret;
+}
+#endif /* HAVE_WRITEV */
+
+/* --------------------------------------------------------------------------------------------- */
+#ifdef HAVE_MMAP
+/**
+ * Handler of SIGBUS. It is raised by reading a page of mapped file past the end of file, after
+ * the file was truncated by another process. Such page and all following pages of the mapping
+ * are replaced with anonymous pages of null bytes, and the faulted read is restarted. The mapping
+ * is marked, so that the buffer is detached from the file. Faults outside of file mappings of
+ * buffers are passed to the previous action of the signal.
+ */
+
+static void
+edit_buffer_sigbus (int sig, siginfo_t * info, void *context)
+{
+    const char *addr = (const char *) info->si_addr;
+    GSList *l;
 
-#include "lib/global.h"
+    (void) context;
 
-#include "lib/vfs/vfs.h"
+    for (l = edit_buffer_mappings; l != NULL; l = l->next)
+    {
+        edit_buffer_mapping_t *m = (edit_buffer_mapping_t *) l->data;
 
-#include "edit-impl.h"
-#include "editbuffer.h"
+        if (addr >= m->map && addr < m->map + m->size)
+        {
+            const char *page;
+
+            page = m->map + ((size_t) (addr - m->map) & ~(edit_buffer_page_size - 1));
+            if (mmap ((void *) page, (size_t) (m->map + m->size - page), PROT_READ,
+                      MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) == MAP_FAILED)
+                break;
+
+            m->truncated = 1;
+            return;
+        }
+    }
+
+    /* restarted read raises the signal again with the previous action */
+    sigaction (sig, &edit_buffer_sigbus_saved, NULL);
+}
 
 /* --------------------------------------------------------------------------------------------- */
-/*-
- *
- * here's a quick sketch of the layout: (don't run this through indent.)
- *
- *                                       |
- * \0\0\0\0\0m e _ f i l e . \nf i n . \n|T h i s _ i s _ s o\0\0\0\0\0\0\0\0\0
- * ______________________________________|______________________________________
- *                                       |
- * ...  |  b2[2]   |  b2[1]   |  b2[0]   |  b1[0]   |  b1[1]   |  b1[2]   | ...
- *      |->        |->        |->        |->        |->        |->        |
- *                                       |
- *           _<------------------------->|<----------------->_
- *                       curs2           |       curs1
- *           ^                           |                   ^
- *           |                          ^|^                  |
- *         cursor                       |||                cursor
- *                                      |||
- *                              file end|||file beginning
- *                                       |
- *                                       |
- *
- *           _
- * This_is_some_file
- * fin.
+/**
+ * Find the file mapping of buffer. Mappings aren't kept in buffers, because a buffer can be
+ * moved to another editor object as a whole (see edit_reload_line()).
  *
+ * @param buf pointer to editor buffer
  *
- * This is called a "gap buffer".
- * See also:
- * http://en.wikipedia.org/wiki/Gap_buffer
- * http://stackoverflow.com/questions/4199694/data-structure-for-text-editor
+ * @return list item of the mapping, NULL if buffer isn't mapped from file
  */
 
-/*** global variables ****************************************************************************/
+static GSList *
+edit_buffer_map_find (const edit_buffer_t * buf)
+{
+    GSList *l;
 
-/*** file scope macro definitions ****************************************************************/
+    for (l = edit_buffer_mappings; l != NULL; l = l->next)
+        if (((edit_buffer_mapping_t *) l->data)->map == buf->map)
+            break;
 
-/*
- * The editor keeps data in two arrays of buffers.
- * All buffers have the same size, which must be a power of 2.
+    return l;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Make SIGBUS handler aware of the file mapping of buffer. Handler is installed along with
+ * the first mapping.
+ *
+ * @param buf pointer to editor buffer
  */
 
-/* Configurable: log2 of the buffer size in bytes */
-#ifndef S_EDIT_BUF_SIZE
-#define S_EDIT_BUF_SIZE 16
-#endif
+static void
+edit_buffer_map_register (const edit_buffer_t * buf)
+{
+    edit_buffer_mapping_t *m;
 
-/* Size of the buffer */
-#define EDIT_BUF_SIZE (((off_t) 1) << S_EDIT_BUF_SIZE)
+    if (edit_buffer_mappings == NULL)
+    {
+        struct sigaction sa;
 
-/* Buffer mask (used to find cursor position relative to the buffer) */
-#define M_EDIT_BUF_SIZE (EDIT_BUF_SIZE - 1)
+        memset (&sa, 0, sizeof (sa));
+        sa.sa_sigaction = edit_buffer_sigbus;
+        sa.sa_flags = SA_SIGINFO;
+        sigemptyset (&sa.sa_mask);
+        sigaction (SIGBUS, &sa, &edit_buffer_sigbus_saved);
 
-/*** file scope type declarations ****************************************************************/
+        edit_buffer_page_size = (size_t) sysconf (_SC_PAGESIZE);
+    }
 
-/*** file scope variables ************************************************************************/
+    m = g_new (edit_buffer_mapping_t, 1);
+    m->map = buf->map;
+    m->size = buf->map_size;
+    m->truncated = 0;
+
+    /* item is complete before it is linked, the handler never sees a partial one */
+    edit_buffer_mappings = g_slist_prepend (edit_buffer_mappings, m);
+}
 
-/* --------------------------------------------------------------------------------------------- */
-/*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 /**
-  * Get pointer to byte at specified index
-  *
-  * @param buf pointer to editor buffer
-  * @param byte_index byte index
-  *
-  * @return NULL if byte_index is negative or larger than file size; pointer to byte otherwise.
-  */
-static char *
-edit_buffer_get_byte_ptr (const edit_buffer_t * buf, off_t byte_index)
-{
-    void *b;
+ * Unmap the file buffer is mapped from. Previous action of SIGBUS is restored along with
+ * the last mapping.
+ *
+ * @param buf pointer to editor buffer
+ */
 
-    if (byte_index >= (buf->curs1 + buf->curs2) || byte_index < 0)
-        return NULL;
+static void
+edit_buffer_map_release (edit_buffer_t * buf)
+{
+    GSList *l;
 
-    if (byte_index >= buf->curs1)
+    /* mapping is forgotten first, unmapped range can be reused by anything else */
+    l = edit_buffer_map_find (buf);
+    if (l != NULL)
     {
-        off_t p;
-
-        p = buf->curs1 + buf->curs2 - byte_index - 1;
-        b = g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE);
-        return (char *) b + EDIT_BUF_SIZE - 1 - (p & M_EDIT_BUF_SIZE);
+        g_free (l->data);
+        edit_buffer_mappings = g_slist_delete_link (edit_buffer_mappings, l);
+        if (edit_buffer_mappings == NULL)
+            sigaction (SIGBUS, &edit_buffer_sigbus_saved, NULL);
     }
 
-    b = g_ptr_array_index (buf->b1, byte_index >> S_EDIT_BUF_SIZE);
-    return (char *) b + (byte_index & M_EDIT_BUF_SIZE);
+    munmap (buf->map, (size_t) buf->map_size);
+    buf->map = NULL;
+    buf->map_size = 0;
+    buf->map_counted = 0;
 }
+#endif /* HAVE_MMAP */
 
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
@@ -152,6 +907,17 @@ edit_buffer_init (edit_buffer_t * buf, off_t size)
 
     buf->size = size;
     buf->lines = 0;
+    buf->generation = 0;
+
+    buf->map = NULL;
+    buf->map_size = 0;
+    buf->map_counted = 0;
+
+    buf->lines1 = g_array_new (FALSE, FALSE, sizeof (long));
+    buf->lines2 = g_array_new (FALSE, FALSE, sizeof (long));
+
+    buf->load_offset = 0;
+    buf->load_size = 0;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -165,16 +931,24 @@ void
 edit_buffer_clean (edit_buffer_t * buf)
 {
     if (buf->b1 != NULL)
-    {
-        g_ptr_array_foreach (buf->b1, (GFunc) g_free, NULL);
-        g_ptr_array_free (buf->b1, TRUE);
-    }
+        edit_buffer_free_blocks (buf, buf->b1);
 
     if (buf->b2 != NULL)
-    {
-        g_ptr_array_foreach (buf->b2, (GFunc) g_free, NULL);
-        g_ptr_array_free (buf->b2, TRUE);
-    }
+        edit_buffer_free_blocks (buf, buf->b2);
+
+    if (buf->lines1 != NULL)
+        g_array_free (buf->lines1, TRUE);
+
+    if (buf->lines2 != NULL)
+        g_array_free (buf->lines2, TRUE);
+
+#ifdef HAVE_MMAP
+    if (buf->map != NULL)
+        edit_buffer_map_release (buf);
+#endif
+
+    buf->load_offset = 0;
+    buf->load_size = 0;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -197,6 +971,83 @@ edit_buffer_get_byte (const edit_buffer_t * buf, off_t byte_index)
     return (p != NULL) ? *(unsigned char *) p : '\n';
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get contiguous span of bytes starting at specified index. The span is limited by the block
+  * containing the byte and by the cursor. Sequential spans cover the buffer in file order.
+  *
+  * @param buf pointer to editor buffer
+  * @param byte_index byte index
+  * @param len size of span
+  *
+  * @return NULL if byte_index is negative or not less than file size; pointer to byte otherwise.
+  */
+
+const char *
+edit_buffer_get_span (const edit_buffer_t * buf, off_t byte_index, off_t * len)
+{
+    const char *b;
+
+    if (byte_index >= (buf->curs1 + buf->curs2) || byte_index < 0)
+    {
+        *len = 0;
+        return NULL;
+    }
+
+    if (byte_index >= buf->curs1)
+    {
+        off_t p;
+
+        p = buf->curs1 + buf->curs2 - byte_index - 1;
+        b = g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE);
+        *len = (p & M_EDIT_BUF_SIZE) + 1;
+        return b + EDIT_BUF_SIZE - *len;
+    }
+
+    b = g_ptr_array_index (buf->b1, byte_index >> S_EDIT_BUF_SIZE);
+    *len = MIN (EDIT_BUF_SIZE - (byte_index & M_EDIT_BUF_SIZE), buf->curs1 - byte_index);
+    return b + (byte_index & M_EDIT_BUF_SIZE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+  * Get contiguous span of bytes ending just before specified index. The span is limited by the
+  * block containing the byte and by the cursor.
+  *
+  * @param buf pointer to editor buffer
+  * @param byte_index index of byte following the span
+  * @param len size of span
+  *
+  * @return NULL if byte_index is not positive or larger than file size; pointer to the first
+  *         byte of span otherwise.
+  */
+
+const char *
+edit_buffer_get_span_backward (const edit_buffer_t * buf, off_t byte_index, off_t * len)
+{
+    const char *b;
+
+    if (byte_index > (buf->curs1 + buf->curs2) || byte_index <= 0)
+    {
+        *len = 0;
+        return NULL;
+    }
+
+    if (byte_index > buf->curs1)
+    {
+        off_t p;
+
+        p = buf->curs1 + buf->curs2 - byte_index;
+        b = g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE);
+        *len = MIN (EDIT_BUF_SIZE - (p & M_EDIT_BUF_SIZE), byte_index - buf->curs1);
+        return b + EDIT_BUF_SIZE - (p & M_EDIT_BUF_SIZE) - *len;
+    }
+
+    b = g_ptr_array_index (buf->b1, (byte_index - 1) >> S_EDIT_BUF_SIZE);
+    *len = ((byte_index - 1) & M_EDIT_BUF_SIZE) + 1;
+    return b;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 #ifdef HAVE_CHARSET
@@ -334,9 +1185,19 @@ edit_buffer_count_lines (const edit_buffer_t * buf, off_t first, off_t last)
     first = MAX (first, 0);
     last = MIN (last, buf->size);
 
+    if (last - first > EDIT_BUF_SIZE && edit_buffer_line_index_prepare (buf))
+        return edit_buffer_line_index_count (buf, last) - edit_buffer_line_index_count (buf, first);
+
     while (first < last)
-        if (edit_buffer_get_byte (buf, first++) == '\n')
-            lines++;
+    {
+        const char *s;
+        off_t len;
+
+        s = edit_buffer_get_span (buf, first, &len);
+        len = MIN (len, last - first);
+        lines += edit_buffer_count_newlines (s, (size_t) len);
+        first += len;
+    }
 
     return lines;
 }
@@ -357,10 +1218,23 @@ edit_buffer_get_bol (const edit_buffer_t * buf, off_t current)
     if (current <= 0)
         return 0;
 
-    for (; edit_buffer_get_byte (buf, current - 1) != '\n'; current--)
-        ;
+    /* byte beyond the end of file is treated as newline */
+    if (current > buf->size)
+        return current;
 
-    return current;
+    while (current > 0)
+    {
+        const char *s, *nl;
+        off_t len;
+
+        s = edit_buffer_get_span_backward (buf, current, &len);
+        nl = edit_buffer_memrchr (s, '\n', (size_t) len);
+        if (nl != NULL)
+            return current - len + (nl - s) + 1;
+        current -= len;
+    }
+
+    return 0;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -379,10 +1253,23 @@ edit_buffer_get_eol (const edit_buffer_t * buf, off_t current)
     if (current >= buf->size)
         return buf->size;
 
-    for (; edit_buffer_get_byte (buf, current) != '\n'; current++)
-        ;
+    /* byte before the beginning of file is treated as newline */
+    if (current < 0)
+        return current;
 
-    return current;
+    while (current < buf->size)
+    {
+        const char *s, *nl;
+        off_t len;
+
+        s = edit_buffer_get_span (buf, current, &len);
+        nl = memchr (s, '\n', (size_t) len);
+        if (nl != NULL)
+            return current + (nl - s);
+        current += len;
+    }
+
+    return buf->size;
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -551,6 +1438,41 @@ edit_buffer_get_word_from_pos (const edit_buffer_t * buf, off_t start_pos, off_t
     return match_expr;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get range of bytes. Bytes are copied by contiguous spans.
+ *
+ * @param buf editor buffer
+ * @param start offset of the first byte
+ * @param finish offset of the byte following the last one
+ *
+ * @return bytes as newly allocated object
+ */
+
+GString *
+edit_buffer_get_range (const edit_buffer_t * buf, off_t start, off_t finish)
+{
+    GString *range;
+
+    start = MAX (start, 0);
+    finish = MIN (finish, buf->size);
+
+    range = g_string_sized_new (start < finish ? (gsize) (finish - start) : 0);
+
+    while (start < finish)
+    {
+        const char *p;
+        off_t len;
+
+        p = edit_buffer_get_span (buf, start, &len);
+        len = MIN (len, finish - start);
+        g_string_append_len (range, p, len);
+        start += len;
+    }
+
+    return range;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Basic low level single character buffer alterations and movements at the cursor: insert character
@@ -570,17 +1492,67 @@ edit_buffer_insert (edit_buffer_t * buf, int c)
 
     /* add a new buffer if we've reached the end of the last one */
     if (i == 0)
-        g_ptr_array_add (buf->b1, g_malloc0 (EDIT_BUF_SIZE));
+    {
+        g_ptr_array_add (buf->b1, edit_buffer_alloc_block ());
+        edit_buffer_line_index_push (buf->lines1, 0);
+    }
 
     /* perform the insertion */
-    b = g_ptr_array_index (buf->b1, buf->curs1 >> S_EDIT_BUF_SIZE);
+    b = edit_buffer_get_block_for_write (buf, buf->b1, buf->curs1 >> S_EDIT_BUF_SIZE);
     *((unsigned char *) b + i) = (unsigned char) c;
 
+    if (c == '\n')
+        edit_buffer_line_index_add (buf->lines1, buf->curs1 >> S_EDIT_BUF_SIZE, 1);
+
     /* update cursor position */
     buf->curs1++;
 
     /* update file length */
     buf->size++;
+    buf->generation++;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Insert string at the cursor position and move right. Blocks are filled by spans.
+ *
+ * @param buf pointer to editor buffer
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ */
+
+void
+edit_buffer_insert_string (edit_buffer_t * buf, const char *text, gsize len)
+{
+    while (len != 0)
+    {
+        void *b;
+        off_t i;
+        gsize n;
+
+        i = buf->curs1 & M_EDIT_BUF_SIZE;
+
+        /* add a new buffer if we've reached the end of the last one */
+        if (i == 0)
+        {
+            g_ptr_array_add (buf->b1, edit_buffer_alloc_block ());
+            edit_buffer_line_index_push (buf->lines1, 0);
+        }
+
+        n = MIN (len, (gsize) (EDIT_BUF_SIZE - i));
+
+        b = edit_buffer_get_block_for_write (buf, buf->b1, buf->curs1 >> S_EDIT_BUF_SIZE);
+        memcpy ((char *) b + i, text, n);
+
+        edit_buffer_line_index_add (buf->lines1, buf->curs1 >> S_EDIT_BUF_SIZE,
+                                    edit_buffer_count_newlines (text, n));
+
+        buf->curs1 += n;
+        buf->size += n;
+        text += n;
+        len -= n;
+        buf->generation++;
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -602,17 +1574,67 @@ edit_buffer_insert_ahead (edit_buffer_t * buf, int c)
 
     /* add a new buffer if we've reached the end of the last one */
     if (i == 0)
-        g_ptr_array_add (buf->b2, g_malloc0 (EDIT_BUF_SIZE));
+    {
+        g_ptr_array_add (buf->b2, edit_buffer_alloc_block ());
+        edit_buffer_line_index_push (buf->lines2, 0);
+    }
 
     /* perform the insertion */
-    b = g_ptr_array_index (buf->b2, buf->curs2 >> S_EDIT_BUF_SIZE);
+    b = edit_buffer_get_block_for_write (buf, buf->b2, buf->curs2 >> S_EDIT_BUF_SIZE);
     *((unsigned char *) b + EDIT_BUF_SIZE - 1 - i) = (unsigned char) c;
 
+    if (c == '\n')
+        edit_buffer_line_index_add (buf->lines2, buf->curs2 >> S_EDIT_BUF_SIZE, 1);
+
     /* update cursor position */
     buf->curs2++;
 
     /* update file length */
     buf->size++;
+    buf->generation++;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Insert string at the cursor position and don't move. Blocks are filled by spans.
+ *
+ * @param buf pointer to editor buffer
+ * @param text string to insert, may contain null bytes
+ * @param len length of string
+ */
+
+void
+edit_buffer_insert_string_ahead (edit_buffer_t * buf, const char *text, gsize len)
+{
+    /* b2 grows towards the beginning of text */
+    while (len != 0)
+    {
+        void *b;
+        off_t i;
+        gsize n;
+
+        i = buf->curs2 & M_EDIT_BUF_SIZE;
+
+        /* add a new buffer if we've reached the end of the last one */
+        if (i == 0)
+        {
+            g_ptr_array_add (buf->b2, edit_buffer_alloc_block ());
+            edit_buffer_line_index_push (buf->lines2, 0);
+        }
+
+        n = MIN (len, (gsize) (EDIT_BUF_SIZE - i));
+        len -= n;
+
+        b = edit_buffer_get_block_for_write (buf, buf->b2, buf->curs2 >> S_EDIT_BUF_SIZE);
+        memcpy ((char *) b + EDIT_BUF_SIZE - i - n, text + len, n);
+
+        edit_buffer_line_index_add (buf->lines2, buf->curs2 >> S_EDIT_BUF_SIZE,
+                                    edit_buffer_count_newlines (text + len, n));
+
+        buf->curs2 += n;
+        buf->size += n;
+        buf->generation++;
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -645,15 +1667,67 @@ edit_buffer_delete (edit_buffer_t * buf)
         j = buf->b2->len - 1;
         b = g_ptr_array_index (buf->b2, j);
         g_ptr_array_remove_index (buf->b2, j);
-        g_free (b);
+        edit_buffer_free_block (buf, b);
+        edit_buffer_line_index_pop (buf->lines2);
     }
+    else if (c == '\n')
+        edit_buffer_line_index_add (buf->lines2, prev >> S_EDIT_BUF_SIZE, -1);
+
+    buf->curs2 = prev;
+
+    /* update file length */
+    buf->size--;
+    buf->generation++;
+
+    return c;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Delete bytes at the cursor position. Blocks are released by spans.
+ *
+ * @param buf pointer to editor buffer
+ * @param len number of bytes to delete
+ */
+
+void
+edit_buffer_delete_bytes (edit_buffer_t * buf, off_t len)
+{
+    len = MIN (len, buf->curs2);
+
+    while (len > 0)
+    {
+        void *b;
+        off_t prev, i, n;
+        guint j;
 
-    buf->curs2 = prev;
+        prev = buf->curs2 - 1;
+        j = prev >> S_EDIT_BUF_SIZE;
+        i = prev & M_EDIT_BUF_SIZE;
 
-    /* update file length */
-    buf->size--;
+        /* bytes of the last block are [i, 0] */
+        n = MIN (len, i + 1);
 
-    return c;
+        if (n == i + 1)
+        {
+            b = g_ptr_array_index (buf->b2, j);
+            g_ptr_array_remove_index (buf->b2, j);
+            edit_buffer_free_block (buf, b);
+            edit_buffer_line_index_pop (buf->lines2);
+        }
+        else
+        {
+            b = g_ptr_array_index (buf->b2, j);
+            edit_buffer_line_index_add (buf->lines2, j,
+                                        -edit_buffer_count_newlines ((char *) b + EDIT_BUF_SIZE -
+                                                                     1 - i, (size_t) n));
+        }
+
+        buf->curs2 -= n;
+        buf->size -= n;
+        len -= n;
+        buf->generation++;
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -686,17 +1760,172 @@ edit_buffer_backspace (edit_buffer_t * buf)
         j = buf->b1->len - 1;
         b = g_ptr_array_index (buf->b1, j);
         g_ptr_array_remove_index (buf->b1, j);
-        g_free (b);
+        edit_buffer_free_block (buf, b);
+        edit_buffer_line_index_pop (buf->lines1);
     }
+    else if (c == '\n')
+        edit_buffer_line_index_add (buf->lines1, prev >> S_EDIT_BUF_SIZE, -1);
 
     buf->curs1 = prev;
 
     /* update file length */
     buf->size--;
+    buf->generation++;
 
     return c;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Move the cursor (i.e. the gap between b1 and b2) by the specified number of bytes.
+ *
+ * Data is relocated by spans limited only by block boundaries, not byte by byte. If both curs1
+ * and curs2 are aligned to the block size, the whole block is just handed over from one array to
+ * another without copying. Blocks released by one array are reused by another one unless they
+ * point into file mapping.
+ * Lines crossed by the cursor are counted per span and curs_line is updated accordingly.
+ *
+ * @param buf pointer to editor buffer
+ * @param increment number of bytes to move: positive to move right, negative to move left
+ *
+ * @return number of bytes the cursor was actually moved (negative if moved left)
+ */
+
+off_t
+edit_buffer_move_gap (edit_buffer_t * buf, off_t increment)
+{
+    off_t moved = 0;
+    void *spare = NULL;
+
+    if (increment > 0)
+    {
+        increment = MIN (increment, buf->curs2);
+
+        /* move data from b2 to b1 */
+        while (moved < increment)
+        {
+            void *b;
+            off_t i1, r2, chunk;
+            char *src;
+            long lines;
+
+            i1 = buf->curs1 & M_EDIT_BUF_SIZE;
+            r2 = ((buf->curs2 - 1) & M_EDIT_BUF_SIZE) + 1;
+            chunk = MIN (increment - moved, MIN (r2, EDIT_BUF_SIZE - i1));
+
+            b = g_ptr_array_index (buf->b2, buf->b2->len - 1);
+            src = (char *) b + EDIT_BUF_SIZE - r2;
+            lines = edit_buffer_count_newlines (src, (size_t) chunk);
+
+            if (i1 == 0 && chunk == EDIT_BUF_SIZE)
+            {
+                /* both sides are aligned: hand over the whole block */
+                g_ptr_array_remove_index (buf->b2, buf->b2->len - 1);
+                g_ptr_array_add (buf->b1, b);
+                edit_buffer_line_index_pop (buf->lines2);
+                edit_buffer_line_index_push (buf->lines1, lines);
+            }
+            else
+            {
+                if (i1 == 0)
+                {
+                    g_ptr_array_add (buf->b1, spare != NULL ? spare : edit_buffer_alloc_block ());
+                    spare = NULL;
+                    edit_buffer_line_index_push (buf->lines1, 0);
+                }
+
+                memcpy ((char *) edit_buffer_get_block_for_write (buf, buf->b1, buf->b1->len - 1) +
+                        i1, src, chunk);
+                edit_buffer_line_index_add (buf->lines1, buf->b1->len - 1, lines);
+
+                /* source block is exhausted */
+                if (chunk == r2)
+                {
+                    g_ptr_array_remove_index (buf->b2, buf->b2->len - 1);
+                    if (spare == NULL && !edit_buffer_block_is_mapped (buf, b))
+                        spare = b;
+                    else
+                        edit_buffer_free_block (buf, b);
+                    edit_buffer_line_index_pop (buf->lines2);
+                }
+                else
+                    edit_buffer_line_index_add (buf->lines2, buf->b2->len - 1, -lines);
+            }
+
+            buf->curs_line += lines;
+            buf->curs1 += chunk;
+            buf->curs2 -= chunk;
+            moved += chunk;
+        }
+    }
+    else if (increment < 0)
+    {
+        increment = MAX (increment, -buf->curs1);
+
+        /* move data from b1 to b2 */
+        while (moved > increment)
+        {
+            void *b;
+            off_t i2, r1, chunk;
+            char *src;
+            long lines;
+
+            i2 = buf->curs2 & M_EDIT_BUF_SIZE;
+            r1 = ((buf->curs1 - 1) & M_EDIT_BUF_SIZE) + 1;
+            chunk = MIN (moved - increment, MIN (r1, EDIT_BUF_SIZE - i2));
+
+            b = g_ptr_array_index (buf->b1, buf->b1->len - 1);
+            src = (char *) b + r1 - chunk;
+            lines = edit_buffer_count_newlines (src, (size_t) chunk);
+
+            if (i2 == 0 && chunk == EDIT_BUF_SIZE)
+            {
+                /* both sides are aligned: hand over the whole block */
+                g_ptr_array_remove_index (buf->b1, buf->b1->len - 1);
+                g_ptr_array_add (buf->b2, b);
+                edit_buffer_line_index_pop (buf->lines1);
+                edit_buffer_line_index_push (buf->lines2, lines);
+            }
+            else
+            {
+                if (i2 == 0)
+                {
+                    g_ptr_array_add (buf->b2, spare != NULL ? spare : edit_buffer_alloc_block ());
+                    spare = NULL;
+                    edit_buffer_line_index_push (buf->lines2, 0);
+                }
+
+                memcpy ((char *) edit_buffer_get_block_for_write (buf, buf->b2, buf->b2->len - 1) +
+                        EDIT_BUF_SIZE - i2 - chunk, src, chunk);
+                edit_buffer_line_index_add (buf->lines2, buf->b2->len - 1, lines);
+
+                /* source block is exhausted */
+                if (chunk == r1)
+                {
+                    g_ptr_array_remove_index (buf->b1, buf->b1->len - 1);
+                    if (spare == NULL && !edit_buffer_block_is_mapped (buf, b))
+                        spare = b;
+                    else
+                        edit_buffer_free_block (buf, b);
+                    edit_buffer_line_index_pop (buf->lines1);
+                }
+                else
+                    edit_buffer_line_index_add (buf->lines1, buf->b1->len - 1, -lines);
+            }
+
+            buf->curs_line -= lines;
+            buf->curs1 -= chunk;
+            buf->curs2 += chunk;
+            moved -= chunk;
+        }
+    }
+
+    if (spare != NULL)
+        edit_buffer_release_block (spare);
+
+    return moved;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Calculate forward offset with specified number of lines.
@@ -719,6 +1948,21 @@ edit_buffer_get_forward_offset (const edit_buffer_t * buf, off_t current, long l
 
     lines = MAX (lines, 0);
 
+    if (lines > LINE_INDEX_MIN_LINES && edit_buffer_line_index_prepare (buf))
+    {
+        long line, total;
+
+        line = edit_buffer_line_index_count (buf, MAX (MIN (current, buf->size), 0));
+        total = edit_buffer_line_index_total (buf->lines1) +
+            edit_buffer_line_index_total (buf->lines2);
+
+        /* current line is the last one */
+        if (line >= total)
+            return current;
+
+        return edit_buffer_line_index_find (buf, MIN (line + lines, total));
+    }
+
     while (lines-- != 0)
     {
         long next;
@@ -747,6 +1991,16 @@ off_t
 edit_buffer_get_backward_offset (const edit_buffer_t * buf, off_t current, long lines)
 {
     lines = MAX (lines, 0);
+
+    if (lines > LINE_INDEX_MIN_LINES && edit_buffer_line_index_prepare (buf))
+    {
+        long line;
+
+        line = edit_buffer_line_index_count (buf, MAX (MIN (current, buf->size), 0)) - lines;
+
+        return line <= 0 ? 0 : edit_buffer_line_index_find (buf, line);
+    }
+
     current = edit_buffer_get_bol (buf, current);
 
     while (lines-- != 0 && current != 0)
@@ -771,7 +2025,7 @@ edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
                        edit_buffer_read_file_status_msg_t * sm, gboolean * aborted)
 {
     off_t ret = 0;
-    off_t i, j;
+    off_t i;
     off_t data_size;
     void *b;
     status_msg_t *s = STATUS_MSG (sm);
@@ -781,21 +2035,25 @@ edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
 
     buf->lines = 0;
     buf->curs2 = size;
+    buf->generation++;
+
+    /* line index will be rebuilt on demand */
+    g_array_set_size (buf->lines1, 0);
+    g_array_set_size (buf->lines2, 0);
     i = buf->curs2 >> S_EDIT_BUF_SIZE;
 
     /* fill last part of b2 */
     data_size = buf->curs2 & M_EDIT_BUF_SIZE;
     if (data_size != 0)
     {
-        b = g_malloc0 (EDIT_BUF_SIZE);
+        b = edit_buffer_alloc_block ();
         g_ptr_array_add (buf->b2, b);
         b = (char *) b + EDIT_BUF_SIZE - data_size;
         ret = mc_read (fd, b, data_size);
 
         /* count lines */
-        for (j = 0; j < ret; j++)
-            if (*((char *) b + j) == '\n')
-                buf->lines++;
+        if (ret > 0)
+            buf->lines += edit_buffer_count_newlines (b, (size_t) ret);
 
         if (ret < 0 || ret != data_size)
             return ret;
@@ -807,16 +2065,15 @@ edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
     {
         off_t sz;
 
-        b = g_malloc0 (data_size);
+        b = edit_buffer_alloc_block ();
         g_ptr_array_add (buf->b2, b);
         sz = mc_read (fd, b, data_size);
         if (sz >= 0)
             ret += sz;
 
         /* count lines */
-        for (j = 0; j < sz; j++)
-            if (*((char *) b + j) == '\n')
-                buf->lines++;
+        if (sz > 0)
+            buf->lines += edit_buffer_count_newlines (b, (size_t) sz);
 
         if (s != NULL && s->update != NULL)
         {
@@ -872,7 +2129,7 @@ edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
 
 /* --------------------------------------------------------------------------------------------- */
 /**
- * Write editor buffer content to file
+ * Write editor buffer content to file. Local file is written by few vectored writes.
  *
  * @param buf pointer to editor buffer
  * @param fd file descriptor
@@ -888,6 +2145,14 @@ edit_buffer_write_file (edit_buffer_t * buf, int fd)
     off_t data_size, sz;
     void *b;
 
+#ifdef HAVE_WRITEV
+    int local_fd;
+
+    local_fd = vfs_get_local_fd (fd);
+    if (local_fd != -1)
+        return edit_buffer_writev (buf, local_fd);
+#endif
+
     /* write all fulfilled parts of b1 from begin to end */
     if (buf->b1->len != 0)
     {
@@ -944,6 +2209,354 @@ edit_buffer_write_file (edit_buffer_t * buf, int fd)
     return ret;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Load file into editor buffer without reading it: map the file into memory and make buffer
+ * blocks point into the mapping. Blocks are copied to the heap only when they are modified.
+ *
+ * Lines of the file are not counted here: until they are counted by
+ * edit_buffer_count_mapped_lines(), every uncounted byte is taken as a line end, so buf->lines
+ * is the upper bound of the number of lines and never prevents the cursor from moving down.
+ *
+ * @param buf pointer to editor buffer
+ * @param fd file descriptor of local file
+ * @param size file size
+ *
+ * @return TRUE if file was mapped, FALSE otherwise
+ */
+
+gboolean
+edit_buffer_map_file (edit_buffer_t * buf, int fd, off_t size)
+{
+#ifdef HAVE_MMAP
+    char *map;
+    off_t i, data_size;
+
+    if (size <= 0 || (off_t) (size_t) size != size)
+        return FALSE;
+
+    map = mmap (0, (size_t) size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+    if (map == (char *) -1)
+        return FALSE;
+
+    buf->map = map;
+    buf->map_size = size;
+    buf->map_counted = 0;
+    edit_buffer_map_register (buf);
+
+    buf->lines = size;
+    buf->curs2 = size;
+    buf->generation++;
+
+    /* line index will be rebuilt on demand */
+    g_array_set_size (buf->lines1, 0);
+    g_array_set_size (buf->lines2, 0);
+
+    /* full parts of b2 from end to begin */
+    for (i = 1; i <= size >> S_EDIT_BUF_SIZE; i++)
+        g_ptr_array_add (buf->b2, map + size - i * EDIT_BUF_SIZE);
+
+    /* last part of b2 is partially filled, so it cannot be mapped */
+    data_size = size & M_EDIT_BUF_SIZE;
+    if (data_size != 0)
+    {
+        void *b;
+
+        b = edit_buffer_alloc_block ();
+        memcpy ((char *) b + EDIT_BUF_SIZE - data_size, map, data_size);
+        g_ptr_array_add (buf->b2, b);
+    }
+
+    return TRUE;
+#else
+    (void) buf;
+    (void) fd;
+    (void) size;
+
+    return FALSE;
+#endif /* HAVE_MMAP */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Count lines in the next part of the file loaded by edit_buffer_map_file().
+ *
+ * Lines are counted in the original file content, while the editor adjusts buf->lines on each
+ * inserted or deleted newline, so the result is correct regardless of edits made in the meantime.
+ *
+ * @param buf pointer to editor buffer
+ * @param count number of bytes to look through
+ *
+ * @return TRUE if there are lines not counted yet, FALSE otherwise
+ */
+
+gboolean
+edit_buffer_count_mapped_lines (edit_buffer_t * buf, off_t count)
+{
+    if (buf->map_counted >= buf->map_size)
+        return FALSE;
+
+    count = MIN (count, buf->map_size - buf->map_counted);
+    buf->lines -= count - edit_buffer_count_newlines (buf->map + buf->map_counted, (size_t) count);
+    buf->map_counted += count;
+
+    return (buf->map_counted < buf->map_size);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether the file the buffer is mapped from was truncated by another process.
+ * Such buffer should be detached from the file by edit_buffer_unmap() as soon as possible.
+ *
+ * @param buf pointer to editor buffer
+ *
+ * @return TRUE if part of the mapping was lost and replaced with null bytes
+ */
+
+gboolean
+edit_buffer_map_truncated (const edit_buffer_t * buf)
+{
+#ifdef HAVE_MMAP
+    GSList *l;
+
+    if (buf->map == NULL)
+        return FALSE;
+
+    l = edit_buffer_map_find (buf);
+    return (l != NULL && ((edit_buffer_mapping_t *) l->data)->truncated != 0);
+#else
+    (void) buf;
+
+    return FALSE;
+#endif /* HAVE_MMAP */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Detach editor buffer from the file it was mapped from: copy all blocks that still point into
+ * the mapping to the heap and unmap the file. Must be called before the file is overwritten
+ * and after the file was truncated by another process (see edit_buffer_map_truncated()).
+ *
+ * @param buf pointer to editor buffer
+ */
+
+void
+edit_buffer_unmap (edit_buffer_t * buf)
+{
+#ifdef HAVE_MMAP
+    guint i;
+    gboolean truncated;
+
+    if (buf->map == NULL)
+        return;
+
+    edit_buffer_count_mapped_lines (buf, buf->map_size);
+
+    for (i = 0; i < buf->b1->len; i++)
+        (void) edit_buffer_get_block_for_write (buf, buf->b1, i);
+    for (i = 0; i < buf->b2->len; i++)
+        (void) edit_buffer_get_block_for_write (buf, buf->b2, i);
+
+    truncated = edit_buffer_map_truncated (buf);
+    edit_buffer_map_release (buf);
+
+    if (truncated)
+    {
+        /* lines counted in the lost part of file aren't there anymore */
+        g_array_set_size (buf->lines1, 0);
+        g_array_set_size (buf->lines2, 0);
+        buf->lines = edit_buffer_count_lines (buf, 0, buf->size);
+        buf->curs_line = edit_buffer_count_lines (buf, 0, buf->curs1);
+        buf->generation++;
+    }
+#else
+    (void) buf;
+#endif /* HAVE_MMAP */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Prepare editor buffer for loading the file in background by edit_buffer_load_part().
+ *
+ * Buffer gets the file size at once. Blocks of the part of file not loaded yet point to the
+ * shared placeholder block consisting of newlines, so the buffer is consistent at any time and
+ * buf->lines is the upper bound of the number of lines, like for mapped file.
+ * Loaded part of file is buf->load_offset bytes at the beginning of buffer. The cursor must not
+ * leave it and buffer must not be modified until the file is loaded.
+ *
+ * @param buf pointer to editor buffer initialized with the file size
+ */
+
+void
+edit_buffer_load_start (edit_buffer_t * buf)
+{
+    off_t i;
+
+    memset (edit_buffer_unloaded_block, '\n', sizeof (edit_buffer_unloaded_block));
+
+    buf->lines = buf->size;
+    buf->curs2 = buf->size;
+
+    /* line index will be rebuilt on demand */
+    g_array_set_size (buf->lines1, 0);
+    g_array_set_size (buf->lines2, 0);
+
+    for (i = 0; i < (buf->size + M_EDIT_BUF_SIZE) >> S_EDIT_BUF_SIZE; i++)
+        g_ptr_array_add (buf->b2, edit_buffer_unloaded_block);
+
+    buf->load_offset = 0;
+    buf->load_size = buf->size;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Append the rest of file to the end of buffer if VFS reported the file size smaller than it is.
+ *
+ * @param buf pointer to editor buffer
+ * @param fd file descriptor
+ *
+ * @return number of appended bytes, -1 on error
+ */
+
+static off_t
+edit_buffer_load_tail (edit_buffer_t * buf, int fd)
+{
+    char b[BUF_8K];
+    off_t curs1, ret = 0;
+    ssize_t sz;
+
+    curs1 = buf->curs1;
+
+    while ((sz = mc_read (fd, b, sizeof (b))) > 0)
+    {
+        ssize_t i;
+        long lines;
+
+        if (ret == 0)
+            edit_buffer_move_gap (buf, buf->size - buf->curs1);
+
+        for (i = 0; i < sz; i++)
+            edit_buffer_insert (buf, b[i]);
+
+        lines = edit_buffer_count_newlines (b, (size_t) sz);
+        buf->lines += lines;
+        buf->curs_line += lines;
+        ret += sz;
+    }
+
+    if (ret != 0)
+        edit_buffer_move_gap (buf, curs1 - buf->curs1);
+
+    return (sz < 0 ? -1 : ret);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Load the next part of file into buffer prepared by edit_buffer_load_start().
+ *
+ * If the file turns out to be shorter than the buffer, the buffer is truncated. If it is longer,
+ * the rest of the file is appended when the buffer is filled.
+ *
+ * @param buf pointer to editor buffer
+ * @param fd file descriptor
+ * @param count number of bytes to read
+ *
+ * @return number of read bytes, -1 on error
+ */
+
+off_t
+edit_buffer_load_part (edit_buffer_t * buf, int fd, off_t count)
+{
+    off_t ret = 0;
+    off_t tail;
+
+    if (!edit_buffer_loading_pending (buf))
+        return 0;
+
+    count = MIN (count, buf->load_size - buf->load_offset);
+
+    while (ret < count)
+    {
+        off_t p, offset, len;
+        ssize_t sz;
+        char *b;
+
+        /* the unloaded part is in b2 always, since the cursor doesn't leave the loaded one */
+        p = buf->size - 1 - buf->load_offset;
+        offset = EDIT_BUF_SIZE - 1 - (p & M_EDIT_BUF_SIZE);
+        len = MIN (count - ret, EDIT_BUF_SIZE - offset);
+
+        b = g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE);
+        if (b == edit_buffer_unloaded_block)
+        {
+            b = memset (edit_buffer_alloc_block (), '\n', EDIT_BUF_SIZE);
+            g_ptr_array_index (buf->b2, p >> S_EDIT_BUF_SIZE) = b;
+        }
+
+        sz = mc_read (fd, b + offset, (size_t) len);
+        if (sz < 0)
+            return (-1);
+
+        if (sz == 0)
+        {
+            /* file is shorter than VFS reported */
+            edit_buffer_load_stop (buf);
+            return ret;
+        }
+
+        buf->lines -= sz - edit_buffer_count_newlines (b + offset, (size_t) sz);
+        buf->load_offset += sz;
+        buf->generation++;
+        ret += sz;
+    }
+
+    if (edit_buffer_loading_pending (buf))
+        return ret;
+
+    buf->load_offset = 0;
+    buf->load_size = 0;
+
+    tail = edit_buffer_load_tail (buf, fd);
+    return (tail < 0 ? -1 : ret + tail);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Stop loading file in background: truncate buffer to the loaded part of file.
+ *
+ * @param buf pointer to editor buffer
+ */
+
+void
+edit_buffer_load_stop (edit_buffer_t * buf)
+{
+    off_t curs1;
+    guint i;
+
+    if (!edit_buffer_loading_pending (buf))
+        return;
+
+    curs1 = buf->curs1;
+
+    /* leave only the unloaded part in b2 and drop it */
+    edit_buffer_move_gap (buf, buf->load_offset - buf->curs1);
+
+    for (i = 0; i < buf->b2->len; i++)
+        edit_buffer_free_block (buf, g_ptr_array_index (buf->b2, i));
+    g_ptr_array_set_size (buf->b2, 0);
+
+    /* every unloaded byte is a newline */
+    buf->lines -= buf->curs2;
+    buf->size -= buf->curs2;
+    buf->curs2 = 0;
+    buf->generation++;
+
+    buf->load_offset = 0;
+    buf->load_size = 0;
+
+    edit_buffer_move_gap (buf, curs1 - buf->curs1);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Calculate percentage of specified character offset
@@ -972,3 +2585,16 @@ edit_buffer_calc_percent (const edit_buffer_t * buf, off_t offset)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Get statistics of blocks shared by all editor buffers.
+ *
+ * @return pointer to statistics
+ */
+
+const edit_buffer_pool_stats_t *
+edit_buffer_get_pool_stats (void)
+{
+    return &edit_buffer_pool_stats;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -20,8 +20,25 @@ typedef struct edit_buffer_struct
     off_t size;                 /* file size */
     long lines;                 /* total lines in the file */
     long curs_line;             /* line number of the cursor. */
+    char *map;                  /* read-only file mapping the unchanged blocks point into */
+    off_t map_size;             /* size of the file mapping */
+    off_t map_counted;          /* number of bytes of the file mapping lines are counted in */
+    GArray *lines1;             /* Fenwick tree of newline counts in b1 blocks, empty if not built */
+    GArray *lines2;             /* Fenwick tree of newline counts in b2 blocks, empty if not built */
+    off_t load_offset;          /* number of bytes of the file loaded in background so far */
+    off_t load_size;            /* size of the file being loaded in background, 0 if none */
+    unsigned long generation;   /* incremented on each change of text */
 } edit_buffer_t;
 
+/* statistics of blocks shared by all buffers */
+typedef struct edit_buffer_pool_stats_struct
+{
+    gsize allocated;            /* number of blocks allocated in the heap */
+    gsize reused;               /* number of blocks taken from the pool instead */
+    gsize freed;                /* number of released blocks returned to the heap */
+    gsize cached;               /* number of released blocks kept in the pool now */
+} edit_buffer_pool_stats_t;
+
 typedef struct edit_buffer_read_file_status_msg_struct
 {
     simple_status_msg_t status_msg;     /* base class */
@@ -39,6 +56,9 @@ void edit_buffer_init (edit_buffer_t * buf, off_t size);
 void edit_buffer_clean (edit_buffer_t * buf);
 
 int edit_buffer_get_byte (const edit_buffer_t * buf, off_t byte_index);
+const char *edit_buffer_get_span (const edit_buffer_t * buf, off_t byte_index, off_t * len);
+const char *edit_buffer_get_span_backward (const edit_buffer_t * buf, off_t byte_index,
+                                           off_t * len);
 #ifdef HAVE_CHARSET
 int edit_buffer_get_utf (const edit_buffer_t * buf, off_t byte_index, int *char_length);
 int edit_buffer_get_prev_utf (const edit_buffer_t * buf, off_t byte_index, int *char_length);
@@ -52,11 +72,16 @@ GString *edit_buffer_get_left_whole_word (const edit_buffer_t * buf, gboolean ju
                                           GString * initial, gboolean release_on_empty);
 GString *edit_buffer_get_word_from_pos (const edit_buffer_t * buf, off_t start_pos, off_t * start,
                                         gsize * cut);
+GString *edit_buffer_get_range (const edit_buffer_t * buf, off_t start, off_t finish);
 
 void edit_buffer_insert (edit_buffer_t * buf, int c);
+void edit_buffer_insert_string (edit_buffer_t * buf, const char *text, gsize len);
 void edit_buffer_insert_ahead (edit_buffer_t * buf, int c);
+void edit_buffer_insert_string_ahead (edit_buffer_t * buf, const char *text, gsize len);
 int edit_buffer_delete (edit_buffer_t * buf);
+void edit_buffer_delete_bytes (edit_buffer_t * buf, off_t len);
 int edit_buffer_backspace (edit_buffer_t * buf);
+off_t edit_buffer_move_gap (edit_buffer_t * buf, off_t increment);
 
 off_t edit_buffer_get_forward_offset (const edit_buffer_t * buf, off_t current, long lines,
                                       off_t upto);
@@ -65,9 +90,18 @@ off_t edit_buffer_get_backward_offset (const edit_buffer_t * buf, off_t current,
 off_t edit_buffer_read_file (edit_buffer_t * buf, int fd, off_t size,
                              edit_buffer_read_file_status_msg_t * sm, gboolean * aborted);
 off_t edit_buffer_write_file (edit_buffer_t * buf, int fd);
+gboolean edit_buffer_map_file (edit_buffer_t * buf, int fd, off_t size);
+gboolean edit_buffer_count_mapped_lines (edit_buffer_t * buf, off_t count);
+gboolean edit_buffer_map_truncated (const edit_buffer_t * buf);
+void edit_buffer_unmap (edit_buffer_t * buf);
+void edit_buffer_load_start (edit_buffer_t * buf);
+off_t edit_buffer_load_part (edit_buffer_t * buf, int fd, off_t count);
+void edit_buffer_load_stop (edit_buffer_t * buf);
 
 int edit_buffer_calc_percent (const edit_buffer_t * buf, off_t offset);
 
+const edit_buffer_pool_stats_t *edit_buffer_get_pool_stats (void);
+
 /*** inline functions ****************************************************************************/
 
 static inline int
@@ -84,6 +118,36 @@ edit_buffer_get_previous_byte (const edit_buffer_t * buf)
     return edit_buffer_get_byte (buf, buf->curs1 - 1);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether the file is still being loaded in background
+ *
+ * @param buf editor buffer
+ *
+ * @return TRUE if only first buf->load_offset bytes of buffer are loaded, FALSE otherwise
+ */
+
+static inline gboolean
+edit_buffer_loading_pending (const edit_buffer_t * buf)
+{
+    return (buf->load_offset < buf->load_size);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether lines of the mapped file are still being counted or the file is still being loaded
+ *
+ * @param buf editor buffer
+ *
+ * @return TRUE if buf->lines is an estimation yet, FALSE if it is exact
+ */
+
+static inline gboolean
+edit_buffer_lines_pending (const edit_buffer_t * buf)
+{
+    return (buf->map_counted < buf->map_size || edit_buffer_loading_pending (buf));
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Get "begin-of-line" offset of current line
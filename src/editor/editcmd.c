@@ -73,6 +73,7 @@
 #include "edit-impl.h"
 #include "editwidget.h"
 #include "editcmd_dialogs.h"
+#include "editsort.h"
 #ifdef HAVE_ASPELL
 #include "spell.h"
 #include "spell_dialogs.h"
@@ -96,6 +97,9 @@ gboolean option_drop_selection_on_copy = TRUE;
 
 #define TEMP_BUF_LEN 1024
 
+/* number of bytes to check spelling in per step while looking for a misspelled word */
+#define SPELL_CHECK_CHUNK (64 * 1024)
+
 /*** file scope type declarations ****************************************************************/
 
 typedef struct
@@ -260,6 +264,17 @@ edit_save_file (WEdit * edit, const vfs_path_t * filename_vpath)
         }
     }
 
+    /* Quick save truncates the file, which can be the one the buffer is mapped from.
+       Save via temporary file if possible, otherwise get rid of the mapping. */
+    if (this_save_mode == EDIT_QUICK_SAVE && edit->buffer.map != NULL
+        && vfs_file_is_local (real_filename_vpath) && mc_stat (real_filename_vpath, &sb) == 0)
+    {
+        if (sb.st_nlink <= 1)
+            this_save_mode = EDIT_SAFE_SAVE;
+        else
+            edit_buffer_unmap (&edit->buffer);
+    }
+
     if (this_save_mode == EDIT_QUICK_SAVE)
         savename_vpath = vfs_path_clone (real_filename_vpath);
     else
@@ -332,6 +347,10 @@ edit_save_file (WEdit * edit, const vfs_path_t * filename_vpath)
     }
     else if (edit->lb == LB_ASIS)
     {                           /* do not change line breaks */
+        /* allocate disk space at once, to write large file faster and less fragmented */
+        if (mc_global.vfs.preallocate_space)
+            (void) vfs_preallocate (fd, edit->buffer.size, 0);
+
         filelen = edit_buffer_write_file (&edit->buffer, fd);
 
         if (filelen != edit->buffer.size)
@@ -340,6 +359,13 @@ edit_save_file (WEdit * edit, const vfs_path_t * filename_vpath)
             goto error_save;
         }
 
+        /* file replaces the original one by rename: make sure its data are on disk before */
+        if (this_save_mode != EDIT_QUICK_SAVE && vfs_fdatasync (fd) != 0)
+        {
+            mc_close (fd);
+            goto error_save;
+        }
+
         if (mc_close (fd) != 0)
             goto error_save;
 
@@ -579,8 +605,8 @@ edit_block_delete (WEdit * edit)
         edit_mark_cmd (edit, FALSE);
 
     /* Warning message with a query to continue or cancel the operation */
-    if ((end_mark - start_mark) > option_max_undo / 2 &&
-        edit_query_dialog2 (_("Warning"),
+    if (edit->undo.limit != 0 && (uintmax_t) (end_mark - start_mark) > edit->undo.limit / 2
+        && edit_query_dialog2 (_("Warning"),
                             ("Block is large, you may not be able to undo this action"),
                             _("C&ontinue"), _("&Cancel")) != 0)
         return 1;
@@ -618,12 +644,7 @@ edit_block_delete (WEdit * edit)
                 edit->over_col = curs_pos - line_width;
         }
         else
-        {
-            off_t count;
-
-            for (count = start_mark; count < end_mark; count++)
-                edit_delete (edit, TRUE);
-        }
+            edit_delete_range (edit, start_mark, end_mark);
     }
 
     edit_set_markers (edit, 0, 0, 0, 0);
@@ -938,6 +959,105 @@ edit_show_search_error (const WEdit * edit, const char *title)
         edit_query_dialog (title, edit->search->error_str);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Copy range of text of editor to the end of other buffer.
+ */
+
+static void
+edit_replace_all_copy (const WEdit * edit, edit_buffer_t * buf, off_t start, off_t finish)
+{
+    while (start < finish)
+    {
+        const char *p;
+        off_t len;
+
+        p = edit_buffer_get_span (&edit->buffer, start, &len);
+        len = MIN (len, finish - start);
+        edit_buffer_insert_string (buf, p, (gsize) len);
+        start += len;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Replace the found string and all following ones in one pass. The text with replacements is
+ * written to a new buffer which then replaces the text of editor at once.
+ *
+ * @param esm search status
+ * @param replace replacement string
+ * @param len length of the string found at edit->search_start
+ *
+ * @return number of replacements
+ */
+
+static long
+edit_replace_all (edit_search_status_msg_t * esm, GString * replace, gsize len)
+{
+    WEdit *edit = esm->edit;
+    edit_buffer_t buf;
+    GArray *changes;
+    off_t copied = 0;
+    long times_replaced;
+
+    edit_buffer_init (&buf, 0);
+    changes = g_array_new (FALSE, FALSE, sizeof (edit_change_t));
+
+    while (TRUE)
+    {
+        GString *repl_str;
+        edit_change_t c;
+
+        repl_str = mc_search_prepare_replace_str (edit->search, replace);
+
+        if (edit->search->error != MC_SEARCH_E_OK)
+        {
+            edit_show_search_error (edit, _("Replace"));
+            if (repl_str != NULL)
+                g_string_free (repl_str, TRUE);
+            break;
+        }
+
+        c.offset = edit->search->normal_offset;
+        c.deleted = (off_t) len;
+        c.inserted = (off_t) repl_str->len;
+        g_array_append_val (changes, c);
+
+        edit_replace_all_copy (edit, &buf, copied, c.offset);
+        edit_buffer_insert_string (&buf, repl_str->str, repl_str->len);
+        g_string_free (repl_str, TRUE);
+        copied = c.offset + c.deleted;
+
+        /* so that we don't find the same string again */
+        edit->search_start = copied + (len == 0 ? 1 : 0);
+        if (edit->search_start >= edit->buffer.size)
+            break;
+
+        if (!editcmd_find (esm, &len))
+        {
+            if (edit->search->error != MC_SEARCH_E_NOTFOUND)
+                edit_show_search_error (edit, _("Search"));
+            break;
+        }
+    }
+
+    edit_replace_all_copy (edit, &buf, copied, edit->buffer.size);
+
+    times_replaced = (long) changes->len;
+    edit->found_len =
+        changes->len == 0 ? 0 : g_array_index (changes, edit_change_t, changes->len - 1).inserted;
+
+    /* buf is taken over by editor */
+    edit_replace_buffer (edit, &buf, changes);
+    g_array_free (changes, TRUE);
+
+    /* the cursor is after the last new text */
+    edit->found_start = edit->buffer.curs1 - (off_t) edit->found_len;
+    edit->search_start = edit->buffer.curs1;
+
+    return times_replaced;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static void
@@ -1067,8 +1187,17 @@ edit_get_block (WEdit * edit, off_t start, off_t finish, off_t * l)
     {
         *l = finish - start;
 
-        for (; start < finish; start++)
-            *s++ = edit_buffer_get_byte (&edit->buffer, start);
+        while (start < finish)
+        {
+            const char *p;
+            off_t len;
+
+            p = edit_buffer_get_span (&edit->buffer, start, &len);
+            len = MIN (len, finish - start);
+            memcpy (s, p, (size_t) len);
+            s += len;
+            start += len;
+        }
     }
 
     *s = '\0';
@@ -1282,6 +1411,107 @@ edit_collect_completion_from_one_buffer (gboolean active_buffer, GQueue ** compl
         g_string_free (temp, TRUE);
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+static gint
+edit_completion_string_cmp (gconstpointer a, gconstpointer b)
+{
+    return g_string_equal ((const GString *) a, (const GString *) b) ? 0 : 1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Order words found in indexes by number of occurrences, the most frequent first.
+ */
+
+static gint
+edit_completion_count_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    GHashTable *found = (GHashTable *) user_data;
+    guint count_a, count_b;
+
+    count_a = GPOINTER_TO_UINT (g_hash_table_lookup (found, a));
+    count_b = GPOINTER_TO_UINT (g_hash_table_lookup (found, b));
+
+    if (count_a != count_b)
+        return count_a > count_b ? -1 : 1;
+
+    return strcmp ((const char *) a, (const char *) b);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * collect the possible completions from words found in indexes of buffers
+ */
+
+static void
+edit_collect_completion_from_index (gboolean active_buffer, GQueue ** compl, GHashTable * found,
+                                    const GString * current_word, int *max_width)
+{
+    GList *words, *w;
+
+    words = g_list_sort_with_data (g_hash_table_get_keys (found), edit_completion_count_cmp,
+                                   found);
+    /* the most frequent completion must be shown first, that is, be the nearest to the tail
+       of completions of main buffer and to the head of the rest ones */
+    if (active_buffer)
+        words = g_list_reverse (words);
+
+    for (w = words; w != NULL; w = g_list_next (w))
+    {
+        GString *temp;
+        int width;
+
+        if (current_word != NULL && strcmp (current_word->str, (const char *) w->data) == 0)
+            continue;
+
+        temp = g_string_new ((const char *) w->data);
+#ifdef HAVE_CHARSET
+        {
+            GString *recoded;
+
+            recoded = str_convert_to_display (temp->str);
+            if (recoded->len != 0)
+                mc_g_string_copy (temp, recoded);
+
+            g_string_free (recoded, TRUE);
+        }
+#endif
+
+        if (*compl == NULL)
+            *compl = g_queue_new ();
+        else
+        {
+            GList *l;
+
+            l = g_queue_find_custom (*compl, temp, edit_completion_string_cmp);
+            if (l != NULL)
+            {
+                /* completions found in main buffer must be at the top of list */
+                if (!active_buffer && l != g_queue_peek_tail_link (*compl))
+                {
+                    g_queue_unlink (*compl, l);
+                    g_queue_push_tail_link (*compl, l);
+                }
+
+                g_string_free (temp, TRUE);
+                continue;
+            }
+        }
+
+        if (active_buffer)
+            g_queue_push_tail (*compl, temp);
+        else
+            g_queue_push_head (*compl, temp);
+
+        /* note the maximal length needed for the completion dialog */
+        width = str_term_width1 (temp->str);
+        *max_width = MAX (*max_width, width);
+    }
+
+    g_list_free (words);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * collect the possible completions from all buffers
@@ -1294,7 +1524,8 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
     GQueue *compl = NULL;
     mc_search_t *srch;
     off_t last_byte;
-    GString *current_word;
+    GString *current_word, *prefix;
+    GHashTable *found;
     gboolean entire_file, all_files;
     edit_search_status_msg_t esm;
 
@@ -1315,6 +1546,7 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
     srch->search_type = MC_SEARCH_T_REGEX;
     srch->is_case_sensitive = TRUE;
     srch->search_fn = edit_search_cmd_callback;
+    srch->span_fn = edit_search_span_callback;
     srch->update_fn = edit_search_update_callback;
 
     esm.first = TRUE;
@@ -1325,12 +1557,25 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
                      edit_search_status_update_cb, NULL);
 
     current_word = edit_collect_completions_get_current_word (&esm, srch, word_start);
+    prefix = edit_buffer_get_range (&edit->buffer, word_start, word_start + (off_t) word_len);
+    found = g_hash_table_new (g_str_hash, g_str_equal);
 
     *max_width = 0;
 
     /* collect completions from current buffer at first */
-    edit_collect_completion_from_one_buffer (TRUE, &compl, srch, &esm, word_start, word_len,
-                                             last_byte, current_word, max_width);
+    if (entire_file)
+    {
+        edit_words_build (&edit->words, &edit->buffer);
+        edit_words_collect (&edit->words, prefix->str, prefix->len, found);
+        edit_collect_completion_from_index (TRUE, &compl, found, current_word, max_width);
+        g_hash_table_remove_all (found);
+    }
+    else
+    {
+        /* only words preceding the current one are wanted, the index doesn't know positions */
+        edit_collect_completion_from_one_buffer (TRUE, &compl, srch, &esm, word_start, word_len,
+                                                 last_byte, current_word, max_width);
+    }
 
     /* collect completions from other buffers */
     all_files =
@@ -1339,13 +1584,9 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
     if (all_files)
     {
         const WGroup *owner = CONST_GROUP (CONST_WIDGET (edit)->owner);
-        gboolean saved_verbose;
         GList *w;
 
-        /* don't show incorrect percentage in edit_search_status_update_cb() */
-        saved_verbose = verbose;
-        verbose = FALSE;
-
+        /* merge words of all buffers */
         for (w = owner->widgets; w != NULL; w = g_list_next (w))
         {
             Widget *ww = WIDGET (w->data);
@@ -1359,27 +1600,40 @@ edit_collect_completions (WEdit * edit, off_t word_start, gsize word_len,
             if (e == edit)
                 continue;
 
-            /* search in entire file */
-            word_start = 0;
-            last_byte = e->buffer.size;
-            esm.edit = e;
-            esm.offset = 0;
-
-            edit_collect_completion_from_one_buffer (FALSE, &compl, srch, &esm, word_start,
-                                                     word_len, last_byte, current_word, max_width);
+            edit_words_build (&e->words, &e->buffer);
+            edit_words_collect (&e->words, prefix->str, prefix->len, found);
         }
 
-        verbose = saved_verbose;
+        edit_collect_completion_from_index (FALSE, &compl, found, current_word, max_width);
     }
 
     status_msg_deinit (STATUS_MSG (&esm));
     mc_search_free (srch);
+    g_hash_table_destroy (found);
+    g_string_free (prefix, TRUE);
     if (current_word != NULL)
         g_string_free (current_word, TRUE);
 
     return compl;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Insert spaces at the cursor to fill the width of columns.
+ */
+
+static void
+edit_insert_spaces (WEdit * edit, long width)
+{
+    GString *spaces;
+
+    spaces = g_string_new (NULL);
+    for (; width > 0; width -= space_width)
+        g_string_append_c (spaces, ' ');
+    edit_insert_string (edit, spaces->str, spaces->len);
+    g_string_free (spaces, TRUE);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static void
@@ -1394,18 +1648,22 @@ edit_insert_column_of_text (WEdit * edit, unsigned char *data, off_t size, long
 
     for (i = 0; i < size; i++)
     {
-        if (data[i] != '\n')
-            edit_insert (edit, data[i]);
-        else
+        const unsigned char *nl;
+        off_t len;
+
+        /* insert the rest of row at once */
+        nl = memchr (data + i, '\n', size - i);
+        len = (nl == NULL ? size : nl - data) - i;
+        edit_insert_string (edit, (const char *) data + i, (gsize) len);
+        i += len;
+
+        if (i < size)
         {                       /* fill in and move to next line */
-            long l;
             off_t p;
 
             if (edit_buffer_get_current_byte (&edit->buffer) != '\n')
-            {
-                for (l = width - (edit_get_col (edit) - col); l > 0; l -= space_width)
-                    edit_insert (edit, ' ');
-            }
+                edit_insert_spaces (edit, width - (edit_get_col (edit) - col));
+
             for (p = edit->buffer.curs1;; p++)
             {
                 if (p == edit->buffer.size)
@@ -1423,8 +1681,8 @@ edit_insert_column_of_text (WEdit * edit, unsigned char *data, off_t size, long
             }
             edit_cursor_move (edit, edit_move_forward3 (edit, p, col, 0) - edit->buffer.curs1);
 
-            for (l = col - edit_get_col (edit); l >= space_width; l -= space_width)
-                edit_insert (edit, ' ');
+            /* whole spaces only */
+            edit_insert_spaces (edit, col - edit_get_col (edit) - space_width + 1);
         }
     }
 
@@ -1519,6 +1777,32 @@ edit_delete_macro (WEdit * edit, int hotkey)
     return TRUE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+#ifdef HAVE_CHARSET
+/**
+ * Callback for the iteration of objects in the 'editors' array.
+ * Forget columns of long lines counted in the old codepage.
+ *
+ * @param data      probably WEdit object
+ * @param user_data unused
+ */
+
+static void
+edit_reset_columns_cb (void *data, void *user_data)
+{
+    (void) user_data;
+
+    if (edit_widget_is_editor (CONST_WIDGET (data)))
+    {
+        WEdit *edit = (WEdit *) data;
+
+        edit_columns_reset (edit->columns);
+        edit->force |= REDRAW_PAGE;
+    }
+}
+#endif /* HAVE_CHARSET */
+
 /* --------------------------------------------------------------------------------------------- */
 /**
  * Callback for the iteration of objects in the 'editors' array.
@@ -1569,6 +1853,60 @@ edit_complete_word_insert_recoded_completion (WEdit * edit, char *completion, gs
 #endif
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+#ifdef HAVE_ASPELL
+/**
+ * Check word of text in the dictionary.
+ *
+ * @param word word in the source codepage
+ * @param len word length in bytes
+ * @return FALSE if word is not in the dictionary
+ */
+
+static gboolean
+edit_spellcheck_word (const char *word, gsize len)
+{
+#ifdef HAVE_CHARSET
+    if (mc_global.source_codepage >= 0 && mc_global.source_codepage != mc_global.display_codepage)
+    {
+        GString *tmp_word;
+        gboolean ret;
+
+        tmp_word = str_convert_to_display (word);
+        ret = aspell_check (tmp_word->str, (int) tmp_word->len);
+        g_string_free (tmp_word, TRUE);
+        return ret;
+    }
+#endif
+
+    return aspell_check (word, (int) len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Callback for the iteration of objects in the 'editors' array.
+ * Forget misspelled words found with the old dictionary.
+ *
+ * @param data      probably WEdit object
+ * @param user_data unused
+ */
+
+static void
+edit_spell_reset_cb (void *data, void *user_data)
+{
+    (void) user_data;
+
+    if (edit_widget_is_editor (CONST_WIDGET (data)))
+    {
+        WEdit *edit = (WEdit *) data;
+
+        edit_spell_reset (&edit->spell);
+        edit->force |= REDRAW_PAGE;
+    }
+}
+#endif /* HAVE_ASPELL */
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -2388,39 +2726,40 @@ edit_block_copy_cmd (WEdit * edit)
     off_t start_mark, end_mark, current = edit->buffer.curs1;
     off_t mark1 = 0, mark2 = 0;
     long c1 = 0, c2 = 0;
-    off_t size;
-    unsigned char *copy_buf;
 
     edit_update_curs_col (edit);
     if (!eval_marks (edit, &start_mark, &end_mark))
         return;
 
-    copy_buf = edit_get_block (edit, start_mark, end_mark, &size);
-
     /* all that gets pushed are deletes hence little space is used on the stack */
 
     edit_push_markers (edit);
 
     if (edit->column_highlight)
     {
+        unsigned char *copy_buf;
+        off_t size;
         long col_delta;
 
+        copy_buf = edit_get_block (edit, start_mark, end_mark, &size);
         col_delta = labs (edit->column2 - edit->column1);
         edit_insert_column_of_text (edit, copy_buf, size, col_delta, &mark1, &mark2, &c1, &c2);
+        g_free (copy_buf);
     }
     else
     {
-        int size_orig = size;
+        GString *copy_buf;
 
-        while (size-- != 0)
-            edit_insert_ahead (edit, copy_buf[size]);
+        copy_buf = edit_buffer_get_range (&edit->buffer, start_mark, end_mark);
+        edit_insert_string_ahead (edit, copy_buf->str, copy_buf->len);
 
         /* Place cursor at the end of text selection */
         if (option_cursor_after_inserted_block)
-            edit_cursor_move (edit, size_orig);
+            edit_cursor_move (edit, (off_t) copy_buf->len);
+
+        g_string_free (copy_buf, TRUE);
     }
 
-    g_free (copy_buf);
     edit_scroll_screen_over_cursor (edit);
 
     if (edit->column_highlight)
@@ -2501,31 +2840,27 @@ edit_block_move_cmd (WEdit * edit)
     }
     else
     {
-        off_t count, count_orig;
+        GString *block;
 
         current = edit->buffer.curs1;
-        copy_buf = g_malloc0 (end_mark - start_mark);
-        edit_cursor_move (edit, start_mark - edit->buffer.curs1);
+        block = edit_buffer_get_range (&edit->buffer, start_mark, end_mark);
+        edit_delete_range (edit, start_mark, end_mark);
         edit_scroll_screen_over_cursor (edit);
 
-        for (count = start_mark; count < end_mark; count++)
-            copy_buf[end_mark - count - 1] = edit_delete (edit, TRUE);
-
-        edit_scroll_screen_over_cursor (edit);
         edit_cursor_move (edit,
                           current - edit->buffer.curs1 -
                           (((current - edit->buffer.curs1) > 0) ? end_mark - start_mark : 0));
         edit_scroll_screen_over_cursor (edit);
-        count_orig = count;
-        while (count-- > start_mark)
-            edit_insert_ahead (edit, copy_buf[end_mark - count - 1]);
+        edit_insert_string_ahead (edit, block->str, block->len);
 
         edit_set_markers (edit, edit->buffer.curs1, edit->buffer.curs1 + end_mark - start_mark, 0,
                           0);
 
         /* Place cursor at the end of text selection */
         if (option_cursor_after_inserted_block)
-            edit_cursor_move (edit, count_orig - start_mark);
+            edit_cursor_move (edit, end_mark - start_mark);
+
+        g_string_free (block, TRUE);
     }
 
     edit_scroll_screen_over_cursor (edit);
@@ -2641,6 +2976,7 @@ edit_replace_cmd (WEdit * edit, gboolean again)
         edit->search->is_case_sensitive = edit_search_options.case_sens;
         edit->search->whole_words = edit_search_options.whole_words;
         edit->search->search_fn = edit_search_cmd_callback;
+        edit->search->span_fn = edit_search_span_callback;
         edit->search->update_fn = edit_search_update_callback;
         edit->search_line_type = edit_get_search_line_type (edit->search);
         edit_search_fix_search_start_if_selection (edit);
@@ -2730,6 +3066,15 @@ edit_replace_cmd (WEdit * edit, gboolean again)
                 }
             }
 
+            /* replace the rest in one pass unless it is searched backwards or the file is
+               not loaded yet */
+            if (edit->replace_mode == 1 && !edit_search_options.backwards
+                && !edit_buffer_loading_pending (&edit->buffer))
+            {
+                times_replaced += edit_replace_all (&esm, input2_str, len);
+                break;
+            }
+
             repl_str = mc_search_prepare_replace_str (edit->search, input2_str);
 
             if (edit->search->error != MC_SEARCH_E_OK)
@@ -2809,6 +3154,21 @@ edit_search_cmd_callback (const void *user_data, gsize char_offset, int *current
 
 /* --------------------------------------------------------------------------------------------- */
 
+const char *
+edit_search_span_callback (const void *user_data, gsize char_offset, gsize * len)
+{
+    WEdit *edit = ((const edit_search_status_msg_t *) user_data)->edit;
+    const char *span;
+    off_t span_len;
+
+    span = edit_buffer_get_span (&edit->buffer, (off_t) char_offset, &span_len);
+    *len = (gsize) span_len;
+
+    return span;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 mc_search_cbret_t
 edit_search_update_callback (const void *user_data, gsize char_offset)
 {
@@ -2864,6 +3224,7 @@ edit_search_cmd (WEdit * edit, gboolean again)
                 edit->search->is_case_sensitive = edit_search_options.case_sens;
                 edit->search->whole_words = edit_search_options.whole_words;
                 edit->search->search_fn = edit_search_cmd_callback;
+                edit->search->span_fn = edit_search_span_callback;
                 edit->search->update_fn = edit_search_update_callback;
                 edit->search_line_type = edit_get_search_line_type (edit->search);
                 edit_do_search (edit);
@@ -3206,10 +3567,6 @@ edit_sort_cmd (WEdit * edit)
         return 0;
     }
 
-    tmp = mc_config_get_full_path (EDIT_HOME_BLOCK_FILE);
-    edit_save_block (edit, tmp, start_mark, end_mark);
-    g_free (tmp);
-
     exp = input_dialog (_("Run sort"),
                         _("Enter sort options (see manpage) separated by whitespace:"),
                         MC_HISTORY_EDIT_SORT, INPUT_LAST_TEXT, INPUT_COMPLETE_NONE);
@@ -3217,6 +3574,39 @@ edit_sort_cmd (WEdit * edit)
     if (exp == NULL)
         return 1;
 
+    /* sort lines in memory if options allow it, otherwise run sort(1) */
+    if (!edit->column_highlight)
+    {
+        GString *block, *sorted;
+
+        block = edit_buffer_get_range (&edit->buffer, start_mark, end_mark);
+        sorted = edit_sort_text (block->str, block->len, exp);
+        g_string_free (block, TRUE);
+
+        if (sorted != NULL)
+        {
+            g_free (exp);
+
+            edit->force |= REDRAW_COMPLETELY;
+            edit_replace_range (edit, start_mark, end_mark, sorted->str, sorted->len);
+            g_string_free (sorted, TRUE);
+
+            /* highlight inserted text then not persistent blocks */
+            if (!option_persistent_selections)
+                edit_set_markers (edit, edit->buffer.curs1, start_mark, 0, 0);
+
+            /* Place cursor at the end of text selection */
+            if (!option_cursor_after_inserted_block)
+                edit_cursor_move (edit, start_mark - edit->buffer.curs1);
+
+            return 0;
+        }
+    }
+
+    tmp = mc_config_get_full_path (EDIT_HOME_BLOCK_FILE);
+    edit_save_block (edit, tmp, start_mark, end_mark);
+    g_free (tmp);
+
     tmp_edit_block_name = mc_config_get_full_path (EDIT_HOME_BLOCK_FILE);
     tmp_edit_temp_name = mc_config_get_full_path (EDIT_HOME_TEMP_FILE);
     tmp =
@@ -3446,7 +3836,11 @@ void
 edit_select_codepage_cmd (WEdit * edit)
 {
     if (do_select_codepage ())
+    {
         edit_set_codeset (edit);
+        /* the codepage is shared by all editors */
+        g_list_foreach (GROUP (WIDGET (edit)->owner)->widgets, edit_reset_columns_cb, NULL);
+    }
 
     edit->force = REDRAW_PAGE;
     widget_draw (WIDGET (edit));
@@ -3762,8 +4156,9 @@ edit_suggest_current_word (WEdit * edit)
                     edit_insert (edit, *new_word);
                 g_free (cp_word);
             }
-            else if (retval == B_ADD_WORD)
-                aspell_add_to_dict (match_word->str, (int) word_len);
+            else if (retval == B_ADD_WORD && aspell_add_to_dict (match_word->str, (int) word_len))
+                /* other occurrences of the word aren't misspelled anymore in all editors */
+                g_list_foreach (GROUP (WIDGET (edit)->owner)->widgets, edit_spell_reset_cb, NULL);
         }
 
         for (i = 0; i < suggest->len; i++)
@@ -3795,30 +4190,92 @@ edit_spellcheck_file (WEdit * edit)
         edit_update_curs_row (edit);
     }
 
-    do
-    {
-        int c1, c2;
+    if (!aspell_ready ())
+        return;
 
-        c2 = edit_buffer_get_current_byte (&edit->buffer);
+    while (TRUE)
+    {
+        off_t start = 0, finish = 0;
+        gboolean found;
+        unsigned long generation;
 
-        do
+        /* check text up to the next misspelled word unless it's checked in background */
+        while (TRUE)
         {
-            if (edit->buffer.curs1 >= edit->buffer.size)
-                return;
-
-            c1 = c2;
-            edit_cursor_move (edit, 1);
-            c2 = edit_buffer_get_current_byte (&edit->buffer);
+            found = edit_spell_get_word (&edit->spell, edit->buffer.curs1, &start, &finish);
+            if (edit_spell_is_checked (&edit->spell, edit->buffer.curs1,
+                                       found ? finish : edit->buffer.size))
+                break;
+            edit_spell_scan (&edit->spell, &edit->buffer, SPELL_CHECK_CHUNK,
+                             edit_spellcheck_word);
         }
-        while (is_break_char (c1) || is_break_char (c2));
+
+        if (!found)
+            return;
+
+        edit_cursor_move (edit, MAX (start, edit->buffer.curs1) - edit->buffer.curs1);
+        generation = edit->buffer.generation;
+
+        if (edit_suggest_current_word (edit) == B_CANCEL)
+            return;
+
+        /* skip the word left as is */
+        if (edit->buffer.generation == generation && edit->buffer.curs1 < finish)
+            edit_cursor_move (edit, finish - edit->buffer.curs1);
     }
-    while (edit_suggest_current_word (edit) != B_CANCEL);
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Check if there is text to check spelling in when the editor is idle.
+ *
+ * @param edit editor object
+ * @return TRUE if misspelled words are to be searched
+ */
+
+gboolean
+edit_spellcheck_prescan_pending (const WEdit * edit)
+{
+    return (option_spell_on_the_fly && aspell_ready ()
+            && !edit_buffer_loading_pending (&edit->buffer)
+            && edit_spell_pending (&edit->spell, &edit->buffer));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check spelling of the next part of text to highlight misspelled words. Changed text is checked
+ * first. Words are looked up in the dictionary once, repeated words are found in the cache.
+ *
+ * @param edit editor object
+ * @param len number of bytes to check
+ * @return TRUE if there is more text to check
+ */
+
+gboolean
+edit_spellcheck_prescan (WEdit * edit, off_t len)
+{
+    unsigned long generation = edit->spell.generation;
+
+    if (!edit_spellcheck_prescan_pending (edit))
+        return FALSE;
+
+    edit_spell_scan (&edit->spell, &edit->buffer, len, edit_spellcheck_word);
+    if (edit->spell.generation != generation)
+        edit->force |= REDRAW_PAGE;
+
+    return edit_spellcheck_prescan_pending (edit);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+ * Select the language of dictionary and check spelling in all editors again.
+ *
+ * @param edit editor object
+ */
 
 void
-edit_set_spell_lang (void)
+edit_set_spell_lang (WEdit * edit)
 {
     GArray *lang_list;
 
@@ -3830,7 +4287,9 @@ edit_set_spell_lang (void)
         lang = spell_dialog_lang_list_show (lang_list);
         if (lang != NULL)
         {
-            (void) aspell_set_lang (lang);
+            if (aspell_set_lang (lang))
+                g_list_foreach (GROUP (WIDGET (edit)->owner)->widgets, edit_spell_reset_cb,
+                                NULL);
             g_free (lang);
         }
     }
@@ -0,0 +1,287 @@
+/*
+   Index of columns of long lines of editor buffer.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: index of columns of long lines of editor buffer.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include "lib/global.h"
+
+#include "editcolumn.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * edit_move_forward3() computes columns walking from the start of line. In a line of several
+ * megabytes every move of cursor would walk through the whole line, so while walking it saves
+ * checkpoints: the offset and the column at it, every EDIT_COLUMN_STEP bytes. The next walk
+ * from the same start is resumed from the nearest checkpoint.
+ *
+ * Checkpoints are put only before ASCII bytes, which are never inside a multibyte character,
+ * so the column at a checkpoint doesn't depend on the text after it, and columns of checkpoints
+ * grow with their offsets.
+ *
+ * Checkpoints of a few lines are kept, short lines never get them. A change of text removes
+ * checkpoints at and after the change in the line and moves the lines after the change.
+ * Columns depend also on the tab spacing and the codepage, so a change of these settings
+ * removes all checkpoints.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/* number of lines with checkpoints */
+#define COLUMN_LINES 4
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    off_t offset;
+    long col;
+} edit_column_point_t;
+
+typedef struct
+{
+    off_t start;                /* offset the columns are counted from */
+    GArray *points;             /* checkpoints sorted by offset */
+} edit_column_line_t;
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_column_line_free (gpointer data)
+{
+    edit_column_line_t *line = (edit_column_line_t *) data;
+
+    g_array_free (line->points, TRUE);
+    g_free (line);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_column_line_t *
+edit_columns_find_line (const edit_columns_t * columns, off_t start)
+{
+    guint i;
+
+    for (i = 0; i < columns->lines->len; i++)
+    {
+        edit_column_line_t *line;
+
+        line = (edit_column_line_t *) g_ptr_array_index (columns->lines, i);
+        if (line->start == start)
+            return line;
+    }
+
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_columns_init (edit_columns_t * columns)
+{
+    columns->lines = g_ptr_array_new_with_free_func (edit_column_line_free);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_columns_clean (edit_columns_t * columns)
+{
+    if (columns->lines != NULL)
+    {
+        g_ptr_array_free (columns->lines, TRUE);
+        columns->lines = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove all checkpoints, e.g. when columns are counted differently after a change of settings.
+ *
+ * @param columns index of columns
+ */
+
+void
+edit_columns_reset (edit_columns_t * columns)
+{
+    if (columns->lines != NULL)
+        g_ptr_array_set_size (columns->lines, 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update the index when the text is changed.
+ *
+ * @param columns index of columns
+ * @param offset offset of the change
+ * @param deleted number of bytes removed at the offset
+ * @param inserted number of bytes inserted at the offset
+ */
+
+void
+edit_columns_update (edit_columns_t * columns, off_t offset, off_t deleted, off_t inserted)
+{
+    guint i = 0;
+
+    if (columns->lines == NULL)
+        return;
+
+    while (i < columns->lines->len)
+    {
+        edit_column_line_t *line;
+        GArray *points;
+        guint j;
+
+        line = (edit_column_line_t *) g_ptr_array_index (columns->lines, i);
+        points = line->points;
+
+        if (offset + deleted < line->start)
+        {
+            /* change above the line */
+            line->start += inserted - deleted;
+            for (j = 0; j < points->len; j++)
+                g_array_index (points, edit_column_point_t, j).offset += inserted - deleted;
+        }
+        else if (offset >= line->start)
+        {
+            /* change in the line or below it */
+            for (j = points->len; j != 0; j--)
+                if (g_array_index (points, edit_column_point_t, j - 1).offset < offset)
+                    break;
+            g_array_set_size (points, j);
+        }
+        else
+            g_array_set_size (points, 0);
+
+        if (points->len != 0)
+            i++;
+        else
+            g_ptr_array_remove_index (columns->lines, i);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the checkpoint to resume walking through the line from. Arguments are the same as ones
+ * of edit_move_forward3().
+ *
+ * @param columns index of columns
+ * @param start offset the columns are counted from
+ * @param cols column to find the offset of, ignored if upto is not 0
+ * @param upto offset to find the column of, 0 to find offset of cols
+ * @param col column at the returned offset
+ *
+ * @return offset of the nearest checkpoint before the searched position, start if none
+ */
+
+off_t
+edit_columns_lookup (const edit_columns_t * columns, off_t start, long cols, off_t upto,
+                     long *col)
+{
+    edit_column_line_t *line;
+    const edit_column_point_t *p;
+    guint lo = 0, hi;
+
+    *col = 0;
+
+    if (columns->lines == NULL)
+        return start;
+
+    line = edit_columns_find_line (columns, start);
+    if (line == NULL)
+        return start;
+
+    /* the last checkpoint before the position */
+    hi = line->points->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+
+        p = &g_array_index (line->points, edit_column_point_t, mid);
+        if (upto != 0 ? p->offset <= upto : p->col < cols)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return start;
+
+    p = &g_array_index (line->points, edit_column_point_t, lo - 1);
+    *col = p->col;
+    return p->offset;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add a checkpoint of line. Checkpoints are added in the order of offsets, a checkpoint before
+ * the last one is ignored. The least recently indexed line is forgotten if there are too many.
+ *
+ * @param columns index of columns
+ * @param start offset the columns are counted from
+ * @param offset offset of the checkpoint, an ASCII byte must be there
+ * @param col column at the offset
+ */
+
+void
+edit_columns_add (edit_columns_t * columns, off_t start, off_t offset, long col)
+{
+    edit_column_line_t *line;
+    edit_column_point_t p;
+
+    if (columns->lines == NULL)
+        return;
+
+    line = edit_columns_find_line (columns, start);
+    if (line == NULL)
+    {
+        if (columns->lines->len == COLUMN_LINES)
+            g_ptr_array_remove_index (columns->lines, 0);
+
+        line = g_new (edit_column_line_t, 1);
+        line->start = start;
+        line->points = g_array_new (FALSE, FALSE, sizeof (edit_column_point_t));
+        g_ptr_array_add (columns->lines, line);
+    }
+    else if (line->points->len != 0
+             && g_array_index (line->points, edit_column_point_t,
+                               line->points->len - 1).offset >= offset)
+        return;
+
+    p.offset = offset;
+    p.col = col;
+    g_array_append_val (line->points, p);
+}
+
+/* --------------------------------------------------------------------------------------------- */
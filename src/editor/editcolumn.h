@@ -0,0 +1,37 @@
+/** \file
+ *  \brief Header: index of columns of long lines of editor buffer
+ */
+
+#ifndef MC__EDIT_COLUMN_H
+#define MC__EDIT_COLUMN_H
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/* distance between checkpoints of columns in bytes */
+#define EDIT_COLUMN_STEP 4096
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_columns_struct
+{
+    GPtrArray *lines;           /* checkpoints of recently used long lines */
+} edit_columns_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_columns_init (edit_columns_t * columns);
+void edit_columns_clean (edit_columns_t * columns);
+void edit_columns_reset (edit_columns_t * columns);
+
+void edit_columns_update (edit_columns_t * columns, off_t offset, off_t deleted, off_t inserted);
+off_t edit_columns_lookup (const edit_columns_t * columns, off_t start, long cols, off_t upto,
+                           long *col);
+void edit_columns_add (edit_columns_t * columns, off_t start, off_t offset, long col);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_COLUMN_H */
@@ -76,6 +76,7 @@ gboolean visible_tabs = TRUE;
 #define MOD_MARKED              (1 << 10)
 #define MOD_CURSOR              (1 << 11)
 #define MOD_WHITESPACE          (1 << 12)
+#define MOD_SPELL               (1 << 13)
 
 #define edit_move(x,y) widget_gotoyx(edit, y, x);
 
@@ -91,6 +92,53 @@ typedef struct
     unsigned int style;
 } line_s;
 
+/* highlights which change the look of a row without change of its text */
+typedef struct
+{
+    off_t bracket;              /* matching bracket, -1 if none */
+    off_t mark_start;           /* selected block */
+    off_t mark_finish;
+    long column_start;          /* columns of selected column block */
+    long column_finish;
+    off_t found_start;          /* found string */
+    off_t found_finish;
+} edit_draw_highlight_t;
+
+/*
+ * Row of text rendered by edit_draw_this_line().
+ *
+ * Rendering of a row (decoding of characters, expansion of tabs, lookup of syntax colors) is
+ * much slower than output of it, so rows are kept between redraws and found by offset of the
+ * line start. When the page is scrolled, rows which stay on the screen are found at their new
+ * places and only the exposed ones are rendered again. A row is valid while the buffer has the
+ * same generation of text, the set of misspelled words is the same and the highlights within
+ * the row are the same. Options of display
+ * and syntax rules are not tracked: the cache is dropped on REDRAW_COMPLETELY and when syntax
+ * rules are loaded.
+ */
+typedef struct
+{
+    off_t offset;               /* offset of the line start */
+    unsigned long generation;   /* generation of buffer text the row is rendered from */
+    unsigned long spell;        /* generation of misspelled words the row is rendered with */
+    long line;                  /* line number */
+    long start_col;             /* requested range of columns */
+    long end_col;
+    long view_col;              /* first displayed column of editor */
+    int book_mark;              /* color of bookmark, 0 if none */
+    off_t finish;               /* offset after the last rendered character */
+    edit_draw_highlight_t highlight;    /* highlights within [offset, finish) */
+
+    /* arguments of print_to_widget () */
+    long print_start_col;
+    int start_col_real;
+    long print_end_col;
+    char line_stat[LINE_STATE_WIDTH + 1];
+    line_s *cells;
+
+    unsigned long frame;        /* number of page redraw the row was drawn last in */
+} edit_draw_row_t;
+
 /*** file scope variables ************************************************************************/
 
 /*** file scope functions ************************************************************************/
@@ -482,6 +530,8 @@ print_to_widget (WEdit * edit, long row, int start_col, int start_col_real,
             tty_setcolor (EDITOR_BOLD_COLOR);
         else if ((style & MOD_MARKED) != 0)
             tty_setcolor (EDITOR_MARKED_COLOR);
+        else if ((style & MOD_SPELL) != 0)
+            tty_setcolor (EDITOR_SPELL_COLOR);
         else
             tty_lowlevel_setcolor (color);
 
@@ -496,6 +546,133 @@ print_to_widget (WEdit * edit, long row, int start_col, int start_col_real,
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_draw_row_free (gpointer data)
+{
+    edit_draw_row_t *r = (edit_draw_row_t *) data;
+
+    g_free (r->cells);
+    g_free (r);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get highlights of text clipped to range [start, finish).
+ */
+
+static void
+edit_draw_get_highlight (WEdit * edit, off_t start, off_t finish, edit_draw_highlight_t * h)
+{
+    off_t m1 = 0, m2 = 0;
+
+    eval_marks (edit, &m1, &m2);
+
+    h->mark_start = MAX (m1, start);
+    h->mark_finish = MIN (m2, finish);
+    h->column_start = 0;
+    h->column_finish = 0;
+    if (h->mark_start >= h->mark_finish)
+        h->mark_start = h->mark_finish = 0;
+    else if (edit->column_highlight)
+    {
+        h->column_start = MIN (edit->column1, edit->column2);
+        h->column_finish = MAX (edit->column1, edit->column2);
+    }
+
+    h->found_start = MAX (edit->found_start, start);
+    h->found_finish = MIN ((off_t) (edit->found_start + edit->found_len), finish);
+    if (h->found_start >= h->found_finish)
+        h->found_start = h->found_finish = 0;
+
+    h->bracket = (edit->bracket >= start && edit->bracket < finish) ? edit->bracket : -1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get cached row of line starting at specified offset. If there is no such row, get a row
+ * rendered from old text to be reused or a new one.
+ */
+
+static edit_draw_row_t *
+edit_draw_cache_get_row (WEdit * edit, off_t offset)
+{
+    edit_draw_row_t *r, *old = NULL;
+    guint i;
+
+    if (edit->draw_rows == NULL)
+        edit->draw_rows = g_ptr_array_new_with_free_func (edit_draw_row_free);
+
+    for (i = 0; i < edit->draw_rows->len; i++)
+    {
+        r = (edit_draw_row_t *) g_ptr_array_index (edit->draw_rows, i);
+
+        if (r->offset == offset)
+            return r;
+        if (old == NULL && r->generation != edit->buffer.generation)
+            old = r;
+    }
+
+    if (old != NULL)
+        return old;
+
+    r = g_new0 (edit_draw_row_t, 1);
+    r->offset = -1;
+    g_ptr_array_add (edit->draw_rows, r);
+
+    return r;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+edit_draw_row_is_valid (WEdit * edit, const edit_draw_row_t * r, off_t offset, long line,
+                        long start_col, long end_col, int book_mark)
+{
+    edit_draw_highlight_t h;
+
+    if (r->offset != offset || r->generation != edit->buffer.generation
+        || r->spell != edit->spell.generation || r->line != line
+        || r->start_col != start_col || r->end_col != end_col || r->view_col != edit->start_col
+        || r->book_mark != book_mark)
+        return FALSE;
+
+    edit_draw_get_highlight (edit, r->offset, r->finish, &h);
+
+    return (h.bracket == r->highlight.bracket && h.mark_start == r->highlight.mark_start
+            && h.mark_finish == r->highlight.mark_finish
+            && h.column_start == r->highlight.column_start
+            && h.column_finish == r->highlight.column_finish
+            && h.found_start == r->highlight.found_start
+            && h.found_finish == r->highlight.found_finish);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Forget rows which were not drawn in the last redraw of page.
+ */
+
+static void
+edit_draw_cache_prune (WEdit * edit)
+{
+    guint i = 0;
+
+    if (edit->draw_rows == NULL)
+        return;
+
+    while (i < edit->draw_rows->len)
+    {
+        const edit_draw_row_t *r;
+
+        r = (const edit_draw_row_t *) g_ptr_array_index (edit->draw_rows, i);
+        if (r->frame != edit->draw_frame)
+            g_ptr_array_remove_index_fast (edit->draw_rows, i);
+        else
+            i++;
+    }
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /** b is a pointer to the beginning of the line */
 
@@ -511,6 +688,8 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
     int abn_style;
     int book_mark = 0;
     char line_stat[LINE_STATE_WIDTH + 1] = "\0";
+    long cur_line;
+    edit_draw_row_t *r = NULL;
 
     if (row > w->lines - 1 - EDIT_TEXT_VERTICAL_OFFSET - 2 * (edit->fullscreen ? 0 : 1))
         return;
@@ -525,6 +704,31 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
     else
         abn_style = MOD_ABNORMAL;
 
+    cur_line = edit->start_line + row;
+
+    /* rows below the end of text have the same offset, they are not cached */
+    if (cur_line <= edit->buffer.lines)
+    {
+        r = edit_draw_cache_get_row (edit, b);
+        if (edit_draw_row_is_valid (edit, r, b, cur_line, start_col, end_col, book_mark))
+        {
+            r->frame = edit->draw_frame;
+            memcpy (line_stat, r->line_stat, sizeof (line_stat));
+            print_to_widget (edit, row, r->print_start_col, r->start_col_real, r->print_end_col,
+                             r->cells, line_stat, book_mark);
+            return;
+        }
+
+        r->offset = b;
+        r->generation = edit->buffer.generation;
+        r->spell = edit->spell.generation;
+        r->line = cur_line;
+        r->start_col = start_col;
+        r->end_col = end_col;
+        r->view_col = edit->start_col;
+        r->book_mark = book_mark;
+    }
+
     end_col -= EDIT_TEXT_HORIZONTAL_OFFSET + option_line_state_width;
     if (!edit->fullscreen)
     {
@@ -540,9 +744,6 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
 
     if (option_line_state)
     {
-        long cur_line;
-
-        cur_line = edit->start_line + row;
         if (cur_line <= edit->buffer.lines)
             g_snprintf (line_stat, sizeof (line_stat), "%7ld ", cur_line + 1);
         else
@@ -566,6 +767,10 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
         if (row <= edit->buffer.lines - edit->start_line)
         {
             off_t tws = 0;
+            off_t spell_start = 0, spell_finish = 0;
+            gboolean spell;
+
+            spell = edit_spell_get_word (&edit->spell, q, &spell_start, &spell_finish);
 
             if (tty_use_colors () && visible_tws)
                 for (tws = edit_buffer_get_eol (&edit->buffer, b); tws > b; tws--)
@@ -611,6 +816,12 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
                 if (q >= edit->found_start && q < (off_t) (edit->found_start + edit->found_len))
                     p->style |= MOD_BOLD;
 
+                /* misspelled words are sorted, take the next one after passing the previous one */
+                if (spell && q >= spell_finish)
+                    spell = edit_spell_get_word (&edit->spell, q, &spell_start, &spell_finish);
+                if (spell && q >= spell_start)
+                    p->style |= MOD_SPELL;
+
 #ifdef HAVE_CHARSET
                 if (edit->utf8)
                     c = edit_buffer_get_utf (&edit->buffer, q, &char_length);
@@ -821,6 +1032,19 @@ edit_draw_this_line (WEdit * edit, off_t b, long row, long start_col, long end_c
 
     p->ch = 0;
 
+    if (r != NULL)
+    {
+        r->finish = q;
+        edit_draw_get_highlight (edit, b, q, &r->highlight);
+        r->print_start_col = start_col;
+        r->start_col_real = start_col_real;
+        r->print_end_col = end_col;
+        memcpy (r->line_stat, line_stat, sizeof (line_stat));
+        g_free (r->cells);
+        r->cells = g_memdup (line, (p - line + 1) * sizeof (line_s));
+        r->frame = edit->draw_frame;
+    }
+
     print_to_widget (edit, row, start_col, start_col_real, end_col, line, line_stat, book_mark);
 }
 
@@ -851,6 +1075,9 @@ render_edit_text (WEdit * edit, long start_row, long start_column, long end_row,
     int y1, x1, y2, x2;
     int last_line, last_column;
 
+    if ((force & REDRAW_COMPLETELY) != 0)
+        edit_render_cache_clean (edit);
+
     /* draw only visible region */
 
     last_line = wh->y + wh->lines - 1;
@@ -904,6 +1131,8 @@ render_edit_text (WEdit * edit, long start_row, long start_column, long end_row,
 
         if ((force & REDRAW_PAGE) != 0)
         {
+            edit->draw_frame++;
+
             b = edit_buffer_get_forward_offset (&edit->buffer, edit->start_display, start_row, 0);
             for (row = start_row; row <= end_row; row++)
             {
@@ -912,6 +1141,8 @@ render_edit_text (WEdit * edit, long start_row, long start_column, long end_row,
                 edit_draw_this_line (edit, b, row, start_column, end_column);
                 b = edit_buffer_get_forward_offset (&edit->buffer, b, 1, 0);
             }
+
+            edit_draw_cache_prune (edit);
         }
         else
         {
@@ -1136,3 +1367,20 @@ edit_render_keypress (WEdit * edit)
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Forget rendered rows of text, e.g. if colors of text are changed.
+ *
+ * @param edit editor object
+ */
+
+void
+edit_render_cache_clean (WEdit * edit)
+{
+    if (edit->draw_rows != NULL)
+    {
+        g_ptr_array_free (edit->draw_rows, TRUE);
+        edit->draw_rows = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,332 @@
+/*
+   Markers of positions in editor buffer moved by changes of text.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: markers of positions in editor buffer moved by changes of text.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <string.h>
+
+#include "lib/global.h"
+
+#include "editmarker.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * Markers are kept in an array sorted by position, markers at the same position are kept in the
+ * order they were inserted. A marker stores its position minus the sum of shifts of all markers
+ * up to it, the shifts are kept in a Fenwick tree indexed by number of marker. So a change of
+ * text moving all markers after it is a single update of the tree, and a position of marker
+ * is its stored position plus a prefix sum of the tree.
+ *
+ * Markers are added to the end of array in logarithmic time. Insertion and removal in the middle
+ * of array apply all shifts to the stored positions and clear the tree, which is linear.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    off_t pos;                  /* position minus sum of shifts up to the marker */
+    int value;
+} edit_marker_t;
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get sum of shifts of first markers.
+ *
+ * @param tree Fenwick tree of shifts
+ * @param n number of markers
+ *
+ * @return sum of shifts of markers [0, n)
+ */
+
+static off_t
+edit_markers_shift_sum (const GArray * tree, guint n)
+{
+    off_t sum = 0;
+
+    for (; n != 0; n &= n - 1)
+        sum += g_array_index (tree, off_t, n);
+
+    return sum;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Shift marker and all markers after it.
+ *
+ * @param tree Fenwick tree of shifts
+ * @param index index of marker
+ * @param delta value to add to positions
+ */
+
+static void
+edit_markers_shift_add (GArray * tree, guint index, off_t delta)
+{
+    guint n;
+
+    for (n = index + 1; n < tree->len; n += n & (~n + 1))
+        g_array_index (tree, off_t, n) += delta;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Apply all shifts to stored positions of markers and clear the tree.
+ */
+
+static void
+edit_markers_flatten (edit_markers_t * markers)
+{
+    guint i;
+
+    for (i = 0; i < markers->markers->len; i++)
+        g_array_index (markers->markers, edit_marker_t, i).pos =
+            edit_markers_get_pos (markers, i);
+
+    g_array_set_size (markers->shifts, markers->markers->len + 1);
+    memset (markers->shifts->data, 0, markers->shifts->len * sizeof (off_t));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the first marker after position.
+ *
+ * @return index of the first marker with position greater than pos, number of markers if none
+ */
+
+static guint
+edit_markers_find_after (const edit_markers_t * markers, off_t pos)
+{
+    guint lo = 0, hi;
+
+    hi = edit_markers_count (markers);
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (edit_markers_get_pos (markers, mid) <= pos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_markers_init (edit_markers_t * markers)
+{
+    markers->markers = NULL;
+    markers->shifts = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_markers_clean (edit_markers_t * markers)
+{
+    if (markers->markers != NULL)
+    {
+        g_array_free (markers->markers, TRUE);
+        g_array_free (markers->shifts, TRUE);
+        edit_markers_init (markers);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+off_t
+edit_markers_get_pos (const edit_markers_t * markers, guint index)
+{
+    return g_array_index (markers->markers, edit_marker_t, index).pos
+        + edit_markers_shift_sum (markers->shifts, index + 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+edit_markers_get_value (const edit_markers_t * markers, guint index)
+{
+    return g_array_index (markers->markers, edit_marker_t, index).value;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find the first marker at or after position.
+ *
+ * @param markers set of markers
+ * @param pos position
+ *
+ * @return index of the first marker with position not less than pos, number of markers if none
+ */
+
+guint
+edit_markers_find (const edit_markers_t * markers, off_t pos)
+{
+    return edit_markers_find_after (markers, pos - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add a marker after all markers at the same position.
+ *
+ * @param markers set of markers
+ * @param pos position of marker
+ * @param value value kept with marker
+ *
+ * @return index of the new marker
+ */
+
+guint
+edit_markers_insert (edit_markers_t * markers, off_t pos, int value)
+{
+    edit_marker_t m;
+    guint index;
+
+    if (markers->markers == NULL)
+    {
+        markers->markers = g_array_new (FALSE, FALSE, sizeof (edit_marker_t));
+        markers->shifts = g_array_new (FALSE, TRUE, sizeof (off_t));
+        g_array_set_size (markers->shifts, 1);
+    }
+
+    index = edit_markers_find_after (markers, pos);
+    m.value = value;
+
+    if (index == markers->markers->len)
+    {
+        guint n;
+        off_t node;
+
+        m.pos = pos - edit_markers_shift_sum (markers->shifts, index);
+        g_array_append_val (markers->markers, m);
+
+        /* the new node of tree covers shifts of markers before the new one */
+        n = markers->shifts->len;
+        node = edit_markers_shift_sum (markers->shifts, n - 1)
+            - edit_markers_shift_sum (markers->shifts, n & (n - 1));
+        g_array_append_val (markers->shifts, node);
+    }
+    else
+    {
+        edit_markers_flatten (markers);
+        m.pos = pos;
+        g_array_insert_val (markers->markers, index, m);
+        g_array_set_size (markers->shifts, markers->markers->len + 1);
+    }
+
+    return index;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_markers_remove (edit_markers_t * markers, guint index)
+{
+    if (index + 1 != markers->markers->len)
+        edit_markers_flatten (markers);
+
+    g_array_remove_index (markers->markers, index);
+    g_array_set_size (markers->shifts, markers->markers->len + 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove all markers with specified value.
+ *
+ * @param markers set of markers
+ * @param value value of markers to remove
+ */
+
+void
+edit_markers_remove_value (edit_markers_t * markers, int value)
+{
+    guint i, n = 0;
+
+    if (markers->markers == NULL)
+        return;
+
+    edit_markers_flatten (markers);
+
+    for (i = 0; i < markers->markers->len; i++)
+    {
+        const edit_marker_t *m = &g_array_index (markers->markers, edit_marker_t, i);
+
+        if (m->value != value)
+            g_array_index (markers->markers, edit_marker_t, n++) = *m;
+    }
+
+    g_array_set_size (markers->markers, n);
+    g_array_set_size (markers->shifts, n + 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Move markers after a position. The order of markers is kept: if the delta is negative,
+ * markers in range (pos, pos - delta] are moved to the position.
+ *
+ * @param markers set of markers
+ * @param pos position, markers at it aren't moved
+ * @param delta value to add to positions of markers after pos
+ */
+
+void
+edit_markers_shift (edit_markers_t * markers, off_t pos, off_t delta)
+{
+    guint i, j;
+
+    if (markers->markers == NULL || delta == 0)
+        return;
+
+    i = edit_markers_find_after (markers, pos);
+
+    if (delta > 0)
+    {
+        edit_markers_shift_add (markers->shifts, i, delta);
+        return;
+    }
+
+    j = edit_markers_find_after (markers, pos - delta);
+    edit_markers_shift_add (markers->shifts, j, delta);
+
+    for (; i < j; i++)
+        g_array_index (markers->markers, edit_marker_t, i).pos =
+            pos - edit_markers_shift_sum (markers->shifts, i + 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,46 @@
+/** \file
+ *  \brief Header: markers of positions in editor buffer moved by changes of text
+ */
+
+#ifndef MC__EDIT_MARKER_H
+#define MC__EDIT_MARKER_H
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_markers_struct
+{
+    GArray *markers;            /* markers sorted by position, NULL if there were none */
+    GArray *shifts;             /* Fenwick tree of shifts of positions of markers */
+} edit_markers_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_markers_init (edit_markers_t * markers);
+void edit_markers_clean (edit_markers_t * markers);
+
+off_t edit_markers_get_pos (const edit_markers_t * markers, guint index);
+int edit_markers_get_value (const edit_markers_t * markers, guint index);
+guint edit_markers_find (const edit_markers_t * markers, off_t pos);
+
+guint edit_markers_insert (edit_markers_t * markers, off_t pos, int value);
+void edit_markers_remove (edit_markers_t * markers, guint index);
+void edit_markers_remove_value (edit_markers_t * markers, int value);
+void edit_markers_shift (edit_markers_t * markers, off_t pos, off_t delta);
+
+/*** inline functions ****************************************************************************/
+
+static inline guint
+edit_markers_count (const edit_markers_t * markers)
+{
+    return (markers->markers == NULL ? 0 : markers->markers->len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+#endif /* MC__EDIT_MARKER_H */
@@ -110,6 +110,24 @@ edit_reload_syntax (void *data, void *user_data)
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Callback for the iteration of objects in the 'editors' array.
+ * Forget columns of long lines counted with the old tab spacing in all editors.
+ *
+ * @param data      probably WEdit object
+ * @param user_data unused
+ */
+
+static void
+edit_reset_columns (void *data, void *user_data)
+{
+    (void) user_data;
+
+    if (edit_widget_is_editor (CONST_WIDGET (data)))
+        edit_columns_reset (((WEdit *) data)->columns);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -211,10 +229,15 @@ edit_options_dialog (WDialog * h)
 
     if (q != NULL)
     {
+        int old_tab_spacing = option_tab_spacing;
+
         option_tab_spacing = atoi (q);
         if (option_tab_spacing <= 0)
             option_tab_spacing = DEFAULT_TAB_SPACING;
         g_free (q);
+
+        if (option_tab_spacing != old_tab_spacing)
+            g_list_foreach (GROUP (h)->widgets, edit_reset_columns, NULL);
     }
 
     if (wrap_mode == 1)
@@ -0,0 +1,815 @@
+/*
+   Sorting of lines of text for the Sort command of editor.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: sorting of lines of text for the Sort command of editor.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/global.h"
+
+#include "editsort.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * The text is split into lines which are sorted in place by merge sort. Options are those
+ * of sort(1) the user types in the Sort dialog; only the following ones are understood:
+ *
+ *   -b, --ignore-leading-blanks    -f, --ignore-case     -n, --numeric-sort
+ *   -r, --reverse                  -s, --stable          -u, --unique
+ *   -V, --version-sort             -k, --key=POS1[,POS2] -t, --field-separator=SEP
+ *
+ * Keys are compared byte by byte, as sort(1) does in the C locale. For anything else
+ * edit_sort_text() returns NULL and the caller should run sort(1) itself.
+ *
+ * Both halves of a large array are sorted at the same time by separate threads, if GLib has
+ * built-in thread support.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+#if GLIB_CHECK_VERSION (2, 34, 0)
+#define EDIT_SORT_THREADS 1
+#endif
+
+/* arrays of lines not longer than this are sorted by insertion */
+#define SORT_INSERTION_MAX 16
+
+/* arrays of lines shorter than this are not split between threads */
+#define SORT_THREAD_MIN_LINES 32768
+
+/* max depth of halving the array between threads: up to 2^depth threads are used */
+#define SORT_THREAD_MAX_DEPTH 3
+
+/*** file scope type declarations ****************************************************************/
+
+/* ordering options */
+enum
+{
+    SORT_BLANKS = 1 << 0,       /* ignore leading blanks */
+    SORT_FOLD = 1 << 1,         /* fold lower case to upper case */
+    SORT_NUMERIC = 1 << 2,      /* compare numeric values */
+    SORT_REVERSE = 1 << 3,      /* reverse the result of comparison */
+    SORT_VERSION = 1 << 4       /* compare numbers inside text by value */
+};
+
+typedef struct
+{
+    long field1;                /* first field of key, from 1 */
+    long char1;                 /* first character of key in the first field, from 1 */
+    long field2;                /* last field of key, from 1; 0 for the end of line */
+    long char2;                 /* last character of key in the last field, from 1; 0 for
+                                   the end of field */
+    int flags;                  /* ordering options of key, 0 to use global ones */
+} edit_sort_key_t;
+
+typedef struct
+{
+    GArray *keys;               /* sort keys, the whole line if empty */
+    int flags;                  /* global ordering options */
+    int separator;              /* field separator, -1 if fields are separated by blanks */
+    gboolean stable;            /* don't compare whole lines if keys are equal */
+    gboolean unique;            /* output only the first of lines with equal keys */
+} edit_sort_t;
+
+typedef struct
+{
+    const char *str;
+    gsize len;                  /* length of line without newline */
+} edit_sort_line_t;
+
+typedef struct
+{
+    gboolean negative;
+    const char *digits;         /* integer part without leading zeros */
+    gsize int_len;
+    const char *frac;           /* fraction part without trailing zeros */
+    gsize frac_len;
+} edit_sort_number_t;
+
+/* part of array of lines sorted by one thread */
+typedef struct
+{
+    const edit_sort_t *sort;
+    edit_sort_line_t *lines;
+    edit_sort_line_t *tmp;      /* space to merge lines in, same size as lines */
+    gsize n;                    /* number of lines */
+    int depth;                  /* depth of halving this part between threads yet */
+} edit_sort_job_t;
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_sort_is_blank (char c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+edit_sort_parse_flag (char c, int *flags)
+{
+    switch (c)
+    {
+    case 'b':
+        *flags |= SORT_BLANKS;
+        break;
+    case 'f':
+        *flags |= SORT_FOLD;
+        break;
+    case 'n':
+        *flags |= SORT_NUMERIC;
+        break;
+    case 'r':
+        *flags |= SORT_REVERSE;
+        break;
+    case 'V':
+        *flags |= SORT_VERSION;
+        break;
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Parse position of key: F[.C][OPTS].
+ *
+ * @return pointer to the character following the position, NULL if it is malformed
+ */
+
+static const char *
+edit_sort_parse_position (const char *s, long *field, long *chr, int *flags)
+{
+    char *end;
+
+    if (!isdigit ((unsigned char) *s))
+        return NULL;
+
+    *field = strtol (s, &end, 10);
+    s = end;
+
+    if (*s == '.')
+    {
+        if (!isdigit ((unsigned char) s[1]))
+            return NULL;
+
+        *chr = strtol (s + 1, &end, 10);
+        s = end;
+    }
+
+    for (; *s != '\0' && *s != ','; s++)
+        if (!edit_sort_parse_flag (*s, flags))
+            return NULL;
+
+    return s;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+edit_sort_parse_key (edit_sort_t * sort, const char *s)
+{
+    edit_sort_key_t key = { 0, 1, 0, 0, 0 };
+
+    s = edit_sort_parse_position (s, &key.field1, &key.char1, &key.flags);
+    if (s == NULL || key.field1 < 1 || key.char1 < 1)
+        return FALSE;
+
+    if (*s == ',')
+    {
+        s = edit_sort_parse_position (s + 1, &key.field2, &key.char2, &key.flags);
+        if (s == NULL || *s != '\0' || key.field2 < 1)
+            return FALSE;
+    }
+
+    g_array_append_val (sort->keys, key);
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gboolean
+edit_sort_parse_separator (edit_sort_t * sort, const char *s)
+{
+    if (s[0] == '\0' || s[1] != '\0')
+        return FALSE;
+
+    sort->separator = (unsigned char) s[0];
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Parse options of sort(1).
+ *
+ * @return TRUE if all options are understood, FALSE otherwise
+ */
+
+static gboolean
+edit_sort_parse_options (edit_sort_t * sort, const char *options)
+{
+    gchar **argv = NULL;
+    int argc, i;
+    GError *error = NULL;
+    gboolean ok = TRUE;
+
+    if (!g_shell_parse_argv (options, &argc, &argv, &error))
+    {
+        /* no options at all */
+        ok = g_error_matches (error, G_SHELL_ERROR, G_SHELL_ERROR_EMPTY_STRING);
+        g_error_free (error);
+        return ok;
+    }
+
+    for (i = 0; ok && i < argc; i++)
+    {
+        const char *arg = argv[i];
+
+        if (strcmp (arg, "--ignore-leading-blanks") == 0)
+            sort->flags |= SORT_BLANKS;
+        else if (strcmp (arg, "--ignore-case") == 0)
+            sort->flags |= SORT_FOLD;
+        else if (strcmp (arg, "--numeric-sort") == 0)
+            sort->flags |= SORT_NUMERIC;
+        else if (strcmp (arg, "--reverse") == 0)
+            sort->flags |= SORT_REVERSE;
+        else if (strcmp (arg, "--version-sort") == 0)
+            sort->flags |= SORT_VERSION;
+        else if (strcmp (arg, "--stable") == 0)
+            sort->stable = TRUE;
+        else if (strcmp (arg, "--unique") == 0)
+            sort->unique = TRUE;
+        else if (strncmp (arg, "--key=", 6) == 0)
+            ok = edit_sort_parse_key (sort, arg + 6);
+        else if (strncmp (arg, "--field-separator=", 18) == 0)
+            ok = edit_sort_parse_separator (sort, arg + 18);
+        else if (arg[0] == '-' && arg[1] != '-' && arg[1] != '\0')
+        {
+            const char *p;
+
+            for (p = arg + 1; ok && *p != '\0'; p++)
+            {
+                if (*p == 's')
+                    sort->stable = TRUE;
+                else if (*p == 'u')
+                    sort->unique = TRUE;
+                else if (*p == 'k' || *p == 't')
+                {
+                    const char *value;
+
+                    /* value is either the rest of argument or the next argument */
+                    if (p[1] != '\0')
+                        value = p + 1;
+                    else if (i + 1 < argc)
+                        value = argv[++i];
+                    else
+                        value = NULL;
+
+                    if (value == NULL)
+                        ok = FALSE;
+                    else if (*p == 'k')
+                        ok = edit_sort_parse_key (sort, value);
+                    else
+                        ok = edit_sort_parse_separator (sort, value);
+                    break;
+                }
+                else
+                    ok = edit_sort_parse_flag (*p, &sort->flags);
+            }
+        }
+        else
+        {
+            /* file names and unsupported options */
+            ok = FALSE;
+        }
+    }
+
+    g_strfreev (argv);
+
+    return ok;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Skip fields of line.
+ *
+ * @return offset of the start of the field following skipped ones
+ */
+
+static gsize
+edit_sort_skip_fields (const edit_sort_t * sort, const char *s, gsize len, gsize i, long fields)
+{
+    for (; fields > 0 && i < len; fields--)
+    {
+        if (sort->separator >= 0)
+        {
+            const char *p;
+
+            p = memchr (s + i, sort->separator, len - i);
+            i = p == NULL ? len : (gsize) (p - s) + 1;
+        }
+        else
+        {
+            /* field consists of leading blanks and non-blanks */
+            while (i < len && edit_sort_is_blank (s[i]))
+                i++;
+            while (i < len && !edit_sort_is_blank (s[i]))
+                i++;
+        }
+    }
+
+    return i;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gsize
+edit_sort_skip_blanks (const char *s, gsize len, gsize i)
+{
+    while (i < len && edit_sort_is_blank (s[i]))
+        i++;
+
+    return i;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_sort_get_key (const edit_sort_t * sort, const edit_sort_key_t * key, int flags,
+                   const edit_sort_line_t * line, const char **start, const char **end)
+{
+    const char *s = line->str;
+    gsize len = line->len;
+    gsize b, e;
+
+    b = edit_sort_skip_fields (sort, s, len, 0, key->field1 - 1);
+    if ((flags & SORT_BLANKS) != 0)
+        b = edit_sort_skip_blanks (s, len, b);
+    b = MIN (b + (gsize) (key->char1 - 1), len);
+
+    if (key->field2 == 0)
+        e = len;
+    else
+    {
+        e = edit_sort_skip_fields (sort, s, len, 0, key->field2 - 1);
+
+        if (key->char2 == 0)
+        {
+            /* the end of field, without separator following it */
+            e = edit_sort_skip_fields (sort, s, len, e, 1);
+            if (sort->separator >= 0 && e != 0 && s[e - 1] == (char) sort->separator)
+                e--;
+        }
+        else
+        {
+            if ((flags & SORT_BLANKS) != 0)
+                e = edit_sort_skip_blanks (s, len, e);
+            e = MIN (e + (gsize) key->char2, len);
+        }
+    }
+
+    *start = s + b;
+    *end = s + MAX (b, e);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_sort_parse_number (const char *s, const char *end, edit_sort_number_t * num)
+{
+    while (s < end && edit_sort_is_blank (*s))
+        s++;
+
+    num->negative = (s < end && *s == '-');
+    if (num->negative)
+        s++;
+
+    while (s < end && *s == '0')
+        s++;
+
+    num->digits = s;
+    while (s < end && isdigit ((unsigned char) *s))
+        s++;
+    num->int_len = (gsize) (s - num->digits);
+
+    num->frac = s;
+    num->frac_len = 0;
+
+    if (s < end && *s == '.')
+    {
+        num->frac = ++s;
+        while (s < end && isdigit ((unsigned char) *s))
+            s++;
+        num->frac_len = (gsize) (s - num->frac);
+    }
+
+    while (num->frac_len != 0 && num->frac[num->frac_len - 1] == '0')
+        num->frac_len--;
+
+    /* -0 is 0 */
+    if (num->int_len == 0 && num->frac_len == 0)
+        num->negative = FALSE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Compare numbers of any length as strings of digits. Text following the number is ignored,
+ * empty string is zero.
+ */
+
+static int
+edit_sort_numeric_cmp (const char *a, const char *ae, const char *b, const char *be)
+{
+    edit_sort_number_t x, y;
+    int r;
+
+    edit_sort_parse_number (a, ae, &x);
+    edit_sort_parse_number (b, be, &y);
+
+    if (x.negative != y.negative)
+        return x.negative ? -1 : 1;
+
+    if (x.int_len != y.int_len)
+        r = x.int_len < y.int_len ? -1 : 1;
+    else
+    {
+        gsize i;
+
+        r = memcmp (x.digits, y.digits, x.int_len);
+
+        for (i = 0; r == 0 && i < MAX (x.frac_len, y.frac_len); i++)
+            r = (i < x.frac_len ? x.frac[i] : '0') - (i < y.frac_len ? y.frac[i] : '0');
+    }
+
+    return x.negative ? -r : r;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Compare strings with numbers inside them compared by value: "a9" < "a10".
+ */
+
+static int
+edit_sort_version_cmp (const char *a, const char *ae, const char *b, const char *be)
+{
+    while (a < ae && b < be)
+    {
+        if (isdigit ((unsigned char) *a) && isdigit ((unsigned char) *b))
+        {
+            const char *na, *nb;
+            int r;
+
+            while (a < ae && *a == '0')
+                a++;
+            while (b < be && *b == '0')
+                b++;
+
+            for (na = a; a < ae && isdigit ((unsigned char) *a); a++)
+                ;
+            for (nb = b; b < be && isdigit ((unsigned char) *b); b++)
+                ;
+
+            if (a - na != b - nb)
+                return (a - na < b - nb) ? -1 : 1;
+
+            r = memcmp (na, nb, (size_t) (a - na));
+            if (r != 0)
+                return r;
+        }
+        else if (*a != *b)
+            return (unsigned char) *a - (unsigned char) *b;
+        else
+        {
+            a++;
+            b++;
+        }
+    }
+
+    return (a < ae ? 1 : 0) - (b < be ? 1 : 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+edit_sort_bytes_cmp (gboolean fold, const char *a, const char *ae, const char *b, const char *be)
+{
+    gsize alen = (gsize) (ae - a);
+    gsize blen = (gsize) (be - b);
+    gsize i, n;
+
+    n = MIN (alen, blen);
+
+    if (!fold)
+    {
+        int r;
+
+        r = memcmp (a, b, n);
+        if (r != 0)
+            return r;
+    }
+    else
+        for (i = 0; i < n; i++)
+        {
+            unsigned char ca, cb;
+
+            ca = (unsigned char) g_ascii_toupper (a[i]);
+            cb = (unsigned char) g_ascii_toupper (b[i]);
+            if (ca != cb)
+                return ca - cb;
+        }
+
+    return (alen > blen ? 1 : 0) - (alen < blen ? 1 : 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+edit_sort_compare_keys (int flags, const char *a, const char *ae, const char *b, const char *be)
+{
+    int r;
+
+    if ((flags & SORT_NUMERIC) != 0)
+        r = edit_sort_numeric_cmp (a, ae, b, be);
+    else if ((flags & SORT_VERSION) != 0)
+        r = edit_sort_version_cmp (a, ae, b, be);
+    else
+        r = edit_sort_bytes_cmp ((flags & SORT_FOLD) != 0, a, ae, b, be);
+
+    return ((flags & SORT_REVERSE) != 0 ? -r : r);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Compare lines by keys.
+ *
+ * @param last_resort if TRUE, lines with equal keys are compared as a whole unless the sort
+ *                    is stable or unique
+ */
+
+static int
+edit_sort_compare (const edit_sort_t * sort, const edit_sort_line_t * a,
+                   const edit_sort_line_t * b, gboolean last_resort)
+{
+    int r = 0;
+
+    if (sort->keys->len == 0)
+    {
+        gsize i = 0, j = 0;
+
+        if ((sort->flags & SORT_BLANKS) != 0)
+        {
+            i = edit_sort_skip_blanks (a->str, a->len, 0);
+            j = edit_sort_skip_blanks (b->str, b->len, 0);
+        }
+
+        r = edit_sort_compare_keys (sort->flags, a->str + i, a->str + a->len, b->str + j,
+                                    b->str + b->len);
+    }
+    else
+    {
+        guint k;
+
+        for (k = 0; r == 0 && k < sort->keys->len; k++)
+        {
+            const edit_sort_key_t *key = &g_array_index (sort->keys, edit_sort_key_t, k);
+            int flags = key->flags != 0 ? key->flags : sort->flags;
+            const char *as, *ae, *bs, *be;
+
+            edit_sort_get_key (sort, key, flags, a, &as, &ae);
+            edit_sort_get_key (sort, key, flags, b, &bs, &be);
+            r = edit_sort_compare_keys (flags, as, ae, bs, be);
+        }
+    }
+
+    if (r == 0 && last_resort && !sort->stable && !sort->unique)
+        r = edit_sort_compare_keys (sort->flags & SORT_REVERSE, a->str, a->str + a->len, b->str,
+                                    b->str + b->len);
+
+    return r;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void edit_sort_lines (edit_sort_job_t * job);
+
+#ifdef EDIT_SORT_THREADS
+static gpointer
+edit_sort_thread (gpointer data)
+{
+    edit_sort_lines ((edit_sort_job_t *) data);
+
+    return NULL;
+}
+#endif
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Stable merge sort of lines. Halves of large parts are sorted in parallel.
+ */
+
+static void
+edit_sort_lines (edit_sort_job_t * job)
+{
+    const edit_sort_t *sort = job->sort;
+    edit_sort_line_t *lines = job->lines;
+    edit_sort_job_t left, right;
+    gsize half, i, j, k;
+#ifdef EDIT_SORT_THREADS
+    GThread *thread = NULL;
+#endif
+
+    if (job->n <= SORT_INSERTION_MAX)
+    {
+        for (i = 1; i < job->n; i++)
+        {
+            edit_sort_line_t line = lines[i];
+
+            for (j = i; j > 0 && edit_sort_compare (sort, &lines[j - 1], &line, TRUE) > 0; j--)
+                lines[j] = lines[j - 1];
+            lines[j] = line;
+        }
+
+        return;
+    }
+
+    half = job->n / 2;
+
+    left.sort = right.sort = sort;
+    left.lines = lines;
+    left.tmp = job->tmp;
+    left.n = half;
+    right.lines = lines + half;
+    right.tmp = job->tmp + half;
+    right.n = job->n - half;
+    left.depth = right.depth = job->depth - 1;
+
+#ifdef EDIT_SORT_THREADS
+    if (job->depth > 0 && job->n >= SORT_THREAD_MIN_LINES)
+        thread = g_thread_try_new ("sort", edit_sort_thread, &right, NULL);
+    if (thread == NULL)
+#endif
+        edit_sort_lines (&right);
+
+    edit_sort_lines (&left);
+
+#ifdef EDIT_SORT_THREADS
+    if (thread != NULL)
+        g_thread_join (thread);
+#endif
+
+    /* halves are in order already */
+    if (edit_sort_compare (sort, &lines[half - 1], &lines[half], TRUE) <= 0)
+        return;
+
+    for (i = 0, j = half, k = 0; i < half && j < job->n; k++)
+        if (edit_sort_compare (sort, &lines[i], &lines[j], TRUE) <= 0)
+            job->tmp[k] = lines[i++];
+        else
+            job->tmp[k] = lines[j++];
+
+    while (i < half)
+        job->tmp[k++] = lines[i++];
+
+    /* the rest of the right half is in place already */
+    memcpy (lines, job->tmp, k * sizeof (edit_sort_line_t));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static int
+edit_sort_get_thread_depth (void)
+{
+    int depth = 0;
+
+#ifdef EDIT_SORT_THREADS
+#if GLIB_CHECK_VERSION (2, 36, 0)
+    guint n;
+
+    for (n = g_get_num_processors (); n > 1 && depth < SORT_THREAD_MAX_DEPTH; n = (n + 1) / 2)
+        depth++;
+#else
+    depth = SORT_THREAD_MAX_DEPTH;
+#endif
+#endif
+
+    return depth;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Sort lines of text like sort(1) does.
+ *
+ * @param text text to sort, may contain null bytes
+ * @param len length of text
+ * @param options options of sort(1) separated by whitespace
+ *
+ * @return sorted lines, each one followed by newline; NULL if options are not supported
+ */
+
+GString *
+edit_sort_text (const char *text, gsize len, const char *options)
+{
+    edit_sort_t sort;
+    edit_sort_job_t job;
+    GArray *lines;
+    GString *result;
+    gsize i, n, start;
+
+    sort.keys = g_array_new (FALSE, FALSE, sizeof (edit_sort_key_t));
+    sort.flags = 0;
+    sort.separator = -1;
+    sort.stable = FALSE;
+    sort.unique = FALSE;
+
+    if (!edit_sort_parse_options (&sort, options))
+    {
+        g_array_free (sort.keys, TRUE);
+        return NULL;
+    }
+
+    lines = g_array_new (FALSE, FALSE, sizeof (edit_sort_line_t));
+
+    for (start = 0; start < len; start = i + 1)
+    {
+        const char *nl;
+        edit_sort_line_t line;
+
+        nl = memchr (text + start, '\n', len - start);
+        i = nl == NULL ? len : (gsize) (nl - text);
+
+        line.str = text + start;
+        line.len = i - start;
+        g_array_append_val (lines, line);
+    }
+
+    n = lines->len;
+
+    job.sort = &sort;
+    job.lines = (edit_sort_line_t *) lines->data;
+    job.tmp = g_new (edit_sort_line_t, n);
+    job.n = n;
+    job.depth = edit_sort_get_thread_depth ();
+    edit_sort_lines (&job);
+    g_free (job.tmp);
+
+    if (sort.unique && n != 0)
+    {
+        for (i = 1, n = 1; i < lines->len; i++)
+            if (edit_sort_compare (&sort, &job.lines[n - 1], &job.lines[i], FALSE) != 0)
+                job.lines[n++] = job.lines[i];
+    }
+
+    result = g_string_sized_new (len + 1);
+
+    for (i = 0; i < n; i++)
+    {
+        g_string_append_len (result, job.lines[i].str, job.lines[i].len);
+        g_string_append_c (result, '\n');
+    }
+
+    g_array_free (lines, TRUE);
+    g_array_free (sort.keys, TRUE);
+
+    return result;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,22 @@
+/** \file
+ *  \brief Header: sorting of lines of text for the Sort command of editor
+ */
+
+#ifndef MC__EDIT_SORT_H
+#define MC__EDIT_SORT_H
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+GString *edit_sort_text (const char *text, gsize len, const char *options);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_SORT_H */
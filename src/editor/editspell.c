@@ -0,0 +1,359 @@
+/*
+   Misspelled words of editor buffer found in background.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: misspelled words of editor buffer found in background.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <ctype.h>
+
+#include "lib/global.h"
+
+#include "edit-impl.h"
+#include "editspell.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * Words are maximal runs of bytes other than break characters, the same as for the spell check
+ * of the word under cursor. Text is checked from the start of buffer in parts, the checked part
+ * grows until it covers the whole buffer. Misspelled words are kept as markers, so changes of
+ * text move them in logarithmic time.
+ *
+ * A change of text forgets the misspelled words touching it. If the change is in the checked
+ * part, the changed range is remembered to be checked again before the rest of buffer. Ranges of
+ * several changes are joined into one, edits are usually close to each other.
+ *
+ * Words longer than EDIT_SPELL_WORD_MAX bytes and words with digits are not checked.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/*** file scope type declarations ****************************************************************/
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_spell_is_word_byte (const edit_buffer_t * buf, off_t offset)
+{
+    return !is_break_char ((char) edit_buffer_get_byte (buf, offset));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Move offset after a change of text.
+ *
+ * @return new offset, the offset of change if the offset was in the removed text
+ */
+
+static off_t
+edit_spell_move (off_t pos, off_t offset, off_t deleted, off_t inserted)
+{
+    if (pos > offset + deleted)
+        return pos + inserted - deleted;
+
+    return MIN (pos, offset);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check words in a range of text. Misspelled words found in the range before are replaced.
+ *
+ * @param spell misspelled words
+ * @param buf editor buffer
+ * @param start offset of range, moved to the start of word if it's inside of word
+ * @param finish offset after range, moved to the end of word
+ * @param check function to check words
+ *
+ * @return offset after the last checked word
+ */
+
+static off_t
+edit_spell_check_range (edit_spell_t * spell, const edit_buffer_t * buf, off_t start,
+                        off_t finish, edit_spell_check_fn check)
+{
+    GString *word;
+    guint i;
+    off_t p;
+
+    if (edit_spell_is_word_byte (buf, start))
+        while (start > 0 && edit_spell_is_word_byte (buf, start - 1))
+            start--;
+    while (finish < buf->size && edit_spell_is_word_byte (buf, finish))
+        finish++;
+
+    i = edit_markers_find (&spell->words, start);
+    while (i < edit_markers_count (&spell->words)
+           && edit_markers_get_pos (&spell->words, i) < finish)
+    {
+        edit_markers_remove (&spell->words, i);
+        spell->generation++;
+    }
+
+    word = g_string_sized_new (EDIT_SPELL_WORD_MAX);
+
+    for (p = start; p < finish;)
+    {
+        off_t word_start;
+        gboolean digits = FALSE;
+
+        while (p < finish && !edit_spell_is_word_byte (buf, p))
+            p++;
+
+        g_string_truncate (word, 0);
+
+        for (word_start = p; p < finish && edit_spell_is_word_byte (buf, p); p++)
+            if (p - word_start < EDIT_SPELL_WORD_MAX)
+            {
+                int c;
+
+                c = edit_buffer_get_byte (buf, p);
+                digits = digits || isdigit (c);
+                g_string_append_c (word, (char) c);
+            }
+
+        if (p != word_start && p - word_start <= EDIT_SPELL_WORD_MAX && !digits
+            && !check (word->str, word->len))
+        {
+            edit_markers_insert (&spell->words, word_start, (int) (p - word_start));
+            spell->generation++;
+        }
+    }
+
+    g_string_free (word, TRUE);
+
+    return finish;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_spell_init (edit_spell_t * spell)
+{
+    edit_markers_init (&spell->words);
+    spell->checked = 0;
+    spell->dirty_start = -1;
+    spell->dirty_finish = -1;
+    spell->generation = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_spell_clean (edit_spell_t * spell)
+{
+    edit_markers_clean (&spell->words);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Forget all results to check the whole buffer again, e.g. after change of dictionary.
+ *
+ * @param spell misspelled words
+ */
+
+void
+edit_spell_reset (edit_spell_t * spell)
+{
+    unsigned long generation = spell->generation;
+
+    edit_spell_clean (spell);
+    edit_spell_init (spell);
+    spell->generation = generation + 1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update misspelled words when the text is changed.
+ *
+ * @param spell misspelled words
+ * @param offset offset of the change
+ * @param deleted number of bytes removed at the offset
+ * @param inserted number of bytes inserted at the offset
+ */
+
+void
+edit_spell_update (edit_spell_t * spell, off_t offset, off_t deleted, off_t inserted)
+{
+    off_t start = offset;
+    guint i;
+
+    /* forget words touching the change, a word may be joined with the new text */
+    i = edit_markers_find (&spell->words, offset);
+    if (i != 0 && edit_markers_get_pos (&spell->words, i - 1)
+        + edit_markers_get_value (&spell->words, i - 1) >= offset)
+    {
+        i--;
+        start = edit_markers_get_pos (&spell->words, i);
+    }
+    while (i < edit_markers_count (&spell->words)
+           && edit_markers_get_pos (&spell->words, i) <= offset + deleted)
+    {
+        edit_markers_remove (&spell->words, i);
+        spell->generation++;
+    }
+
+    edit_markers_shift (&spell->words, offset, inserted - deleted);
+
+    /* a word before the change may end at it */
+    if (start > 0)
+        start--;
+
+    spell->checked = edit_spell_move (spell->checked, offset, deleted, inserted);
+
+    if (spell->dirty_start >= 0)
+    {
+        spell->dirty_start = edit_spell_move (spell->dirty_start, offset, deleted, inserted);
+        spell->dirty_finish = edit_spell_move (spell->dirty_finish, offset, deleted, inserted);
+    }
+
+    /* text after the checked part will be checked anyway */
+    if (start >= spell->checked)
+        return;
+
+    if (spell->dirty_start < 0)
+    {
+        spell->dirty_start = start;
+        spell->dirty_finish = offset + inserted;
+    }
+    else
+    {
+        spell->dirty_start = MIN (spell->dirty_start, start);
+        spell->dirty_finish = MAX (spell->dirty_finish, offset + inserted);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check if there is text to check.
+ *
+ * @param spell misspelled words
+ * @param buf editor buffer
+ *
+ * @return TRUE if some text is changed or not checked yet
+ */
+
+gboolean
+edit_spell_pending (const edit_spell_t * spell, const edit_buffer_t * buf)
+{
+    return (spell->dirty_start >= 0 || spell->checked < buf->size);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check the next part of text: changed text first, then text after the checked part.
+ *
+ * @param spell misspelled words
+ * @param buf editor buffer
+ * @param len number of bytes to check, the last word is always checked up to its end
+ * @param check function to check words
+ *
+ * @return TRUE if there is more text to check
+ */
+
+gboolean
+edit_spell_scan (edit_spell_t * spell, const edit_buffer_t * buf, off_t len,
+                 edit_spell_check_fn check)
+{
+    off_t finish;
+
+    if (spell->dirty_start >= 0)
+    {
+        finish = MIN (spell->dirty_finish, spell->dirty_start + len);
+        finish = edit_spell_check_range (spell, buf, spell->dirty_start, finish, check);
+
+        if (finish < spell->dirty_finish)
+            spell->dirty_start = finish;
+        else
+            spell->dirty_start = spell->dirty_finish = -1;
+
+        spell->checked = MAX (spell->checked, finish);
+    }
+    else if (spell->checked < buf->size)
+    {
+        finish = MIN (buf->size, spell->checked + len);
+        spell->checked = edit_spell_check_range (spell, buf, spell->checked, finish, check);
+    }
+
+    return edit_spell_pending (spell, buf);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check if all words in range are checked and the results are actual.
+ *
+ * @param spell misspelled words
+ * @param start offset of range
+ * @param finish offset after range
+ *
+ * @return TRUE if the range is checked
+ */
+
+gboolean
+edit_spell_is_checked (const edit_spell_t * spell, off_t start, off_t finish)
+{
+    return (finish <= spell->checked
+            && (spell->dirty_start < 0 || spell->dirty_finish < start
+                || spell->dirty_start > finish));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find misspelled word at or after position.
+ *
+ * @param spell misspelled words
+ * @param pos position
+ * @param start where to store offset of the word
+ * @param finish where to store offset after the word
+ *
+ * @return FALSE if there are no misspelled words ending after the position
+ */
+
+gboolean
+edit_spell_get_word (const edit_spell_t * spell, off_t pos, off_t * start, off_t * finish)
+{
+    guint i;
+
+    i = edit_markers_find (&spell->words, pos);
+    if (i != 0 && edit_markers_get_pos (&spell->words, i - 1)
+        + edit_markers_get_value (&spell->words, i - 1) > pos)
+        i--;
+
+    if (i >= edit_markers_count (&spell->words))
+        return FALSE;
+
+    *start = edit_markers_get_pos (&spell->words, i);
+    *finish = *start + edit_markers_get_value (&spell->words, i);
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
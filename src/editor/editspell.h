@@ -0,0 +1,51 @@
+/** \file
+ *  \brief Header: misspelled words of editor buffer found in background
+ */
+
+#ifndef MC__EDIT_SPELL_H
+#define MC__EDIT_SPELL_H
+
+#include "editbuffer.h"
+#include "editmarker.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/* longest word to be checked, in bytes */
+#define EDIT_SPELL_WORD_MAX 64
+
+/* check word: word is a null-terminated string of len bytes, return FALSE if it's misspelled */
+typedef gboolean (*edit_spell_check_fn) (const char *word, gsize len);
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_spell_struct
+{
+    edit_markers_t words;       /* misspelled words: marker at the start, length as value */
+    off_t checked;              /* text before this offset is checked */
+    off_t dirty_start;          /* changed text to be checked again, -1 if none */
+    off_t dirty_finish;
+    unsigned long generation;   /* incremented on each change of set of misspelled words */
+} edit_spell_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_spell_init (edit_spell_t * spell);
+void edit_spell_clean (edit_spell_t * spell);
+void edit_spell_reset (edit_spell_t * spell);
+
+void edit_spell_update (edit_spell_t * spell, off_t offset, off_t deleted, off_t inserted);
+gboolean edit_spell_pending (const edit_spell_t * spell, const edit_buffer_t * buf);
+gboolean edit_spell_scan (edit_spell_t * spell, const edit_buffer_t * buf, off_t len,
+                          edit_spell_check_fn check);
+
+gboolean edit_spell_is_checked (const edit_spell_t * spell, off_t start, off_t finish);
+gboolean edit_spell_get_word (const edit_spell_t * spell, off_t pos, off_t * start,
+                              off_t * finish);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_SPELL_H */
@@ -0,0 +1,758 @@
+/*
+   Editor undo and redo journal.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: editor undo and redo journal.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "lib/global.h"
+
+#include "edit-impl.h"
+#include "editundo.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * The journal is a stack of records. Each record is a run:
+ *
+ *   - of identical actions (CURS_LEFT x 100, BACKSPACE x 5, ...) with a counter;
+ *   - of byte insertions (codes 0...255) or byte insertions ahead (codes 256...511)
+ *     with the bytes themselves as payload, so deleting a block of N bytes costs
+ *     about N bytes of the journal instead of N records.
+ *
+ * Opposite cursor movements cancel each other out. Marks, column highlighting and
+ * key presses only set a state, so their repetitions are not stored.
+ *
+ * Actions are grouped by key presses: a group starts with a KEY_PRESS record and
+ * holds all actions done on that key press. When the journal grows over its memory
+ * cap, the oldest groups are dropped as a whole until a quarter of the cap is free.
+ * If the group being recorded doesn't fit by itself, it is dropped too and the rest
+ * of its actions are discarded, so it is never undone partially.
+ *
+ * The journal can be saved to a log file and restored from it. The log is a sequence
+ * of records, each one is the payload (for runs of bytes) followed by action code and
+ * counter. The trailer at the end of the log identifies the edited file. The restored log
+ * is mapped into memory and its records are read back from the end one by one, when they
+ * are undone, so only the records above the log are kept in memory. The oldest groups are
+ * in the log, so if the journal grows over its cap, the whole log is dropped first.
+ * When the log is saved again and no records were read back from it, new records are
+ * appended to it.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/* initial allocation of the payload of byte run */
+#define UNDO_TEXT_SIZE 16
+
+/* max payload of a record in the log: a record is read from the log at once */
+#define UNDO_LOG_CHUNK_SIZE (64 * 1024)
+
+#define UNDO_LOG_MAGIC "MCUNDO1"
+
+/*** file scope type declarations ****************************************************************/
+
+/* record of the log, written after the payload */
+typedef struct
+{
+    gint64 action;
+    gint64 count;
+} edit_undo_log_record_t;
+
+/* end of the log */
+typedef struct
+{
+    guint64 length;             /* length of records */
+    guint64 file_size;          /* size of the edited file */
+    gint64 file_mtime;          /* modification time of the edited file */
+    guint64 cursor;             /* cursor position the records are relative to */
+    char magic[8];
+} edit_undo_log_trailer_t;
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_undo_is_text (long action)
+{
+    return (action >= 0 && action < 512);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_undo_unmap (edit_undo_t * undo)
+{
+#ifdef HAVE_MMAP
+    if (undo->log != NULL)
+        munmap (undo->log, undo->log_size);
+#endif
+    undo->log = NULL;
+    undo->log_size = 0;
+    undo->log_length = 0;
+    undo->log_len = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Move the last record of the log to memory.
+ *
+ * @return FALSE if there are no more records in the log
+ */
+
+static gboolean
+edit_undo_log_read (edit_undo_t * undo)
+{
+    edit_undo_log_record_t lr;
+    edit_undo_record_t rec;
+
+    if (undo->log == NULL)
+        return FALSE;
+
+    if (undo->log_len < sizeof (lr))
+    {
+        edit_undo_unmap (undo);
+        return FALSE;
+    }
+
+    memcpy (&lr, undo->log + undo->log_len - sizeof (lr), sizeof (lr));
+    undo->log_len -= sizeof (lr);
+
+    rec.action = (long) lr.action;
+
+    /* broken log: drop the rest of it */
+    if (lr.count <= 0 || (edit_undo_is_text (rec.action) && (guint64) lr.count > undo->log_len))
+    {
+        edit_undo_unmap (undo);
+        return FALSE;
+    }
+
+    if (edit_undo_is_text (rec.action))
+    {
+        undo->log_len -= (size_t) lr.count;
+        rec.u.text = g_string_new_len (undo->log + undo->log_len, (gssize) lr.count);
+        undo->size += rec.u.text->allocated_len;
+    }
+    else
+        rec.u.count = (off_t) lr.count;
+
+    g_array_append_val (undo->records, rec);
+    undo->size += sizeof (rec);
+
+    if (undo->log_len == 0)
+        edit_undo_unmap (undo);
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/**
+ * Get the last record kept in memory.
+ */
+
+static inline edit_undo_record_t *
+edit_undo_get_last (const edit_undo_t * undo)
+{
+    if (undo->records->len == 0)
+        return NULL;
+
+    return &g_array_index (undo->records, edit_undo_record_t, undo->records->len - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get the last record, read it back from the log if needed.
+ */
+
+static inline edit_undo_record_t *
+edit_undo_get_top (edit_undo_t * undo)
+{
+    if (undo->records->len == 0 && !edit_undo_log_read (undo))
+        return NULL;
+
+    return edit_undo_get_last (undo);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_undo_free_record (edit_undo_t * undo, edit_undo_record_t * rec)
+{
+    if (edit_undo_is_text (rec->action))
+    {
+        undo->size -= rec->u.text->allocated_len;
+        g_string_free (rec->u.text, TRUE);
+    }
+
+    undo->size -= sizeof (*rec);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_undo_remove_top (edit_undo_t * undo)
+{
+    edit_undo_free_record (undo, edit_undo_get_last (undo));
+    g_array_set_size (undo->records, undo->records->len - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_undo_record_t *
+edit_undo_append (edit_undo_t * undo, long action)
+{
+    edit_undo_record_t rec;
+
+    rec.action = action;
+    if (edit_undo_is_text (action))
+    {
+        rec.u.text = g_string_sized_new (UNDO_TEXT_SIZE);
+        undo->size += rec.u.text->allocated_len;
+    }
+    else
+        rec.u.count = 0;
+
+    g_array_append_val (undo->records, rec);
+    undo->size += sizeof (rec);
+
+    return edit_undo_get_last (undo);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Drop the oldest groups of actions to fit the journal into its memory cap.
+ */
+
+static void
+edit_undo_evict (edit_undo_t * undo)
+{
+    edit_undo_record_t *rec;
+    gsize target;
+    guint n = 0;
+
+    /* the log holds the oldest groups */
+    edit_undo_unmap (undo);
+
+    if (undo->records->len == 0)
+        return;
+
+    rec = (edit_undo_record_t *) undo->records->data;
+    target = undo->limit - undo->limit / 4;
+
+    do
+        edit_undo_free_record (undo, &rec[n++]);
+    while (n < undo->records->len && (undo->size > target || rec[n].action < KEY_PRESS));
+
+    /* the group being recorded is lost: don't keep the rest of it */
+    if (n == undo->records->len)
+        undo->overflow = TRUE;
+
+    g_array_remove_range (undo->records, 0, n);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Write records kept in memory to the log.
+ *
+ * @return TRUE on success
+ */
+
+static gboolean
+edit_undo_log_write (const edit_undo_t * undo, FILE * f)
+{
+    guint i;
+
+    for (i = 0; i < undo->records->len; i++)
+    {
+        const edit_undo_record_t *rec;
+        edit_undo_log_record_t lr;
+
+        rec = &g_array_index (undo->records, edit_undo_record_t, i);
+        lr.action = rec->action;
+
+        if (!edit_undo_is_text (rec->action))
+        {
+            lr.count = rec->u.count;
+            if (fwrite (&lr, sizeof (lr), 1, f) != 1)
+                return FALSE;
+        }
+        else
+        {
+            gsize j;
+
+            /* split long runs of bytes: a record is read back at once */
+            for (j = 0; j < rec->u.text->len; j += (gsize) lr.count)
+            {
+                lr.count = MIN (rec->u.text->len - j, UNDO_LOG_CHUNK_SIZE);
+                if (fwrite (rec->u.text->str + j, (size_t) lr.count, 1, f) != 1
+                    || fwrite (&lr, sizeof (lr), 1, f) != 1)
+                    return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Open the log the journal was restored from to append new records to it.
+ *
+ * @return log file positioned at the trailer, NULL if the log was changed since it was restored
+ */
+
+static FILE *
+edit_undo_log_open_append (const edit_undo_t * undo, const char *path)
+{
+    edit_undo_log_trailer_t t;
+    FILE *f;
+
+    f = fopen (path, "r+b");
+    if (f == NULL)
+        return NULL;
+
+    if (fseeko (f, -(off_t) sizeof (t), SEEK_END) != 0 || fread (&t, sizeof (t), 1, f) != 1
+        || memcmp (&t, undo->log + undo->log_length, sizeof (t)) != 0
+        || fseeko (f, (off_t) undo->log_length, SEEK_SET) != 0)
+    {
+        fclose (f);
+        return NULL;
+    }
+
+    return f;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Initialize undo journal.
+ *
+ * @param undo undo journal
+ * @param limit memory cap of the journal in bytes, 0 for unlimited journal
+ */
+
+void
+edit_undo_init (edit_undo_t * undo, gsize limit)
+{
+    undo->records = g_array_new (FALSE, FALSE, sizeof (edit_undo_record_t));
+    undo->size = 0;
+    undo->limit = limit;
+    undo->overflow = FALSE;
+    undo->log = NULL;
+    undo->log_size = 0;
+    undo->log_length = 0;
+    undo->log_len = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Clean undo journal. Free all used memory.
+ *
+ * @param undo undo journal
+ */
+
+void
+edit_undo_clean (edit_undo_t * undo)
+{
+    if (undo->records != NULL)
+    {
+        edit_undo_reset (undo);
+        g_array_free (undo->records, TRUE);
+        undo->records = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove all records from undo journal.
+ *
+ * @param undo undo journal
+ */
+
+void
+edit_undo_reset (edit_undo_t * undo)
+{
+    while (undo->records->len != 0)
+        edit_undo_remove_top (undo);
+
+    edit_undo_unmap (undo);
+    undo->overflow = FALSE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Record an action several times.
+ *
+ * @param undo undo journal
+ * @param c code of the action, see edit_push_undo_action()
+ * @param count number of repetitions
+ */
+
+void
+edit_undo_push (edit_undo_t * undo, long c, off_t count)
+{
+    edit_undo_record_t *top;
+
+    if (count <= 0)
+        return;
+
+    if (undo->overflow)
+    {
+        if (c < KEY_PRESS)
+            return;
+
+        undo->overflow = FALSE;
+    }
+
+    /* records in the log are not merged with new ones to keep the log intact */
+    top = edit_undo_get_last (undo);
+
+    if (edit_undo_is_text (c))
+    {
+        const long action = c & ~255L;
+        gsize allocated;
+
+        if (top == NULL || top->action != action)
+            top = edit_undo_append (undo, action);
+
+        allocated = top->u.text->allocated_len;
+        for (; count > 0; count--)
+            g_string_append_c (top->u.text, (char) (c & 255));
+        undo->size += top->u.text->allocated_len - allocated;
+    }
+    else if (top != NULL && top->action == c)
+    {
+        /* states are set once */
+        if (c < MARK_1 && c != COLUMN_ON && c != COLUMN_OFF)
+            top->u.count += count;
+    }
+    else if (top != NULL && ((c == CURS_LEFT && top->action == CURS_RIGHT)
+                             || (c == CURS_RIGHT && top->action == CURS_LEFT)))
+    {
+        top->u.count -= count;
+
+        if (top->u.count == 0)
+            edit_undo_remove_top (undo);
+        else if (top->u.count < 0)
+        {
+            top->action = c;
+            top->u.count = -top->u.count;
+        }
+    }
+    else
+    {
+        top = edit_undo_append (undo, c);
+        top->u.count = count;
+    }
+
+    if (undo->limit != 0 && undo->size > undo->limit)
+        edit_undo_evict (undo);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Record insertions of bytes at once, as if they were pushed one by one.
+ *
+ * @param undo undo journal
+ * @param action 0 for edit_insert() or 256 for edit_insert_ahead()
+ * @param text bytes in the order they are pushed
+ * @param len number of bytes
+ */
+
+void
+edit_undo_push_text (edit_undo_t * undo, long action, const char *text, gsize len)
+{
+    edit_undo_record_t *top;
+    gsize allocated;
+
+    /* byte insertions don't start a new group */
+    if (len == 0 || undo->overflow)
+        return;
+
+    top = edit_undo_get_last (undo);
+    if (top == NULL || top->action != action)
+        top = edit_undo_append (undo, action);
+
+    allocated = top->u.text->allocated_len;
+    g_string_append_len (top->u.text, text, len);
+    undo->size += top->u.text->allocated_len - allocated;
+
+    if (undo->limit != 0 && undo->size > undo->limit)
+        edit_undo_evict (undo);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get the last recorded action.
+ *
+ * @param undo undo journal
+ *
+ * @return code of the action, STACK_BOTTOM if journal is empty
+ */
+
+long
+edit_undo_peek (edit_undo_t * undo)
+{
+    const edit_undo_record_t *top;
+
+    top = edit_undo_get_top (undo);
+    if (top == NULL)
+        return STACK_BOTTOM;
+
+    if (edit_undo_is_text (top->action))
+        return top->action + (unsigned char) top->u.text->str[top->u.text->len - 1];
+
+    return top->action;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove the last recorded action.
+ *
+ * @param undo undo journal
+ *
+ * @return code of the action, STACK_BOTTOM if journal is empty
+ */
+
+long
+edit_undo_pop (edit_undo_t * undo)
+{
+    edit_undo_record_t *top;
+    long c;
+
+    c = edit_undo_peek (undo);
+    if (c == STACK_BOTTOM)
+        return c;
+
+    top = edit_undo_get_top (undo);
+
+    if (edit_undo_is_text (top->action))
+    {
+        g_string_truncate (top->u.text, top->u.text->len - 1);
+        if (top->u.text->len == 0)
+            edit_undo_remove_top (undo);
+    }
+    else if (--top->u.count == 0)
+        edit_undo_remove_top (undo);
+
+    return c;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remove the rest of the run of the specified action.
+ *
+ * Opposite cursor movements are merged in the journal, so the cursor can be moved
+ * at once by the returned number of steps.
+ *
+ * @param undo undo journal
+ * @param c code of the action just returned by edit_undo_pop()
+ *
+ * @return number of removed actions
+ */
+
+off_t
+edit_undo_pop_run (edit_undo_t * undo, long c)
+{
+    edit_undo_record_t *top;
+    off_t count;
+
+    top = edit_undo_get_top (undo);
+    if (top == NULL || top->action != c || edit_undo_is_text (c))
+        return 0;
+
+    count = top->u.count;
+    edit_undo_remove_top (undo);
+
+    return count;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Restore undo journal from the log saved by edit_undo_save().
+ *
+ * The log is mapped into memory. It is not loaded, its records are read back when needed.
+ *
+ * @param undo undo journal
+ * @param path path to the log
+ * @param file_size size of the edited file
+ * @param file_mtime modification time of the edited file
+ * @param cursor cursor position the restored records are relative to
+ *
+ * @return TRUE if log was restored, FALSE if there is no log or it was saved for other file
+ */
+
+gboolean
+edit_undo_load (edit_undo_t * undo, const char *path, off_t file_size, time_t file_mtime,
+                off_t * cursor)
+{
+#ifdef HAVE_MMAP
+    int fd;
+    struct stat st;
+    char *map;
+    edit_undo_log_trailer_t t;
+
+    fd = open (path, O_RDONLY | O_BINARY);
+    if (fd < 0)
+        return FALSE;
+
+    if (fstat (fd, &st) != 0 || st.st_size <= (off_t) sizeof (t)
+        || (off_t) (size_t) st.st_size != st.st_size)
+    {
+        close (fd);
+        return FALSE;
+    }
+
+    map = mmap (0, (size_t) st.st_size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+    /* mapping remains valid after file is closed */
+    close (fd);
+    if (map == (char *) -1)
+        return FALSE;
+
+    memcpy (&t, map + st.st_size - sizeof (t), sizeof (t));
+
+    if (memcmp (t.magic, UNDO_LOG_MAGIC, sizeof (t.magic)) != 0
+        || t.length != (guint64) st.st_size - sizeof (t) || t.file_size != (guint64) file_size
+        || t.file_mtime != (gint64) file_mtime || t.cursor > t.file_size)
+    {
+        munmap (map, (size_t) st.st_size);
+        return FALSE;
+    }
+
+    edit_undo_reset (undo);
+
+    undo->log = map;
+    undo->log_size = (size_t) st.st_size;
+    undo->log_length = (size_t) t.length;
+    undo->log_len = undo->log_length;
+
+    *cursor = (off_t) t.cursor;
+
+    return TRUE;
+#else
+    (void) undo;
+    (void) path;
+    (void) file_size;
+    (void) file_mtime;
+    (void) cursor;
+
+    return FALSE;
+#endif /* HAVE_MMAP */
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Save undo journal to the log.
+ *
+ * If the journal was restored from this log and none of its records were read back,
+ * new records are appended to the log. Otherwise the log is rewritten. Empty journal
+ * removes the log.
+ *
+ * @param undo undo journal
+ * @param path path to the log
+ * @param file_size size of the edited file
+ * @param file_mtime modification time of the edited file
+ * @param cursor cursor position the last record is relative to
+ *
+ * @return TRUE on success
+ */
+
+gboolean
+edit_undo_save (edit_undo_t * undo, const char *path, off_t file_size, time_t file_mtime,
+                off_t cursor)
+{
+    FILE *f = NULL;
+    char *tmp_path = NULL;
+    gboolean ret = TRUE;
+
+    if (undo->records->len == 0 && undo->log == NULL)
+        return (unlink (path) == 0 || errno == ENOENT);
+
+    if (undo->log != NULL && undo->log_len == undo->log_length)
+        f = edit_undo_log_open_append (undo, path);
+
+    if (f == NULL)
+    {
+        tmp_path = g_strconcat (path, ".tmp", (char *) NULL);
+        f = fopen (tmp_path, "wb");
+        if (f == NULL)
+        {
+            g_free (tmp_path);
+            return FALSE;
+        }
+
+        /* records not read back from the old log */
+        if (undo->log_len != 0)
+            ret = fwrite (undo->log, undo->log_len, 1, f) == 1;
+    }
+
+    ret = ret && edit_undo_log_write (undo, f);
+    if (ret)
+    {
+        edit_undo_log_trailer_t t;
+        off_t length;
+
+        length = ftello (f);
+
+        memset (&t, 0, sizeof (t));
+        t.length = (guint64) length;
+        t.file_size = (guint64) file_size;
+        t.file_mtime = (gint64) file_mtime;
+        t.cursor = (guint64) cursor;
+        memcpy (t.magic, UNDO_LOG_MAGIC, sizeof (t.magic));
+
+        ret = length >= 0 && fwrite (&t, sizeof (t), 1, f) == 1;
+    }
+
+    ret = fclose (f) == 0 && ret;
+
+    if (tmp_path != NULL)
+    {
+        ret = ret && rename (tmp_path, path) == 0;
+        if (!ret)
+            unlink (tmp_path);
+        g_free (tmp_path);
+    }
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,58 @@
+/** \file
+ *  \brief Header: undo and redo journal for WEdit
+ */
+
+#ifndef MC__EDIT_UNDO_H
+#define MC__EDIT_UNDO_H
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+/* run of identical actions or, for byte insertions, run of bytes to be inserted */
+typedef struct edit_undo_record_struct
+{
+    long action;                /* action code, or 0/256 for runs of edit_insert/edit_insert_ahead */
+    union
+    {
+        off_t count;            /* number of repetitions of the action */
+        GString *text;          /* bytes to be inserted, in the order they were recorded */
+    } u;
+} edit_undo_record_t;
+
+typedef struct edit_undo_struct
+{
+    GArray *records;            /* records, the oldest first */
+    gsize size;                 /* memory used by records and their payload, in bytes */
+    gsize limit;                /* memory cap, 0 if unlimited */
+    gboolean overflow;          /* if TRUE, actions are discarded until the next key press */
+    char *log;                  /* mapping of the persistent log holding the oldest records */
+    size_t log_size;            /* size of the mapping */
+    size_t log_length;          /* length of records in the log */
+    size_t log_len;             /* length of records in the log not read back yet */
+} edit_undo_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_undo_init (edit_undo_t * undo, gsize limit);
+void edit_undo_clean (edit_undo_t * undo);
+void edit_undo_reset (edit_undo_t * undo);
+
+void edit_undo_push (edit_undo_t * undo, long c, off_t count);
+void edit_undo_push_text (edit_undo_t * undo, long action, const char *text, gsize len);
+long edit_undo_peek (edit_undo_t * undo);
+long edit_undo_pop (edit_undo_t * undo);
+off_t edit_undo_pop_run (edit_undo_t * undo, long c);
+
+gboolean edit_undo_load (edit_undo_t * undo, const char *path, off_t file_size, time_t file_mtime,
+                         off_t * cursor);
+gboolean edit_undo_save (edit_undo_t * undo, const char *path, off_t file_size, time_t file_mtime,
+                         off_t cursor);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_UNDO_H */
@@ -79,6 +79,15 @@ char *edit_window_close_char = NULL;
 #define WINDOW_MIN_LINES (2 + 2)
 #define WINDOW_MIN_COLS (2 + LINE_STATE_WIDTH + 2)
 
+/* number of bytes of mapped file to count lines in per idle cycle */
+#define COUNT_LINES_IDLE_CHUNK (8 * 1024 * 1024)
+
+/* number of bytes to parse for syntax highlighting per idle cycle */
+#define SYNTAX_PRESCAN_IDLE_CHUNK (64 * 1024)
+
+/* number of bytes to check spelling in per idle cycle */
+#define SPELL_PRESCAN_IDLE_CHUNK (16 * 1024)
+
 /*** file scope type declarations ****************************************************************/
 
 /*** file scope variables ************************************************************************/
@@ -265,6 +274,7 @@ edit_dlg_deinit (void)
     {
         g_free (edit_window_state_char);
         g_free (edit_window_close_char);
+        etags_clean ();
 
 #ifdef HAVE_ASPELL
         aspell_clean ();
@@ -1206,6 +1216,22 @@ edit_dialog_bg_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm
     }
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check if there is work to do when the editor is idle after the file is loaded.
+ */
+
+static gboolean
+edit_prescan_pending (const WEdit * edit)
+{
+#ifdef HAVE_ASPELL
+    if (edit_spellcheck_prescan_pending (edit))
+        return TRUE;
+#endif
+
+    return edit_syntax_prescan_pending (edit);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 static cb_ret_t
@@ -1217,6 +1243,10 @@ edit_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *da
     {
     case MSG_FOCUS:
         edit_set_buttonbar (e, find_buttonbar (DIALOG (w->owner)));
+        /* continue counting lines of mapped file, loading file, parsing its syntax or checking
+           its spelling */
+        if (edit_buffer_lines_pending (&e->buffer) || edit_prescan_pending (e))
+            widget_idle (WIDGET (w->owner), TRUE);
         return MSG_HANDLED;
 
     case MSG_DRAW:
@@ -1242,6 +1272,12 @@ edit_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *da
                 ret = MSG_HANDLED;
             }
 
+            edit_check_mapped_file (e);
+
+            /* verify syntax checkpoints and spelling after changes when the user pauses */
+            if (edit_prescan_pending (e))
+                widget_idle (WIDGET (w->owner), TRUE);
+
             return ret;
         }
 
@@ -1249,6 +1285,9 @@ edit_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *da
         /* command from menubar or buttonbar */
         edit_execute_key_command (e, parm, -1);
         edit_update_screen (e);
+        edit_check_mapped_file (e);
+        if (edit_prescan_pending (e))
+            widget_idle (WIDGET (w->owner), TRUE);
         return MSG_HANDLED;
 
     case MSG_CURSOR:
@@ -1264,6 +1303,33 @@ edit_callback (Widget * w, Widget * sender, widget_msg_t msg, int parm, void *da
         }
 
     case MSG_IDLE:
+        if (edit_buffer_loading_pending (&e->buffer))
+        {
+            /* continue loading file and show its part loaded so far */
+            if (edit_load_file_part (e) && edit_buffer_loading_pending (&e->buffer))
+                widget_idle (WIDGET (w->owner), TRUE);
+        }
+        else if (edit_buffer_lines_pending (&e->buffer))
+        {
+            if (edit_buffer_count_mapped_lines (&e->buffer, COUNT_LINES_IDLE_CHUNK))
+                widget_idle (WIDGET (w->owner), TRUE);
+            else
+                e->force |= REDRAW_PAGE;
+        }
+        else
+        {
+            /* a step of each one per idle cycle, spelling doesn't wait for the whole syntax */
+            edit_syntax_prescan (e, SYNTAX_PRESCAN_IDLE_CHUNK);
+#ifdef HAVE_ASPELL
+            edit_spellcheck_prescan (e, SPELL_PRESCAN_IDLE_CHUNK);
+#endif
+        }
+        /* counting lines reads the whole mapped file, so truncation of it is likely found here */
+        edit_check_mapped_file (e);
+        /* parse syntax and check spelling of the whole file after it is loaded and its lines
+           are counted */
+        if (edit_prescan_pending (e))
+            widget_idle (WIDGET (w->owner), TRUE);
         edit_update_screen (e);
         return MSG_HANDLED;
 
@@ -1536,6 +1602,10 @@ edit_files (const GList * files)
         dir = mc_build_filename (mc_config_get_data_path (), EDIT_HOME_DIR, (char *) NULL);
         made_directory = (mkdir (dir, 0700) != -1 || errno == EEXIST);
         g_free (dir);
+
+        dir = mc_build_filename (mc_config_get_data_path (), EDIT_HOME_UNDO_DIR, (char *) NULL);
+        made_directory = (mkdir (dir, 0700) != -1 || errno == EEXIST);
+        g_free (dir);
     }
 
     /* Create a new dialog and add it widgets to it */
@@ -9,7 +9,13 @@
 #include "lib/widget.h"         /* Widget */
 
 #include "edit-impl.h"
+#include "editbracket.h"
 #include "editbuffer.h"
+#include "editcolumn.h"
+#include "editmarker.h"
+#include "editspell.h"
+#include "editundo.h"
+#include "editwords.h"
 
 /*** typedefs(not structures) and defined constants **********************************************/
 
@@ -29,15 +35,6 @@ typedef enum
 
 /*** structures declarations (and typedefs of structures)*****************************************/
 
-typedef struct edit_book_mark_t edit_book_mark_t;
-struct edit_book_mark_t
-{
-    long line;                  /* line number */
-    int c;                      /* color */
-    edit_book_mark_t *next;
-    edit_book_mark_t *prev;
-};
-
 typedef struct edit_syntax_rule_t edit_syntax_rule_t;
 struct edit_syntax_rule_t
 {
@@ -104,6 +101,8 @@ struct WEdit
     long curs_col;              /* column position on screen */
     long over_col;              /* pos after '\n' */
     int force;                  /* how much of the screen do we redraw? */
+    GPtrArray *draw_rows;       /* rows of text rendered recently, see editdraw.c */
+    unsigned long draw_frame;   /* number of the current redraw of whole page */
     unsigned int overwrite:1;   /* Overwrite on type mode (as opposed to insert) */
     unsigned int modified:1;    /* File has been modified and needs saving */
     unsigned int loading_done:1;        /* File has been loaded into the editor */
@@ -130,29 +129,31 @@ struct WEdit
     long line_numbers[N_LINE_CACHES];
     off_t line_offsets[N_LINE_CACHES];
 
-    edit_book_mark_t *book_mark;
+    edit_markers_t book_marks;  /* bookmarks: markers at lines with colors as values */
     GArray *serialized_bookmarks;
 
-    /* undo stack and pointers */
-    unsigned long undo_stack_pointer;
-    long *undo_stack;
-    unsigned long undo_stack_size;
-    unsigned long undo_stack_size_mask;
-    unsigned long undo_stack_bottom;
-    unsigned int undo_stack_disable:1;  /* If not 0, don't save events in the undo stack */
-
-    unsigned long redo_stack_pointer;
-    long *redo_stack;
-    unsigned long redo_stack_size;
-    unsigned long redo_stack_size_mask;
-    unsigned long redo_stack_bottom;
-    unsigned int redo_stack_reset:1;    /* If 1, need clear redo stack */
+    /* undo and redo journals */
+    edit_undo_t undo;
+    unsigned int undo_stack_disable:1;  /* If not 0, don't save events in the undo journal */
+
+    edit_undo_t redo;
+    unsigned int redo_stack_reset:1;    /* If 1, need clear redo journal */
+
+    edit_words_t words;         /* index of words for completion */
+    edit_brackets_t brackets;   /* index of brackets for bracket matching */
+    /* checkpoints of columns in long lines; it is a cache filled lazily by column walks, which
+       take const WEdit, so it is kept outside of the object */
+    edit_columns_t *columns;
+    edit_spell_t spell;         /* misspelled words found in background */
 
     struct stat stat1;          /* Result of mc_fstat() on the file */
+    int load_file;              /* descriptor of the file being loaded in background */
     unsigned int skip_detach_prompt:1;  /* Do not prompt whether to detach a file anymore */
 
     /* syntax higlighting */
-    GSList *syntax_marker;
+    GArray *syntax_marker;      /* rule state checkpoints sorted by offset */
+    off_t syntax_dirty;         /* first checkpoint offset to be verified, -1 if all are valid */
+    off_t syntax_dirty_end;     /* end of changes made since checkpoints were verified */
     GPtrArray *rules;
     off_t last_get_rule;
     edit_syntax_rule_t rule;
@@ -0,0 +1,300 @@
+/*
+   Index of words of editor buffer for word completion.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \file
+ *  \brief Source: index of words of editor buffer for word completion.
+ *  \date 2020
+ */
+
+#include <config.h>
+
+#include <ctype.h>
+#include <string.h>
+
+#include "lib/global.h"
+
+#include "edit-impl.h"
+#include "editwords.h"
+
+/* --------------------------------------------------------------------------------------------- */
+/*-
+ * Words are maximal runs of bytes other than whitespace and the break characters of
+ * the completion pattern. Completion may also start inside a word at the boundary of
+ * alphanumeric characters ("foo" in "<foo"), so the tails of a word starting at such
+ * boundaries are counted as words too.
+ *
+ * The index is a sequence of words sorted in byte order with the number of occurrences
+ * of each one. It is built on first use and then kept up to date on every change of the
+ * buffer: words touching the changed range are removed before the change and added
+ * after it. Words starting with a prefix are found by binary search.
+ */
+
+/*** global variables ****************************************************************************/
+
+/*** file scope macro definitions ****************************************************************/
+
+/* characters the completion pattern stops at, except whitespace */
+#define WORD_BREAK_CHARS ".=+[](),;:\"'-?/|\\{}*&^%$#@!"
+
+/*** file scope type declarations ****************************************************************/
+
+typedef struct
+{
+    char *word;
+    guint count;                /* number of occurrences */
+} edit_word_t;
+
+/*** file scope variables ************************************************************************/
+
+/* --------------------------------------------------------------------------------------------- */
+/*** file scope functions ************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_words_is_word_char (int c)
+{
+    return (c != '\0' && !isspace (c) && strchr (WORD_BREAK_CHARS, c) == NULL);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+edit_words_is_alnum (int c)
+{
+    return (c == '_' || isalnum (c));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_word_free (gpointer data)
+{
+    edit_word_t *w = (edit_word_t *) data;
+
+    g_free (w->word);
+    g_free (w);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static gint
+edit_word_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    (void) user_data;
+
+    return strcmp (((const edit_word_t *) a)->word, ((const edit_word_t *) b)->word);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+edit_words_count (edit_words_t * words, const char *word, int delta)
+{
+    edit_word_t key, *w;
+    GSequenceIter *iter;
+
+    key.word = (char *) word;
+    iter = g_sequence_lookup (words->words, &key, edit_word_cmp, NULL);
+
+    if (iter != NULL)
+        w = (edit_word_t *) g_sequence_get (iter);
+    else
+    {
+        /* nothing to remove */
+        if (delta < 0)
+            return;
+
+        w = g_new (edit_word_t, 1);
+        w->word = g_strdup (word);
+        w->count = 0;
+        g_sequence_insert_sorted (words->words, w, edit_word_cmp, NULL);
+    }
+
+    if (delta > 0)
+        w->count++;
+    else if (--w->count == 0)
+        g_sequence_remove (iter);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Count the word and its tails starting at alphanumeric boundaries.
+ */
+
+static void
+edit_words_count_all (edit_words_t * words, const GString * word, int delta)
+{
+    const unsigned char *s = (const unsigned char *) word->str;
+    gsize i;
+
+    for (i = 0; i < word->len; i++)
+        if (i == 0 || edit_words_is_alnum (s[i - 1]) != edit_words_is_alnum (s[i]))
+            edit_words_count (words, word->str + i, delta);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Count all words lying in the range of buffer.
+ */
+
+static void
+edit_words_scan (edit_words_t * words, const edit_buffer_t * buf, off_t start, off_t finish,
+                 int delta)
+{
+    GString *word;
+
+    word = g_string_sized_new (32);
+
+    while (start < finish)
+    {
+        const char *p;
+        off_t i, len;
+
+        p = edit_buffer_get_span (buf, start, &len);
+        if (p == NULL)
+            break;
+
+        len = MIN (len, finish - start);
+
+        for (i = 0; i < len; i++)
+            if (edit_words_is_word_char ((unsigned char) p[i]))
+                g_string_append_c (word, p[i]);
+            else if (word->len != 0)
+            {
+                edit_words_count_all (words, word, delta);
+                g_string_set_size (word, 0);
+            }
+
+        start += len;
+    }
+
+    if (word->len != 0)
+        edit_words_count_all (words, word, delta);
+
+    g_string_free (word, TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/*** public functions ****************************************************************************/
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_words_init (edit_words_t * words)
+{
+    words->words = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+void
+edit_words_clean (edit_words_t * words)
+{
+    if (words->words != NULL)
+    {
+        g_sequence_free (words->words);
+        words->words = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Build the index of words of the whole buffer, unless it is built already.
+ */
+
+void
+edit_words_build (edit_words_t * words, const edit_buffer_t * buf)
+{
+    if (words->words != NULL)
+        return;
+
+    words->words = g_sequence_new (edit_word_free);
+    edit_words_scan (words, buf, 0, buf->size, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update the index when the range of buffer is changed. Called with negative delta before
+ * the change for the range to be removed, and with positive delta after the change for
+ * the inserted range. Words touching the range are updated as a whole.
+ *
+ * @param words index of words
+ * @param buf editor buffer
+ * @param start offset of the range
+ * @param finish offset of the byte following the range
+ * @param delta -1 to remove the words from the index, 1 to add them
+ */
+
+void
+edit_words_update (edit_words_t * words, const edit_buffer_t * buf, off_t start, off_t finish,
+                   int delta)
+{
+    if (words->words == NULL)
+        return;
+
+    while (start > 0 && edit_words_is_word_char (edit_buffer_get_byte (buf, start - 1)))
+        start--;
+    while (finish < buf->size && edit_words_is_word_char (edit_buffer_get_byte (buf, finish)))
+        finish++;
+
+    edit_words_scan (words, buf, start, finish, delta);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Collect words starting with the prefix and longer than it.
+ *
+ * @param words index of words
+ * @param prefix prefix of words
+ * @param len length of prefix
+ * @param found hash table of words to add the number of occurrences to. Keys are
+ *              the words of index and are valid until the buffer is changed
+ */
+
+void
+edit_words_collect (const edit_words_t * words, const char *prefix, gsize len,
+                    GHashTable * found)
+{
+    edit_word_t key;
+    GSequenceIter *iter;
+
+    if (words->words == NULL)
+        return;
+
+    key.word = g_strndup (prefix, len);
+    /* the first word greater than prefix */
+    iter = g_sequence_search (words->words, &key, edit_word_cmp, NULL);
+    g_free (key.word);
+
+    for (; !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    {
+        const edit_word_t *w = (const edit_word_t *) g_sequence_get (iter);
+        guint count;
+
+        if (strncmp (w->word, prefix, len) != 0)
+            break;
+
+        count = GPOINTER_TO_UINT (g_hash_table_lookup (found, w->word));
+        g_hash_table_insert (found, w->word, GUINT_TO_POINTER (count + w->count));
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
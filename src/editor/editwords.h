@@ -0,0 +1,36 @@
+/** \file
+ *  \brief Header: index of words of editor buffer for word completion
+ */
+
+#ifndef MC__EDIT_WORDS_H
+#define MC__EDIT_WORDS_H
+
+#include "editbuffer.h"
+
+/*** typedefs(not structures) and defined constants **********************************************/
+
+/*** enums ***************************************************************************************/
+
+/*** structures declarations (and typedefs of structures)*****************************************/
+
+typedef struct edit_words_struct
+{
+    GSequence *words;           /* word counts sorted by word, NULL if the index is not built */
+} edit_words_t;
+
+/*** global variables defined in .c file *********************************************************/
+
+/*** declarations of public functions ************************************************************/
+
+void edit_words_init (edit_words_t * words);
+void edit_words_clean (edit_words_t * words);
+
+void edit_words_build (edit_words_t * words, const edit_buffer_t * buf);
+void edit_words_update (edit_words_t * words, const edit_buffer_t * buf, off_t start,
+                        off_t finish, int delta);
+void edit_words_collect (const edit_words_t * words, const char *prefix, gsize len,
+                         GHashTable * found);
+
+/*** inline functions ****************************************************************************/
+
+#endif /* MC__EDIT_WORDS_H */
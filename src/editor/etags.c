@@ -36,6 +36,13 @@
 #include <inttypes.h>
 #include <string.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #include "lib/global.h"
 #include "lib/sub-util.h"       /* canonicalize_pathname() */
@@ -48,10 +55,55 @@
 
 /*** file scope macro definitions ****************************************************************/
 
+#define ETAGS_RANK_BIT(rank) (1U << (rank))
+
 /*** file scope type declarations ****************************************************************/
 
+/* tag object */
+typedef struct
+{
+    guint32 name;               /* offset of tag name from the beginning of its section */
+    guint32 name_len;
+    long line;
+    unsigned int ranks;         /* ETAGS_RANK_BIT() of kinds the object may be of */
+    guint next;                 /* next object in the same hash bucket, 0 if none */
+} etags_object_t;
+
+/* tag objects of one source file */
+typedef struct
+{
+    char *filename;
+    off_t start;                /* offset of the section in TAGS */
+    off_t len;
+    guint64 checksum;           /* checksum of the section */
+    guint first;                /* index of the first object */
+    guint count;                /* number of objects */
+} etags_section_t;
+
+/* TAGS file, indexed by tag name, by source file and by kind of objects */
+typedef struct
+{
+    char *tagfile;
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    off_t size;
+
+    char *data;                 /* TAGS contents */
+    gboolean mapped;            /* TRUE if data is mapped, FALSE if it is read into memory */
+
+    GArray *sections;           /* etags_section_t in order of TAGS */
+    GHashTable *files;          /* section index + 1 by filename */
+    GArray *objects;            /* etags_object_t, the first one is unused */
+    guint *buckets;             /* index of the first object by hash of its name, 0 if none */
+    guint mask;                 /* number of buckets - 1 */
+} etags_index_t;
+
 /*** file scope variables ************************************************************************/
 
+/* index of the last used TAGS file, shared by all editors */
+static etags_index_t *etags_index = NULL;
+
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
 
@@ -195,6 +247,469 @@ parse_define (const char *buf, char **long_name, char **short_name, long *line)
     return FALSE;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+
+static guint32
+etags_hash (const char *s, size_t len)
+{
+    guint32 h = 2166136261U;
+
+    for (; len != 0; len--, s++)
+        h = (h ^ (unsigned char) *s) * 16777619U;
+
+    return h;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static guint64
+etags_checksum (const char *s, off_t len)
+{
+    guint64 h = G_GUINT64_CONSTANT (14695981039346656037);
+
+    for (; len != 0; len--, s++)
+        h = (h ^ (unsigned char) *s) * G_GUINT64_CONSTANT (1099511628211);
+
+    return h;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Copy the line of TAGS to the buffer, like fgets() does.
+ *
+ * @param idx index of TAGS
+ * @param pos offset of the line, moved to the next line
+ * @param end offset the line may not cross
+ * @param buf buffer for the line
+ * @param size size of buffer
+ *
+ * @return FALSE if there are no more lines
+ */
+
+static gboolean
+etags_get_line (const etags_index_t * idx, off_t * pos, off_t end, char *buf, size_t size)
+{
+    const char *p, *eol;
+    size_t len;
+
+    if (*pos >= end)
+        return FALSE;
+
+    p = idx->data + *pos;
+    len = (size_t) MIN ((off_t) (size - 1), end - *pos);
+    eol = memchr (p, '\n', len);
+    if (eol != NULL)
+        len = eol - p + 1;
+
+    memcpy (buf, p, len);
+    buf[len] = '\0';
+    *pos += len;
+
+    return TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find out kinds of the object by its definition.
+ */
+
+static unsigned int
+etags_get_ranks (const char *longname, const char *shortname)
+{
+    gboolean can_be_func, can_be_var, can_be_type, is_other;
+    unsigned int ranks = 0;
+    char *longname_wr;
+
+    /* Prepare the work variable. */
+    longname_wr = g_strdup (longname);
+
+    /* Function – if there's '(' in the declaration. */
+    can_be_func = strstr (longname, "(") != NULL;
+    /* Variable – if there's no parens and no # in the declaration. */
+    can_be_var = strstr (g_strdelimit (longname_wr, "}{()#", '\033'), "\033") == NULL;
+    /* Type – if there's a 'struct', 'typedef', 'enum' or '}' in the declaration. */
+    can_be_type = (strstr (longname, "struct ") ||
+                   strstr (longname, "typedef ") ||
+                   strstr (longname, "enum ")) ||
+        (strstr (longname, "}") &&
+         (g_str_has_suffix (shortname, "_t") || g_str_has_suffix (shortname, "_type")));
+    /* Other kind – nor any of the above. */
+    is_other = !can_be_func && !can_be_var && !can_be_type;
+
+    /* Renew the work variable. */
+    g_free (longname_wr);
+    longname_wr = g_strdup (longname);
+
+    /* A closer examination of type tags. */
+    if (can_be_type && !can_be_func)
+    {
+        /*
+         * Verify if it's not a struct variable or an enum.
+         * It filters out occurrences such as:
+         * – struct type SHORTNAME … – i.e.: the shortname at 3rd position, because
+         *   this means that a struct variable, not a struct type is being defined.
+         */
+        gchar **words;
+
+        words = g_strsplit (str_collapse_whitespace (longname_wr, ' '), " ", -1);
+        if (words[0] != NULL && words[1] != NULL && words[2] != NULL
+            && strcmp (words[2], shortname) == 0)
+            can_be_type = FALSE;
+        g_strfreev (words);
+    }
+
+    /* A closer examination of variable tags. */
+    if (can_be_var)
+    {
+        /* Verify if it's not a struct typedef or an enum. */
+        gchar **words;
+
+        words = g_strsplit (str_collapse_whitespace (longname_wr, ' '), " ", -1);
+        if (words[0] == NULL || words[1] == NULL || strcmp (words[0], "typedef") == 0)
+            can_be_var = FALSE;
+        /* Most probably an enum ENUM = 0|1|… assignment. */
+        else if (strstr (words[0], "=") != NULL || words[1][0] == '=')
+            can_be_var = FALSE;
+        g_strfreev (words);
+    }
+
+    /* Free the work variable. */
+    g_free (longname_wr);
+
+    if (can_be_func)
+        ranks |= ETAGS_RANK_BIT (TAG_RANK_FUNCTIONS);
+    if (can_be_type)
+        ranks |= ETAGS_RANK_BIT (TAG_RANK_TYPES);
+    if (can_be_var)
+        ranks |= ETAGS_RANK_BIT (TAG_RANK_VARIABLES);
+    if (is_other)
+        ranks |= ETAGS_RANK_BIT (TAG_RANK_OTHER);
+
+    return ranks;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Locate tag name in the line of TAGS: it is either given explicitly after DEL character
+ * or is the last identifier of the definition.
+ */
+
+static gboolean
+etags_get_name (const char *buf, size_t * name, size_t * len)
+{
+    const char *del, *p;
+
+    del = strchr (buf, 0x7F);
+    if (del == NULL)
+        return FALSE;
+
+    for (p = del + 1; *p != 0x01 && *p != '\0' && *p != '\n'; p++)
+        ;
+
+    if (*p == 0x01 && p != del + 1)
+    {
+        *name = del + 1 - buf;
+        *len = p - del - 1;
+        return TRUE;
+    }
+
+    /* implicit name */
+    for (p = del; p != buf && !(isalnum ((unsigned char) p[-1]) || p[-1] == '_' || p[-1] == '$');
+         p--)
+        ;
+    *len = 0;
+    for (; p != buf && (isalnum ((unsigned char) p[-1]) || p[-1] == '_' || p[-1] == '$'); p--)
+        (*len)++;
+    *name = p - buf;
+
+    return (*len != 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add tag objects of the section to the index.
+ */
+
+static void
+etags_index_parse_section (etags_index_t * idx, etags_section_t * s)
+{
+    off_t pos = s->start;
+    char buf[BUF_LARGE];
+
+    s->first = idx->objects->len;
+
+    while (TRUE)
+    {
+        off_t line_start = pos;
+        char *longname, *shortname;
+        size_t name, name_len;
+        etags_object_t o;
+
+        if (!etags_get_line (idx, &pos, s->start + s->len, buf, sizeof (buf)))
+            break;
+
+        if (!parse_define (buf, &longname, &shortname, &o.line)
+            || !etags_get_name (buf, &name, &name_len))
+            continue;
+
+        o.name = (guint32) (line_start - s->start + name);
+        o.name_len = (guint32) name_len;
+        o.ranks = etags_get_ranks (longname, shortname);
+        o.next = 0;
+        g_array_append_val (idx->objects, o);
+    }
+
+    s->count = idx->objects->len - s->first;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Fill the index: split TAGS into sections and take the objects of unchanged sections from
+ * the index of the previous version of TAGS, parse the rest ones.
+ */
+
+static void
+etags_index_fill (etags_index_t * idx, const etags_index_t * old)
+{
+    off_t pos = 0;
+    char buf[BUF_LARGE];
+    gboolean in_filename = FALSE;
+    guint i;
+
+    /* split into sections */
+    while (TRUE)
+    {
+        off_t line_start = pos;
+        etags_section_t s;
+
+        if (!etags_get_line (idx, &pos, idx->size, buf, sizeof (buf)))
+            break;
+
+        if (buf[0] == 0x0C)
+        {
+            if (idx->sections->len != 0)
+            {
+                etags_section_t *last;
+
+                last = &g_array_index (idx->sections, etags_section_t, idx->sections->len - 1);
+                last->len = line_start - last->start;
+            }
+            in_filename = TRUE;
+        }
+        else if (in_filename)
+        {
+            memset (&s, 0, sizeof (s));
+            s.filename = g_strndup (buf, strcspn (buf, ",\n"));
+            s.start = pos;
+            s.len = idx->size - pos;
+            g_array_append_val (idx->sections, s);
+            in_filename = FALSE;
+        }
+    }
+
+    for (i = 0; i < idx->sections->len; i++)
+    {
+        etags_section_t *s;
+        const etags_section_t *os = NULL;
+        gpointer n;
+
+        s = &g_array_index (idx->sections, etags_section_t, i);
+        s->checksum = etags_checksum (idx->data + s->start, s->len);
+
+        if (old != NULL)
+        {
+            n = g_hash_table_lookup (old->files, s->filename);
+            if (n != NULL)
+                os = &g_array_index (old->sections, etags_section_t, GPOINTER_TO_UINT (n) - 1);
+        }
+
+        if (os != NULL && os->len == s->len && os->checksum == s->checksum)
+        {
+            /* object names are relative to the section */
+            s->first = idx->objects->len;
+            s->count = os->count;
+            g_array_append_vals (idx->objects,
+                                 &g_array_index (old->objects, etags_object_t, os->first),
+                                 os->count);
+        }
+        else
+            etags_index_parse_section (idx, s);
+
+        /* the first section wins, as lookup of files stops at it */
+        if (g_hash_table_lookup (idx->files, s->filename) == NULL)
+            g_hash_table_insert (idx->files, s->filename, GUINT_TO_POINTER (i + 1));
+    }
+
+    /* hash objects by name keeping the order of TAGS in buckets */
+    for (idx->mask = 1; idx->mask < idx->objects->len; idx->mask <<= 1)
+        ;
+    idx->buckets = g_new0 (guint, idx->mask);
+    idx->mask--;
+
+    for (i = idx->sections->len; i != 0; i--)
+    {
+        const etags_section_t *s;
+        guint j;
+
+        s = &g_array_index (idx->sections, etags_section_t, i - 1);
+
+        for (j = s->first + s->count; j != s->first; j--)
+        {
+            etags_object_t *o;
+            guint32 h;
+
+            o = &g_array_index (idx->objects, etags_object_t, j - 1);
+            h = etags_hash (idx->data + s->start + o->name, o->name_len) & idx->mask;
+            o->next = idx->buckets[h];
+            idx->buckets[h] = j - 1;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+etags_index_free (etags_index_t * idx)
+{
+    guint i;
+
+    if (idx == NULL)
+        return;
+
+    if (idx->data != NULL)
+    {
+#ifdef HAVE_MMAP
+        if (idx->mapped)
+            munmap (idx->data, (size_t) idx->size);
+        else
+#endif
+            g_free (idx->data);
+    }
+
+    for (i = 0; i < idx->sections->len; i++)
+        g_free (g_array_index (idx->sections, etags_section_t, i).filename);
+
+    g_array_free (idx->sections, TRUE);
+    g_hash_table_destroy (idx->files);
+    g_array_free (idx->objects, TRUE);
+    g_free (idx->buckets);
+    g_free (idx->tagfile);
+    g_free (idx);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Map TAGS into memory and index it.
+ *
+ * @param tagfile path to TAGS
+ * @param st status of TAGS
+ * @param old index of the previous version of the same TAGS or NULL
+ *
+ * @return new index or NULL on error
+ */
+
+static etags_index_t *
+etags_index_load (const char *tagfile, const struct stat *st, const etags_index_t * old)
+{
+    etags_index_t *idx;
+    int fd;
+
+    if ((off_t) (size_t) st->st_size != st->st_size)
+        return NULL;
+
+    fd = open (tagfile, O_RDONLY | O_BINARY);
+    if (fd < 0)
+        return NULL;
+
+    idx = g_new0 (etags_index_t, 1);
+    idx->tagfile = g_strdup (tagfile);
+    idx->dev = st->st_dev;
+    idx->ino = st->st_ino;
+    idx->mtime = st->st_mtime;
+    idx->size = st->st_size;
+    idx->sections = g_array_new (FALSE, FALSE, sizeof (etags_section_t));
+    idx->files = g_hash_table_new (g_str_hash, g_str_equal);
+    idx->objects = g_array_new (FALSE, TRUE, sizeof (etags_object_t));
+    /* index 0 means no object */
+    g_array_set_size (idx->objects, 1);
+
+    if (idx->size != 0)
+    {
+#ifdef HAVE_MMAP
+        idx->data = mmap (0, (size_t) idx->size, PROT_READ, MAP_FILE | MAP_PRIVATE, fd, 0);
+        idx->mapped = (idx->data != (char *) -1);
+        if (!idx->mapped)
+#endif
+        {
+            idx->data = g_try_malloc ((size_t) idx->size);
+            if (idx->data == NULL || read (fd, idx->data, (size_t) idx->size) != idx->size)
+            {
+                close (fd);
+                etags_index_free (idx);
+                return NULL;
+            }
+        }
+    }
+
+    /* mapping remains valid after file is closed */
+    close (fd);
+
+    etags_index_fill (idx, old);
+
+    return idx;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get index of TAGS. The index is built on first use and is rebuilt when TAGS is changed.
+ *
+ * @return index or NULL if TAGS cannot be read
+ */
+
+static const etags_index_t *
+etags_index_get (const char *tagfile)
+{
+    struct stat st;
+    etags_index_t *idx;
+
+    if (stat (tagfile, &st) != 0)
+        return NULL;
+
+    if (etags_index != NULL && strcmp (etags_index->tagfile, tagfile) == 0
+        && etags_index->dev == st.st_dev && etags_index->ino == st.st_ino
+        && etags_index->mtime == st.st_mtime && etags_index->size == st.st_size)
+        return etags_index;
+
+    /* unchanged sections of the same TAGS are not parsed again */
+    idx = etags_index_load (tagfile, &st,
+                            etags_index != NULL
+                            && strcmp (etags_index->tagfile, tagfile) == 0 ? etags_index : NULL);
+    etags_index_free (etags_index);
+    etags_index = idx;
+
+    return idx;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Store the object in the array of found ones.
+ */
+
+static void
+etags_set_object (const etags_index_t * idx, const etags_section_t * s, const etags_object_t * o,
+                  const char *start_path, etags_hash_t * hash)
+{
+    hash->filename = g_strdup (s->filename);
+    hash->filename_len = strlen (s->filename);
+
+    /* Save and canonicalize the path to the file. */
+    hash->fullpath = mc_build_filename (start_path, s->filename, (char *) NULL);
+    canonicalize_pathname (hash->fullpath);
+
+    hash->short_define = g_strndup (idx->data + s->start + o->name, o->name_len);
+    hash->line = o->line;
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -205,168 +720,47 @@ etags_get_objects_for_file (etags_rank_t type, const char *tagfile,
                             const char *start_path, const char *match_filename,
                             etags_hash_t * functions_hash, int *max_len_return, int size_limit)
 {
-    /* *INDENT-OFF* */
-    enum
-    {
-        start,
-        in_filename,
-        in_define
-    } state = start;
-    /* *INDENT-ON* */
-
-    FILE *f;
-    char buf[BUF_LARGE];
-
+    const etags_index_t *idx;
+    const etags_section_t *s;
+    gpointer n;
+    guint i;
     int num = 0;                /* returned value */
-    char *filename = NULL;
 
     if (!match_filename || !tagfile)
         return 0;
 
     *max_len_return = 0;
 
-    /* open file with positions */
-    f = fopen (tagfile, "r");
-    if (f == NULL)
+    idx = etags_index_get (tagfile);
+    if (idx == NULL)
+        return 0;
+
+    n = g_hash_table_lookup (idx->files, match_filename);
+    if (n == NULL)
         return 0;
 
-    while (fgets (buf, sizeof (buf), f))
+    s = &g_array_index (idx->sections, etags_section_t, GPOINTER_TO_UINT (n) - 1);
+
+    for (i = s->first; i < s->first + s->count && num < size_limit - 1; i++)
     {
-        switch (state)
+        const etags_object_t *o;
+
+        o = &g_array_index (idx->objects, etags_object_t, i);
+
+        /* Is the object of the requested type? */
+        if (type == TAG_RANK_ANY || (o->ranks & ETAGS_RANK_BIT (type)) != 0)
         {
-        case start:
-            if (buf[0] == 0x0C)
-            {
-                state = in_filename;
-            }
-            break;
-        case in_filename:
-            {
-                size_t pos;
+            /* Update the max. length return variable */
+            if (*max_len_return < (int) o->name_len)
+                *max_len_return = (int) o->name_len;
 
-                pos = strcspn (buf, ",");
-                g_free (filename);
-                filename = g_strndup (buf, pos);
-                state = in_define;
-                break;
-            }
-        case in_define:
-            if (buf[0] == 0x0C)
-            {
-                state = in_filename;
-                break;
-            }
-            /* check if the filename matches the requested one */
-            if (strcmp (filename, match_filename) == 0)
-            {
-                char *longname = NULL;
-                char *shortname = NULL;
-                long line = 0;
+            etags_set_object (idx, s, o, start_path, &functions_hash[num]);
 
-                parse_define (buf, &longname, &shortname, &line);
-                if (num < size_limit - 1)
-                {
-                    gboolean can_be_func, can_be_var, can_be_type, is_other;
-
-                    /* Prepare the work variable. */
-                    char *longname_wr;
-                    longname_wr = g_strdup (longname);
-
-                    /* Function – if there's '(' in the declaration. */
-                    can_be_func = strstr (longname, "(") != NULL;
-                    /* Variable – if there's no parens and no # in the declaration. */
-                    can_be_var = strstr (g_strdelimit (longname_wr, "}{()#", ''), "") == NULL;
-                    /* Type – if there's a 'struct', 'typedef', 'enum' or '}' in the declaration. */
-                    can_be_type = (strstr (longname, "struct ") ||
-                                   strstr (longname, "typedef ") ||
-                                   strstr (longname, "enum ")) ||
-                        (strstr (longname, "}") &&
-                         (g_str_has_suffix (shortname, "_t") ||
-                          g_str_has_suffix (shortname, "_type")));
-                    /* Other kind – nor any of the above. */
-                    is_other = !can_be_func && !can_be_var && !can_be_type;
-
-                    /* Renew the work variable. */
-                    g_free (longname_wr);
-                    longname_wr = g_strdup (longname);
-
-                    /* A closer examination of type tags. */
-                    if (type == TAG_RANK_TYPES && can_be_type && !can_be_func)
-                    {
-                        /*
-                         * Verify if it's not a struct variable or an enum.
-                         * It filters out occurrences such as:
-                         * – struct type SHORTNAME … – i.e.: the shortname at 3rd position, because
-                         *   this means that a struct variable, not a struct type is being defined.
-                         */
-                        gchar **words =
-                            g_strsplit (str_collapse_whitespace (longname_wr, ' '), " ", -1);
-                        if (words[2] && strcmp (words[2], shortname) == 0)
-                            can_be_type = FALSE;
-                        g_strfreev (words);
-                    }
-
-                    /* A closer examination of variable tags. */
-                    if (type == TAG_RANK_VARIABLES && can_be_var)
-                    {
-                        /* Verify if it's not a struct typedef or an enum. */
-                        gchar **words =
-                            g_strsplit (str_collapse_whitespace (longname_wr, ' '), " ", -1);
-                        if (strcmp (words[0], "typedef") == 0 || !words[0] || !words[1])
-                            can_be_var = FALSE;
-                        /* Most probably an enum ENUM = 0|1|… assignment. */
-                        if (!words[0] || strstr (words[0], "=") || (words[1] && words[1][0] == '='))
-                            can_be_var = FALSE;
-                        g_strfreev (words);
-                    }
-
-                    /* Free the work variable. */
-                    g_free (longname_wr);
-
-                    /* Is the object of the requested type? */
-                    if (type == TAG_RANK_ANY ||
-                        ((type == TAG_RANK_FUNCTIONS && can_be_func) ||
-                         (type == TAG_RANK_VARIABLES && can_be_var) ||
-                         (type == TAG_RANK_TYPES && can_be_type) ||
-                         (type == TAG_RANK_OTHER && is_other)))
-                    {
-                        /* Update the max. length return variable */
-                        int max_len_candidate;
-                        max_len_candidate = strlen (shortname);
-                        if (*max_len_return < max_len_candidate)
-                            *max_len_return = max_len_candidate;
-
-                        /* Save the filename. */
-                        functions_hash[num].filename = g_strdup (filename);
-                        functions_hash[num].filename_len = strlen (filename);
-
-                        /* Save and canonicalize the path to the file. */
-                        functions_hash[num].fullpath =
-                            mc_build_filename (start_path, filename, (char *) NULL);
-                        canonicalize_pathname (functions_hash[num].fullpath);
-
-                        /* Save the short define. */
-                        if (shortname)
-                            functions_hash[num].short_define = g_strdup (shortname);
-                        else
-                            functions_hash[num].short_define = g_strdup (longname);
-
-                        /* Save the line number. */
-                        functions_hash[num].line = line;
-
-                        /* Increase the count of the matched objects. */
-                        num++;
-                    }
-                }
-            }
-            break;
-        default:
-            break;
+            /* Increase the count of the matched objects. */
+            num++;
         }
     }
 
-    g_free (filename);
-    fclose (f);
     return num;
 }
 
@@ -376,88 +770,63 @@ int
 etags_set_definition_hash (const char *tagfile, const char *start_path,
                            const char *match_func, etags_hash_t * def_hash)
 {
-    /* *INDENT-OFF* */
-    enum
-    {
-        start,
-        in_filename,
-        in_define
-    } state = start;
-    /* *INDENT-ON* */
-
-    FILE *f;
-    char buf[BUF_LARGE];
-
-    char *chekedstr = NULL;
-
+    const etags_index_t *idx;
+    const etags_object_t *o;
+    size_t len;
+    guint i, j;
     int num = 0;                /* returned value */
-    char *filename = NULL;
 
     if (!match_func || !tagfile)
         return 0;
 
-    /* open file with positions */
-    f = fopen (tagfile, "r");
-    if (f == NULL)
+    idx = etags_index_get (tagfile);
+    if (idx == NULL)
         return 0;
 
-    while (fgets (buf, sizeof (buf), f))
+    len = strlen (match_func);
+
+    /* sections of objects found are located by binary search */
+    for (i = idx->buckets[etags_hash (match_func, len) & idx->mask], j = 0;
+         i != 0 && num < MAX_TAG_OBJECTS - 1; i = o->next)
     {
-        switch (state)
+        const etags_section_t *s;
+        guint lo, hi;
+
+        o = &g_array_index (idx->objects, etags_object_t, i);
+
+        for (lo = j, hi = idx->sections->len; hi - lo > 1;)
         {
-        case start:
-            if (buf[0] == 0x0C)
-            {
-                state = in_filename;
-            }
-            break;
-        case in_filename:
-            {
-                size_t pos;
+            guint mid = lo + (hi - lo) / 2;
 
-                pos = strcspn (buf, ",");
-                g_free (filename);
-                filename = g_strndup (buf, pos);
-                state = in_define;
-                break;
-            }
-        case in_define:
-            if (buf[0] == 0x0C)
-            {
-                state = in_filename;
-                break;
-            }
-            /* check if the filename matches the define pos */
-            chekedstr = strstr (buf, match_func);
-            if (chekedstr)
-            {
-                char *longname = NULL;
-                char *shortname = NULL;
-                long line = 0;
+            if (g_array_index (idx->sections, etags_section_t, mid).first <= i)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        /* objects of bucket go in order of TAGS */
+        j = lo;
+        s = &g_array_index (idx->sections, etags_section_t, lo);
 
-                parse_define (chekedstr, &longname, &shortname, &line);
-                if (num < MAX_TAG_OBJECTS - 1)
-                {
-                    def_hash[num].filename_len = strlen (filename);
-                    def_hash[num].fullpath =
-                        mc_build_filename (start_path, filename, (char *) NULL);
-
-                    canonicalize_pathname (def_hash[num].fullpath);
-                    def_hash[num].filename = g_strdup (filename);
-                    def_hash[num].short_define = g_strdup (shortname ? shortname : longname);
-                    def_hash[num].line = line;
-                    num++;
-                }
-            }
-            break;
-        default:
-            break;
+        if (o->name_len == len && memcmp (idx->data + s->start + o->name, match_func, len) == 0)
+        {
+            etags_set_object (idx, s, o, start_path, &def_hash[num]);
+            num++;
         }
     }
 
-    g_free (filename);
-    fclose (f);
     return num;
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Free the index of TAGS.
+ */
+
+void
+etags_clean (void)
+{
+    etags_index_free (etags_index);
+    etags_index = NULL;
+}
+
+/* --------------------------------------------------------------------------------------------- */
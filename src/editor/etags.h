@@ -60,5 +60,7 @@ int etags_get_objects_for_file (etags_rank_t type, const char *tagfile,
 
 int etags_locate_tags_file (char **tagfile_return, char **path_return);
 
+void etags_clean (void);
+
 /*** inline functions ****************************************************************************/
 #endif /* MC__EDIT_ETAGS_H */
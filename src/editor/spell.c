@@ -44,6 +44,13 @@
 
 /*** file scope macro definitions ****************************************************************/
 
+/* values of checked words in the cache */
+#define SPELL_WORD_CORRECT GINT_TO_POINTER (1)
+#define SPELL_WORD_WRONG GINT_TO_POINTER (2)
+
+/* number of checked words to keep */
+#define SPELL_CACHE_WORDS_MAX 65536
+
 /*** file scope type declarations ****************************************************************/
 
 typedef struct aspell_struct
@@ -57,6 +64,10 @@ typedef struct aspell_struct
 static GModule *spell_module = NULL;
 static spell_t *global_speller = NULL;
 
+/* results of check of words with the current dictionary */
+static GHashTable *spell_cache = NULL;
+static GString *spell_cache_key = NULL;
+
 static AspellConfig *(*mc_new_aspell_config) (void);
 static int (*mc_aspell_config_replace) (AspellConfig * ths, const char *key, const char *value);
 static AspellCanHaveError *(*mc_new_aspell_speller) (AspellConfig * config);
@@ -272,6 +283,28 @@ spell_available (void)
     return ret;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remember result of check of word. The cache is cleared when it's full: words of one text
+ * are repeated a lot, so the cache gets filled with them again at once.
+ *
+ * @param word Word
+ * @param word_size Word size (in bytes)
+ * @param correct TRUE if the word is in the dictionary
+ */
+
+static void
+spell_cache_add (const char *word, int word_size, gboolean correct)
+{
+    if (spell_cache == NULL)
+        spell_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    else if (g_hash_table_size (spell_cache) >= SPELL_CACHE_WORDS_MAX)
+        g_hash_table_remove_all (spell_cache);
+
+    g_hash_table_replace (spell_cache, g_strndup (word, word_size),
+                          correct ? SPELL_WORD_CORRECT : SPELL_WORD_WRONG);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 /*** public functions ****************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -339,6 +372,30 @@ aspell_clean (void)
 
     g_module_close (spell_module);
     spell_module = NULL;
+
+    if (spell_cache != NULL)
+    {
+        g_hash_table_destroy (spell_cache);
+        spell_cache = NULL;
+    }
+    if (spell_cache_key != NULL)
+    {
+        g_string_free (spell_cache_key, TRUE);
+        spell_cache_key = NULL;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check if words can be checked.
+ *
+ * @return TRUE if Aspell is loaded and the dictionary is open
+ */
+
+gboolean
+aspell_ready (void)
+{
+    return (global_speller != NULL && global_speller->speller != NULL);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -457,6 +514,9 @@ aspell_set_lang (const char *lang)
 
         global_speller->speller = NULL;
 
+        if (spell_cache != NULL)
+            g_hash_table_remove_all (spell_cache);
+
         error = mc_new_aspell_speller (global_speller->config);
         if (mc_aspell_error (error) != 0)
         {
@@ -471,7 +531,7 @@ aspell_set_lang (const char *lang)
 
 /* --------------------------------------------------------------------------------------------- */
 /**
- * Check word.
+ * Check word. Results are cached, so repeated words are looked up in the dictionary once.
  *
  * @param word Word for spell check
  * @param word_size Word size (in bytes)
@@ -481,12 +541,30 @@ aspell_set_lang (const char *lang)
 gboolean
 aspell_check (const char *word, const int word_size)
 {
-    int res = 0;
+    gpointer res = NULL;
 
-    if (word != NULL && global_speller != NULL && global_speller->speller != NULL)
-        res = mc_aspell_speller_check (global_speller->speller, word, word_size);
+    if (word == NULL || global_speller == NULL || global_speller->speller == NULL)
+        return FALSE;
 
-    return (res == 1);
+    if (spell_cache != NULL)
+    {
+        if (spell_cache_key == NULL)
+            spell_cache_key = g_string_sized_new (32);
+        g_string_truncate (spell_cache_key, 0);
+        g_string_append_len (spell_cache_key, word, word_size);
+        res = g_hash_table_lookup (spell_cache, spell_cache_key->str);
+    }
+
+    if (res == NULL)
+    {
+        gboolean correct;
+
+        correct = mc_aspell_speller_check (global_speller->speller, word, word_size) == 1;
+        spell_cache_add (word, word_size, correct);
+        return correct;
+    }
+
+    return (res == SPELL_WORD_CORRECT);
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -552,6 +630,8 @@ aspell_add_to_dict (const char *word, int word_size)
         return FALSE;
     }
 
+    spell_cache_add (word, word_size, TRUE);
+
     mc_aspell_speller_save_all_word_lists (global_speller->speller);
 
     if (mc_aspell_speller_error (global_speller->speller) != 0)
@@ -15,6 +15,7 @@
 
 void aspell_init (void);
 void aspell_clean (void);
+gboolean aspell_ready (void);
 gboolean aspell_check (const char *word, const int word_size);
 unsigned int aspell_suggest (GArray * suggest, const char *word, const int word_size);
 void aspell_array_clean (GArray * array);
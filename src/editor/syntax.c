@@ -68,6 +68,7 @@
 
 gboolean option_syntax_highlighting = TRUE;
 gboolean option_auto_syntax = TRUE;
+gboolean option_syntax_prescan = FALSE;
 
 /*** file scope macro definitions ****************************************************************/
 
@@ -82,6 +83,9 @@ gboolean option_auto_syntax = TRUE;
 #define SYNTAX_TOKEN_BRACKET    '\003'
 #define SYNTAX_TOKEN_BRACE      '\004'
 
+/* keywords sharing longer literal prefix are not told apart by the prefix tree */
+#define SYNTAX_KEYWORD_TREE_DEPTH 32
+
 #define break_a { result = line; break; }
 #define check_a { if (*a == NULL) { result = line; break; } }
 #define check_not_a { if (*a != NULL) { result = line ;break; } }
@@ -102,6 +106,15 @@ typedef struct
     int color;
 } syntax_keyword_t;
 
+/* node of keyword prefix tree */
+typedef struct
+{
+    guint child;                /* first child node, 0 if none */
+    guint next;                 /* next sibling node, 0 if none */
+    unsigned char c;            /* byte leading to the node */
+    GArray *keywords;           /* indexes of keywords which literal prefix ends here, ascending */
+} syntax_keyword_node_t;
+
 typedef struct
 {
     char *left;
@@ -113,7 +126,10 @@ typedef struct
     gboolean between_delimiters;
     char *whole_word_chars_left;
     char *whole_word_chars_right;
-    char *keyword_first_chars;
+    /* keywords dispatched by the first byte and matched by literal prefix */
+    guint keyword_tree_root[256];
+    GArray *keyword_tree;       /* nodes, node 0 is not used */
+    GArray *keyword_wild;       /* keywords starting with a wildcard, checked at every byte */
     gboolean spelling;
     /* first word is word[1] */
     GPtrArray *keyword;
@@ -125,10 +141,42 @@ typedef struct
     edit_syntax_rule_t rule;
 } syntax_marker_t;
 
+/* file included by the rule set */
+typedef struct
+{
+    char *name;                 /* argument of 'include' */
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    off_t size;
+} syntax_rules_include_t;
+
+/* rule set shared by editor windows */
+typedef struct
+{
+    /* file and offset the rule set was read from */
+    dev_t dev;
+    ino_t ino;
+    time_t mtime;
+    off_t size;
+    off_t offset;
+    /* syntax_rules_include_t of files included by the rule set */
+    GSList *includes;
+    /* rules hold indexes of temporary color pairs */
+    unsigned int colors;
+
+    GPtrArray *rules;
+    gboolean is_case_insensitive;
+    int ref_count;
+} syntax_rules_cache_t;
+
 /*** file scope variables ************************************************************************/
 
 static char *error_file_name = NULL;
 
+/* rule sets in use */
+static GSList *syntax_rules_cache = NULL;
+
 /* --------------------------------------------------------------------------------------------- */
 /*** file scope functions ************************************************************************/
 /* --------------------------------------------------------------------------------------------- */
@@ -155,7 +203,23 @@ context_rule_free (gpointer rule)
     g_free (r->right);
     g_free (r->whole_word_chars_left);
     g_free (r->whole_word_chars_right);
-    g_free (r->keyword_first_chars);
+
+    if (r->keyword_tree != NULL)
+    {
+        guint i;
+
+        for (i = 0; i < r->keyword_tree->len; i++)
+        {
+            syntax_keyword_node_t *n;
+
+            n = &g_array_index (r->keyword_tree, syntax_keyword_node_t, i);
+            if (n->keywords != NULL)
+                g_array_free (n->keywords, TRUE);
+        }
+        g_array_free (r->keyword_tree, TRUE);
+    }
+    if (r->keyword_wild != NULL)
+        g_array_free (r->keyword_wild, TRUE);
 
     if (r->keyword != NULL)
     {
@@ -168,6 +232,226 @@ context_rule_free (gpointer rule)
 
 /* --------------------------------------------------------------------------------------------- */
 
+static FILE *
+open_include_file (const char *filename)
+{
+    FILE *f;
+
+    g_free (error_file_name);
+    error_file_name = g_strdup (filename);
+    if (g_path_is_absolute (filename))
+        return fopen (filename, "r");
+
+    g_free (error_file_name);
+    error_file_name =
+        g_build_filename (mc_config_get_data_path (), EDIT_HOME_DIR, filename, (char *) NULL);
+    f = fopen (error_file_name, "r");
+    if (f != NULL)
+        return f;
+
+    g_free (error_file_name);
+    error_file_name = g_build_filename (mc_global.sysconfig_dir, "syntax", filename, (char *) NULL);
+    f = fopen (error_file_name, "r");
+    if (f != NULL)
+        return f;
+
+    g_free (error_file_name);
+    error_file_name =
+        g_build_filename (mc_global.share_data_dir, "syntax", filename, (char *) NULL);
+
+    return fopen (error_file_name, "r");
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+syntax_rules_include_free (gpointer include)
+{
+    g_free (((syntax_rules_include_t *) include)->name);
+    g_free (include);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Remember the file included by the rule set being read.
+ *
+ * @param includes list of files included so far
+ * @param name argument of 'include'
+ * @param f the included file
+ *
+ * @return new start of the list
+ */
+
+static GSList *
+syntax_rules_include_add (GSList * includes, const char *name, FILE * f)
+{
+    syntax_rules_include_t *inc;
+    struct stat st;
+
+    inc = g_new0 (syntax_rules_include_t, 1);
+    inc->name = g_strdup (name);
+
+    /* unknown file never matches on lookup, so the rule set is read again */
+    if (fstat (fileno (f), &st) == 0)
+    {
+        inc->dev = st.st_dev;
+        inc->ino = st.st_ino;
+        inc->mtime = st.st_mtime;
+        inc->size = st.st_size;
+    }
+
+    return g_slist_prepend (includes, inc);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether files included by the rule set are found at the same place and are unchanged.
+ *
+ * @return TRUE if the rule set can be shared
+ */
+
+static gboolean
+syntax_rules_includes_unchanged (const GSList * includes)
+{
+    char *saved_error_file_name;
+    gboolean ret = TRUE;
+
+    /* the name of the file being read is kept for error messages */
+    saved_error_file_name = error_file_name;
+    error_file_name = NULL;
+
+    for (; ret && includes != NULL; includes = g_slist_next (includes))
+    {
+        const syntax_rules_include_t *inc = (const syntax_rules_include_t *) includes->data;
+        FILE *f;
+        struct stat st;
+
+        f = open_include_file (inc->name);
+        ret = f != NULL && fstat (fileno (f), &st) == 0 && st.st_dev == inc->dev
+            && st.st_ino == inc->ino && st.st_mtime == inc->mtime && st.st_size == inc->size;
+        if (f != NULL)
+            fclose (f);
+    }
+
+    g_free (error_file_name);
+    error_file_name = saved_error_file_name;
+
+    return ret;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Identify the rule set which is about to be read from the file.
+ *
+ * @return FALSE if file cannot be identified
+ */
+
+static gboolean
+syntax_rules_cache_key (FILE * f, syntax_rules_cache_t * key)
+{
+    struct stat st;
+
+    if (fstat (fileno (f), &st) != 0)
+        return FALSE;
+
+    key->dev = st.st_dev;
+    key->ino = st.st_ino;
+    key->mtime = st.st_mtime;
+    key->size = st.st_size;
+    key->offset = ftello (f);
+    key->includes = NULL;
+    key->colors = tty_color_get_tmp_generation ();
+    key->rules = NULL;
+    key->is_case_insensitive = FALSE;
+    key->ref_count = 0;
+
+    return (key->offset != -1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Share the rule set read earlier from the same unchanged file with the editor. Rule sets
+ * read before the colors were freed (e.g. on change of skin) or including changed files are
+ * not shared.
+ *
+ * @return TRUE if the rule set is found
+ */
+
+static gboolean
+syntax_rules_cache_get (WEdit * edit, const syntax_rules_cache_t * key)
+{
+    GSList *l;
+
+    for (l = syntax_rules_cache; l != NULL; l = g_slist_next (l))
+    {
+        syntax_rules_cache_t *c = (syntax_rules_cache_t *) l->data;
+
+        if (c->dev == key->dev && c->ino == key->ino && c->mtime == key->mtime
+            && c->size == key->size && c->offset == key->offset && c->colors == key->colors
+            && syntax_rules_includes_unchanged (c->includes))
+        {
+            c->ref_count++;
+            edit->rules = c->rules;
+            edit->is_case_insensitive = c->is_case_insensitive;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+syntax_rules_cache_add (const WEdit * edit, const syntax_rules_cache_t * key)
+{
+    syntax_rules_cache_t *c;
+
+    c = g_new (syntax_rules_cache_t, 1);
+    *c = *key;
+    c->rules = edit->rules;
+    c->is_case_insensitive = edit->is_case_insensitive;
+    c->ref_count = 1;
+
+    syntax_rules_cache = g_slist_prepend (syntax_rules_cache, c);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Drop the reference to the rule set. The rule set is freed when no editor uses it.
+ */
+
+static void
+syntax_rules_cache_release (GPtrArray * rules)
+{
+    GSList *l;
+
+    for (l = syntax_rules_cache; l != NULL; l = g_slist_next (l))
+    {
+        syntax_rules_cache_t *c = (syntax_rules_cache_t *) l->data;
+
+        if (c->rules == rules)
+        {
+            if (--c->ref_count > 0)
+                return;
+
+            syntax_rules_cache = g_slist_delete_link (syntax_rules_cache, l);
+            g_slist_free_full (c->includes, syntax_rules_include_free);
+            g_free (c);
+            break;
+        }
+    }
+
+    g_ptr_array_foreach (rules, (GFunc) context_rule_free, NULL);
+    g_ptr_array_free (rules, TRUE);
+
+    /* colors are allocated by rule sets only */
+    if (syntax_rules_cache == NULL)
+        tty_color_free_all_tmp ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 static gint
 mc_defines_destroy (gpointer key, gpointer value, gpointer data)
 {
@@ -348,13 +632,82 @@ compare_word_to_right (const WEdit * edit, off_t i, const char *text,
 
 /* --------------------------------------------------------------------------------------------- */
 
-static const char *
-xx_strchr (const WEdit * edit, const unsigned char *s, int char_byte)
+/**
+ * Find the first keyword of context matching the text. Only keywords which literal prefix matches
+ * the text are compared with it, in order they are defined.
+ *
+ * @param edit editor object
+ * @param r context rule
+ * @param i offset of text
+ * @param c byte at the offset
+ * @param end where to store the offset of the end of matched keyword
+ * @return index of keyword, or 0 if no keyword matches
+ */
+
+static int
+syntax_keyword_match (const WEdit * edit, const context_rule_t * r, off_t i, int c, off_t * end)
 {
-    while (*s >= '\005' && xx_tolower (edit, *s) != char_byte)
-        s++;
+    const GArray *lists[SYNTAX_KEYWORD_TREE_DEPTH + 1];
+    guint pos[SYNTAX_KEYWORD_TREE_DEPTH + 1];
+    guint n = 0, node;
+    off_t j = i;
+
+    if (r->keyword_wild != NULL)
+        lists[n++] = r->keyword_wild;
+
+    for (node = r->keyword_tree_root[c]; node != 0;)
+    {
+        const syntax_keyword_node_t *t;
+
+        t = &g_array_index (r->keyword_tree, syntax_keyword_node_t, node);
+        if (t->keywords != NULL)
+            lists[n++] = t->keywords;
+
+        c = xx_tolower (edit, edit_buffer_get_byte (&edit->buffer, ++j));
+        for (node = t->child; node != 0; node = t->next)
+        {
+            t = &g_array_index (r->keyword_tree, syntax_keyword_node_t, node);
+            if (t->c == c)
+                break;
+        }
+    }
+
+    memset (pos, 0, n * sizeof (pos[0]));
+
+    /* merge candidates to keep the order of definition */
+    while (TRUE)
+    {
+        guint l, best = n, count = 0;
+        syntax_keyword_t *k;
+        off_t e;
+
+        for (l = 0; l < n; l++)
+            if (pos[l] < lists[l]->len)
+            {
+                guint index;
+
+                index = g_array_index (lists[l], guint, pos[l]);
+                if (best == n || index < count)
+                {
+                    best = l;
+                    count = index;
+                }
+            }
 
-    return (const char *) s;
+        if (best == n)
+            return 0;
+
+        pos[best]++;
+
+        k = SYNTAX_KEYWORD (g_ptr_array_index (r->keyword, count));
+        e = compare_word_to_right (edit, i, k->keyword, k->whole_word_chars_left,
+                                   k->whole_word_chars_right, k->line_start);
+        if (e > 0)
+        {
+            *end = e;
+            return (int) count;
+        }
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -425,42 +778,32 @@ apply_rules_going_right (WEdit * edit, off_t i)
     /* check to turn on a keyword */
     if (_rule.keyword == 0)
     {
-        const char *p;
+        int count;
+        off_t e;
 
         r = CONTEXT_RULE (g_ptr_array_index (edit->rules, _rule.context));
-        p = r->keyword_first_chars;
+        count = syntax_keyword_match (edit, r, i, c, &e);
+        if (count != 0)
+        {
+            syntax_keyword_t *k;
 
-        if (p != NULL)
-            while (*(p = xx_strchr (edit, (const unsigned char *) p + 1, c)) != '\0')
-            {
-                syntax_keyword_t *k;
-                int count;
-                off_t e;
-
-                count = p - r->keyword_first_chars;
-                k = SYNTAX_KEYWORD (g_ptr_array_index (r->keyword, count));
-                e = compare_word_to_right (edit, i, k->keyword, k->whole_word_chars_left,
-                                           k->whole_word_chars_right, k->line_start);
-                if (e > 0)
-                {
-                    /* when both context and keyword terminate with a newline,
-                       the context overflows to the next line and colorizes it incorrectly */
-                    if (e > i + 1 && _rule._context != 0
-                        && k->keyword[strlen (k->keyword) - 1] == '\n')
-                    {
-                        r = CONTEXT_RULE (g_ptr_array_index (edit->rules, _rule._context));
-                        if (r->right != NULL && r->right[0] != '\0'
-                            && r->right[strlen (r->right) - 1] == '\n')
-                            e--;
-                    }
+            k = SYNTAX_KEYWORD (g_ptr_array_index (r->keyword, count));
 
-                    end = e;
-                    _rule.end = e;
-                    _rule.keyword = count;
-                    keyword_foundright = TRUE;
-                    break;
-                }
+            /* when both context and keyword terminate with a newline,
+               the context overflows to the next line and colorizes it incorrectly */
+            if (e > i + 1 && _rule._context != 0 && k->keyword[strlen (k->keyword) - 1] == '\n')
+            {
+                r = CONTEXT_RULE (g_ptr_array_index (edit->rules, _rule._context));
+                if (r->right != NULL && r->right[0] != '\0'
+                    && r->right[strlen (r->right) - 1] == '\n')
+                    e--;
             }
+
+            end = e;
+            _rule.end = e;
+            _rule.keyword = count;
+            keyword_foundright = TRUE;
+        }
     }
 
     /* check to turn on a context */
@@ -538,27 +881,15 @@ apply_rules_going_right (WEdit * edit, off_t i)
     /* check again to turn on a keyword if the context switched */
     if (contextchanged && _rule.keyword == 0)
     {
-        const char *p;
+        int count;
+        off_t e;
 
         r = CONTEXT_RULE (g_ptr_array_index (edit->rules, _rule.context));
-        p = r->keyword_first_chars;
-
-        while (*(p = xx_strchr (edit, (const unsigned char *) p + 1, c)) != '\0')
+        count = syntax_keyword_match (edit, r, i, c, &e);
+        if (count != 0)
         {
-            syntax_keyword_t *k;
-            int count;
-            off_t e;
-
-            count = p - r->keyword_first_chars;
-            k = SYNTAX_KEYWORD (g_ptr_array_index (r->keyword, count));
-            e = compare_word_to_right (edit, i, k->keyword, k->whole_word_chars_left,
-                                       k->whole_word_chars_right, k->line_start);
-            if (e > 0)
-            {
-                _rule.end = e;
-                _rule.keyword = count;
-                break;
-            }
+            _rule.end = e;
+            _rule.keyword = count;
         }
     }
 
@@ -567,61 +898,157 @@ apply_rules_going_right (WEdit * edit, off_t i)
 
 /* --------------------------------------------------------------------------------------------- */
 
+/**
+ * Find the first syntax checkpoint located beyond the offset.
+ *
+ * @param markers checkpoints sorted by offset
+ * @param offset byte offset
+ * @return index of the checkpoint, or length of array if there is no such checkpoint
+ */
+
+static guint
+syntax_marker_search (const GArray * markers, off_t offset)
+{
+    guint lo = 0, hi = markers->len;
+
+    while (lo < hi)
+    {
+        guint mid;
+
+        mid = lo + (hi - lo) / 2;
+        if (g_array_index (markers, syntax_marker_t, mid).offset <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+syntax_marker_is_valid (const WEdit * edit, off_t offset)
+{
+    return (edit->syntax_dirty < 0 || offset < edit->syntax_dirty);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline gboolean
+syntax_rule_equal (const edit_syntax_rule_t * a, const edit_syntax_rule_t * b)
+{
+    return (a->keyword == b->keyword && a->end == b->end && a->context == b->context
+            && a->_context == b->_context && a->border == b->border);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Restore the rule state from the nearest valid checkpoint not beyond the offset.
+ */
+
 static void
-edit_get_rule (WEdit * edit, off_t byte_index)
+syntax_marker_restore (WEdit * edit, off_t offset)
 {
-    off_t i;
+    guint m;
 
-    if (byte_index > edit->last_get_rule)
+    if (edit->syntax_dirty >= 0)
+        offset = MIN (offset, edit->syntax_dirty - 1);
+
+    m = syntax_marker_search (edit->syntax_marker, offset);
+    if (m == 0)
     {
-        for (i = edit->last_get_rule + 1; i <= byte_index; i++)
-        {
-            off_t d = SYNTAX_MARKER_DENSITY;
+        /* state before the beginning of file */
+        memset (&edit->rule, 0, sizeof (edit->rule));
+        edit->last_get_rule = -2;
+    }
+    else
+    {
+        const syntax_marker_t *s;
 
-            apply_rules_going_right (edit, i);
+        s = &g_array_index (edit->syntax_marker, syntax_marker_t, m - 1);
+        edit->rule = s->rule;
+        edit->last_get_rule = s->offset;
+    }
+}
 
-            if (edit->syntax_marker != NULL)
-                d += ((syntax_marker_t *) edit->syntax_marker->data)->offset;
+/* --------------------------------------------------------------------------------------------- */
 
-            if (i > d)
-            {
-                syntax_marker_t *s;
+static void
+edit_get_rule (WEdit * edit, off_t byte_index)
+{
+    GArray *markers;
+    guint m;
+    off_t i, prev;
 
-                s = g_new (syntax_marker_t, 1);
-                s->offset = i;
-                s->rule = edit->rule;
-                edit->syntax_marker = g_slist_prepend (edit->syntax_marker, s);
-            }
-        }
+    if (edit->syntax_marker == NULL)
+    {
+        edit->syntax_marker = g_array_new (FALSE, FALSE, sizeof (syntax_marker_t));
+        edit->syntax_dirty = -1;
+        edit->last_get_rule = -2;
+        memset (&edit->rule, 0, sizeof (edit->rule));
     }
-    else if (byte_index < edit->last_get_rule)
+
+    markers = edit->syntax_marker;
+
+    if (byte_index < edit->last_get_rule)
+        syntax_marker_restore (edit, byte_index);
+    else
     {
-        while (TRUE)
+        /* skip the text between valid checkpoints instead of parsing it */
+        m = syntax_marker_search (markers, byte_index);
+        if (m != 0)
         {
-            syntax_marker_t *s;
+            const syntax_marker_t *s;
 
-            if (edit->syntax_marker == NULL)
-            {
-                memset (&edit->rule, 0, sizeof (edit->rule));
-                for (i = -1; i <= byte_index; i++)
-                    apply_rules_going_right (edit, i);
-                break;
-            }
+            s = &g_array_index (markers, syntax_marker_t, m - 1);
+            if (s->offset > edit->last_get_rule && syntax_marker_is_valid (edit, s->offset))
+                syntax_marker_restore (edit, byte_index);
+        }
+    }
+
+    m = syntax_marker_search (markers, edit->last_get_rule);
+    prev = m != 0 ? g_array_index (markers, syntax_marker_t, m - 1).offset : 0;
+
+    for (i = edit->last_get_rule + 1; i <= byte_index; i++)
+    {
+        apply_rules_going_right (edit, i);
 
-            s = (syntax_marker_t *) edit->syntax_marker->data;
+        if (m < markers->len && g_array_index (markers, syntax_marker_t, m).offset == i)
+        {
+            syntax_marker_t *s;
 
-            if (byte_index >= s->offset)
+            s = &g_array_index (markers, syntax_marker_t, m);
+            if (!syntax_marker_is_valid (edit, i))
             {
-                edit->rule = s->rule;
-                for (i = s->offset + 1; i <= byte_index; i++)
-                    apply_rules_going_right (edit, i);
-                break;
+                /* the rest of checkpoints are valid if the state converges beyond the changes */
+                if (i > edit->syntax_dirty_end && syntax_rule_equal (&s->rule, &edit->rule))
+                    edit->syntax_dirty = -1;
+                else
+                    s->rule = edit->rule;
             }
+            m++;
+            prev = i;
+        }
+        else if (i > prev + SYNTAX_MARKER_DENSITY)
+        {
+            syntax_marker_t s;
 
-            g_free (s);
-            edit->syntax_marker = g_slist_delete_link (edit->syntax_marker, edit->syntax_marker);
+            s.offset = i;
+            s.rule = edit->rule;
+            g_array_insert_val (markers, m, s);
+            m++;
+            prev = i;
         }
+
+        if (edit->syntax_dirty >= 0 && edit->syntax_dirty <= i)
+            edit->syntax_dirty = i + 1;
     }
+
+    /* the state didn't converge before the end of file: there are no more checkpoints to verify */
+    if (edit->syntax_dirty >= edit->buffer.size)
+        edit->syntax_dirty = -1;
+
     edit->last_get_rule = byte_index;
 }
 
@@ -871,55 +1298,107 @@ this_try_alloc_color_pair (const char *fg, const char *bg, const char *attrs)
 
 /* --------------------------------------------------------------------------------------------- */
 
-static FILE *
-open_include_file (const char *filename)
+inline static void
+xx_lowerize_line (WEdit * edit, char *line, size_t len)
 {
-    FILE *f;
-
-    g_free (error_file_name);
-    error_file_name = g_strdup (filename);
-    if (g_path_is_absolute (filename))
-        return fopen (filename, "r");
-
-    g_free (error_file_name);
-    error_file_name =
-        g_build_filename (mc_config_get_data_path (), EDIT_HOME_DIR, filename, (char *) NULL);
-    f = fopen (error_file_name, "r");
-    if (f != NULL)
-        return f;
+    if (edit->is_case_insensitive)
+    {
+        size_t i;
 
-    g_free (error_file_name);
-    error_file_name = g_build_filename (mc_global.sysconfig_dir, "syntax", filename, (char *) NULL);
-    f = fopen (error_file_name, "r");
-    if (f != NULL)
-        return f;
+        for (i = 0; i < len; ++i)
+            line[i] = tolower (line[i]);
+    }
+}
 
-    g_free (error_file_name);
-    error_file_name =
-        g_build_filename (mc_global.share_data_dir, "syntax", filename, (char *) NULL);
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Add keyword to the list of keywords.
+ */
 
-    return fopen (error_file_name, "r");
+static void
+syntax_keyword_list_add (GArray ** list, guint index)
+{
+    if (*list == NULL)
+        *list = g_array_new (FALSE, FALSE, sizeof (guint));
+    g_array_append_val (*list, index);
 }
 
 /* --------------------------------------------------------------------------------------------- */
+/**
+ * Compile keywords of context into the prefix tree.
+ */
 
-inline static void
-xx_lowerize_line (WEdit * edit, char *line, size_t len)
+static void
+syntax_keyword_tree_build (const WEdit * edit, context_rule_t * r)
 {
-    if (edit->is_case_insensitive)
+    guint j;
+
+    r->keyword_tree = g_array_new (FALSE, TRUE, sizeof (syntax_keyword_node_t));
+    g_array_set_size (r->keyword_tree, 1);
+
+    for (j = 1; j < r->keyword->len; j++)
     {
-        size_t i;
+        const unsigned char *p;
+        guint *node;
+        int depth;
 
-        for (i = 0; i < len; ++i)
-            line[i] = tolower (line[i]);
+        p = (const unsigned char *) SYNTAX_KEYWORD (g_ptr_array_index (r->keyword, j))->keyword;
+
+        /* keywords following the empty one were never reached */
+        if (*p == '\0')
+            break;
+
+        if (*p < '\005')
+        {
+            syntax_keyword_list_add (&r->keyword_wild, j);
+            continue;
+        }
+
+        node = &r->keyword_tree_root[xx_tolower (edit, *p)];
+
+        for (depth = 1;; depth++)
+        {
+            syntax_keyword_node_t *t;
+            guint index = *node;
+
+            if (index == 0)
+            {
+                syntax_keyword_node_t n;
+
+                memset (&n, 0, sizeof (n));
+                n.c = *p;
+                index = r->keyword_tree->len;
+                /* node points to the array being extended */
+                *node = index;
+                g_array_append_val (r->keyword_tree, n);
+            }
+
+            t = &g_array_index (r->keyword_tree, syntax_keyword_node_t, index);
+
+            p++;
+            if (*p < '\005' || depth == SYNTAX_KEYWORD_TREE_DEPTH)
+            {
+                syntax_keyword_list_add (&t->keywords, j);
+                break;
+            }
+
+            /* find the child for the next byte */
+            for (node = &t->child; *node != 0;)
+            {
+                t = &g_array_index (r->keyword_tree, syntax_keyword_node_t, *node);
+                if (t->c == *p)
+                    break;
+                node = &t->next;
+            }
+        }
     }
 }
 
 /* --------------------------------------------------------------------------------------------- */
-/** returns line number on error */
+/** returns line number on error; files included by rules are added to includes unless NULL */
 
 static int
-edit_read_syntax_rules (WEdit * edit, FILE * f, char **args, int args_size)
+edit_read_syntax_rules (WEdit * edit, FILE * f, char **args, int args_size, GSList ** includes)
 {
     FILE *g = NULL;
     char *fg, *bg, *attrs;
@@ -993,6 +1472,8 @@ edit_read_syntax_rules (WEdit * edit, FILE * f, char **args, int args_size)
                 result = line;
                 break;
             }
+            if (includes != NULL)
+                *includes = syntax_rules_include_add (*includes, args[1], f);
             save_line = line;
             line = 0;
         }
@@ -1216,34 +1697,12 @@ edit_read_syntax_rules (WEdit * edit, FILE * f, char **args, int args_size)
     if (result == 0)
     {
         size_t i;
-        GString *first_chars;
 
         if (edit->rules == NULL)
             return line;
 
-        first_chars = g_string_sized_new (32);
-
-        /* collect first character of keywords */
         for (i = 0; i < edit->rules->len; i++)
-        {
-            size_t j;
-
-            g_string_set_size (first_chars, 0);
-            c = CONTEXT_RULE (g_ptr_array_index (edit->rules, i));
-
-            g_string_append_c (first_chars, (char) 1);
-            for (j = 1; j < c->keyword->len; j++)
-            {
-                syntax_keyword_t *k;
-
-                k = SYNTAX_KEYWORD (g_ptr_array_index (c->keyword, j));
-                g_string_append_c (first_chars, k->keyword[0]);
-            }
-
-            c->keyword_first_chars = g_strndup (first_chars->str, first_chars->len);
-        }
-
-        g_string_free (first_chars, TRUE);
+            syntax_keyword_tree_build (edit, CONTEXT_RULE (g_ptr_array_index (edit->rules, i)));
     }
 
     return result;
@@ -1335,10 +1794,24 @@ edit_read_syntax_file (WEdit * edit, GPtrArray * pnames, const char *syntax_file
             {
                 int line_error;
                 char *syntax_type;
+                FILE *rules_file;
+                syntax_rules_cache_t key;
+                gboolean cached;
 
               found_type:
                 syntax_type = args[2];
-                line_error = edit_read_syntax_rules (edit, g ? g : f, args, ARGS_LEN - 1);
+                line_error = 0;
+                rules_file = g != NULL ? g : f;
+                cached = syntax_rules_cache_key (rules_file, &key);
+                if (!cached || !syntax_rules_cache_get (edit, &key))
+                {
+                    line_error = edit_read_syntax_rules (edit, rules_file, args, ARGS_LEN - 1,
+                                                         cached ? &key.includes : NULL);
+                    if (cached && line_error == 0)
+                        syntax_rules_cache_add (edit, &key);
+                    else if (cached)
+                        g_slist_free_full (key.includes, syntax_rules_include_free);
+                }
                 if (line_error != 0)
                 {
                     if (error_file_name == NULL)        /* an included file */
@@ -1425,6 +1898,162 @@ edit_get_syntax_color (WEdit * edit, off_t byte_index)
     return EDITOR_NORMAL_COLOR;
 }
 
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get syntax context of byte.
+ *
+ * @param edit editor object
+ * @param byte_index offset of byte
+ * @return index of context rule the byte belongs to, 0 for the default context or if there
+ *         is no syntax highlighting
+ */
+
+int
+edit_get_syntax_context (WEdit * edit, off_t byte_index)
+{
+    if (edit->rules == NULL || byte_index >= edit->buffer.size || !option_syntax_highlighting)
+        return 0;
+
+    edit_get_rule (edit, byte_index);
+    return edit->rule.context;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Get state of syntax parser after the byte.
+ *
+ * @param edit editor object
+ * @param byte_index offset of byte
+ * @param rule the state is returned here, zeroed if there is no syntax highlighting
+ */
+
+void
+edit_get_syntax_rule (WEdit * edit, off_t byte_index, edit_syntax_rule_t * rule)
+{
+    if (edit->rules == NULL || byte_index >= edit->buffer.size || !option_syntax_highlighting)
+        memset (rule, 0, sizeof (*rule));
+    else
+    {
+        edit_get_rule (edit, byte_index);
+        *rule = edit->rule;
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Update syntax checkpoints after the text was changed. Checkpoints inside the removed text are
+ * dropped, the following ones are shifted. Checkpoints from the beginning of the changed line
+ * are marked as dirty and are verified next time the text is parsed: parsing stops re-checking
+ * them as soon as the state beyond the changes matches the one stored in a checkpoint.
+ *
+ * @param edit editor object
+ * @param offset offset of the change
+ * @param deleted number of bytes removed at the offset
+ * @param inserted number of bytes inserted at the offset
+ */
+
+void
+edit_syntax_changed (WEdit * edit, off_t offset, off_t deleted, off_t inserted)
+{
+    GArray *markers = edit->syntax_marker;
+    off_t delta = inserted - deleted;
+    off_t start;
+    guint i, j;
+
+    if (edit->rules == NULL || markers == NULL)
+        return;
+
+    start = edit_buffer_get_bol (&edit->buffer, offset);
+
+    for (i = j = syntax_marker_search (markers, offset - 1); j < markers->len; j++)
+    {
+        syntax_marker_t *s;
+
+        s = &g_array_index (markers, syntax_marker_t, j);
+        if (s->offset < offset + deleted)
+            continue;
+
+        s->offset += delta;
+        if (s->rule.end >= offset)
+            s->rule.end = MAX (s->rule.end + delta, offset);
+        g_array_index (markers, syntax_marker_t, i++) = *s;
+    }
+
+    g_array_set_size (markers, i);
+    /* file could be truncated while loading */
+    g_array_set_size (markers, syntax_marker_search (markers, edit->buffer.size - 1));
+
+    if (edit->syntax_dirty < 0)
+        edit->syntax_dirty_end = offset + inserted;
+    else
+    {
+        if (edit->syntax_dirty_end >= offset)
+            edit->syntax_dirty_end = MAX (edit->syntax_dirty_end + delta, offset);
+        edit->syntax_dirty_end = MAX (edit->syntax_dirty_end, offset + inserted);
+        start = MIN (start, edit->syntax_dirty);
+    }
+    edit->syntax_dirty = start;
+
+    if (edit->last_get_rule >= start || edit->rule.end > offset)
+        syntax_marker_restore (edit, start - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check whether syntax checkpoints do not cover the whole file yet or have to be verified after
+ * the text was changed.
+ */
+
+gboolean
+edit_syntax_prescan_pending (const WEdit * edit)
+{
+    const GArray *markers = edit->syntax_marker;
+    off_t last;
+
+    if (!option_syntax_prescan || !option_syntax_highlighting || edit->rules == NULL
+        || edit->buffer.size == 0 || !tty_use_colors ())
+        return FALSE;
+
+    if (markers == NULL || edit->syntax_dirty >= 0)
+        return TRUE;
+
+    /* parsing to the end of file leaves no gap wider than the checkpoint density */
+    last = markers->len != 0 ? g_array_index (markers, syntax_marker_t, markers->len - 1).offset : 0;
+    return (last + SYNTAX_MARKER_DENSITY < edit->buffer.size - 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Parse the next part of text to populate syntax checkpoints ahead of display. Parsing starts
+ * from the first checkpoint to be verified after changes, or from the last checkpoint.
+ *
+ * @param edit editor object
+ * @param len number of bytes to parse
+ * @return TRUE if there is more text to parse
+ */
+
+gboolean
+edit_syntax_prescan (WEdit * edit, off_t len)
+{
+    off_t from = 0;
+
+    if (!edit_syntax_prescan_pending (edit))
+        return FALSE;
+
+    if (edit->syntax_marker != NULL)
+    {
+        if (edit->syntax_dirty >= 0)
+            from = edit->syntax_dirty;
+        else if (edit->syntax_marker->len != 0)
+            from = g_array_index (edit->syntax_marker, syntax_marker_t,
+                                  edit->syntax_marker->len - 1).offset;
+    }
+
+    edit_get_rule (edit, MIN (from + len, edit->buffer.size - 1));
+
+    return edit_syntax_prescan_pending (edit);
+}
+
 /* --------------------------------------------------------------------------------------------- */
 
 void
@@ -1439,14 +2068,15 @@ edit_free_syntax_rules (WEdit * edit)
     if (edit->rules == NULL)
         return;
 
-    edit_get_rule (edit, -1);
     MC_PTR_FREE (edit->syntax_type);
 
-    g_ptr_array_foreach (edit->rules, (GFunc) context_rule_free, NULL);
-    g_ptr_array_free (edit->rules, TRUE);
+    syntax_rules_cache_release (edit->rules);
     edit->rules = NULL;
-    g_clear_slist (&edit->syntax_marker, g_free);
-    tty_color_free_all_tmp ();
+    if (edit->syntax_marker != NULL)
+    {
+        g_array_free (edit->syntax_marker, TRUE);
+        edit->syntax_marker = NULL;
+    }
 }
 
 /* --------------------------------------------------------------------------------------------- */
@@ -1472,6 +2102,8 @@ edit_load_syntax (WEdit * edit, GPtrArray * pnames, const char *type)
         saved_type = g_strdup (type);   /* save edit->syntax_type */
         edit_free_syntax_rules (edit);
         edit->syntax_type = saved_type; /* restore edit->syntax_type */
+        /* rendered rows have colors of old rules */
+        edit_render_cache_clean (edit);
     }
 
     if (!tty_use_colors ())
@@ -349,6 +349,7 @@ static const struct
     { "editor_option_typewriter_wrap", &option_typewriter_wrap },
     { "editor_edit_confirm_save", &edit_confirm_save },
     { "editor_syntax_highlighting", &option_syntax_highlighting },
+    { "editor_syntax_prescan", &option_syntax_prescan },
     { "editor_persistent_selections", &option_persistent_selections },
     { "editor_drop_selection_on_copy", &option_drop_selection_on_copy },
     { "editor_cursor_beyond_eol", &option_cursor_beyond_eol },
@@ -360,6 +361,8 @@ static const struct
     { "editor_check_new_line", &option_check_nl_at_eof },
     { "editor_show_right_margin", &show_right_margin },
     { "editor_group_undo", &option_group_undo },
+    { "editor_persistent_undo", &option_persistent_undo },
+    { "editor_spell_on_the_fly", &option_spell_on_the_fly },
     { "editor_state_full_filename", &option_state_full_filename },
     { "editor_wordcompletion_collect_other_files", &option_completion_collect_other_files },
 #endif /* USE_INTERNAL_EDIT */
@@ -416,6 +419,8 @@ static const struct
                                    ".c,.cpp,.c++,.cc,.cp,.cxx,.c+"},
     { "editor_backup_extension", &option_backup_ext, "~" },
     { "editor_filesize_threshold", &option_filesize_threshold, "64M" },
+    { "editor_mmap_threshold", &option_mmap_threshold, "64M" },
+    { "editor_max_undo_size", &option_max_undo_size, "8M" },
     { "editor_stop_format_chars", &option_stop_format_chars, "-+*\\,.;:&>" },
 #endif
     { "mcview_eof", &mcview_show_eof, "" },
@@ -236,6 +236,68 @@ slang_api__cure_insert_ahead (int c)
 
 /* --------------------------------------------------------------------------------------------- */
 
+/*
+ * S-LANG FUNCTION: cure_get_range(start_idx, end_idx)
+ * RETURN VALUE: the bytes from start_idx up to end_idx (not included)
+ */
+
+char *
+slang_api__cure_get_range (int start_idx, int end_idx)
+{
+    return g_string_free (edit_buffer_get_range (&get_cure ()->buffer, start_idx, end_idx), FALSE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/*
+ * S-LANG FUNCTION: cure_insert_string(text)
+ * Inserts the text at the cursor as a single undo step and moves the cursor after it.
+ */
+
+void
+slang_api__cure_insert_string (const char *text)
+{
+    WEdit *e = get_cure ();
+
+    edit_push_key_press (e);
+    edit_insert_string (e, text, strlen (text));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/*
+ * S-LANG FUNCTION: cure_delete_range(start_idx, end_idx)
+ * Deletes the bytes from start_idx up to end_idx (not included) as a single undo step.
+ */
+
+void
+slang_api__cure_delete_range (int start_idx, int end_idx)
+{
+    WEdit *e = get_cure ();
+
+    edit_push_key_press (e);
+    edit_delete_range (e, start_idx, end_idx);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/*
+ * S-LANG FUNCTION: cure_replace_range(start_idx, end_idx, text)
+ * Replaces the bytes from start_idx up to end_idx (not included) with the text as a single
+ * undo step.
+ */
+
+void
+slang_api__cure_replace_range (int start_idx, int end_idx, const char *text)
+{
+    WEdit *e = get_cure ();
+
+    edit_push_key_press (e);
+    edit_replace_range (e, start_idx, end_idx, text, strlen (text));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
 /*
  * S-LANG FUNCTION: listbox( width, height, [ items…, NULL ], help_anchor )
  * RETURN VALUE: the index of the selected element or -1 if cancelled.
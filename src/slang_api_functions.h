@@ -22,11 +22,15 @@ int slang_api__cure_get_bol (void);
 /* Getting data from  buffer */
 char *slang_api__cure_get_left_whole_word (int skip_space);
 int slang_api__cure_get_byte (int byte_idx);
+char *slang_api__cure_get_range (int start_idx, int end_idx);
 
 /* Editing functions */
 int slang_api__cure_delete (void);
 int slang_api__cure_backspace (void);
 void slang_api__cure_insert_ahead (int c);
+void slang_api__cure_insert_string (const char *text);
+void slang_api__cure_delete_range (int start_idx, int end_idx);
+void slang_api__cure_replace_range (int start_idx, int end_idx, const char *text);
 
 /* Dialog functions */
 int slang_api__listbox (int h, int w, char *title, char **items, unsigned long size);
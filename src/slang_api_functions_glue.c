@@ -914,6 +914,107 @@ sl_cure_insert_ahead (void)
         Slirp_usage (16, 16, 0);
 }
 
+static void
+sl_cure_get_range (void)
+{
+    char *retval;
+    int arg1;
+    int arg2;
+    int issue_usage = 1;
+
+    if (SLang_Num_Function_Args != 2)
+        goto usage_label;
+    if (-1 == SLang_pop_int ((int *) &arg2))
+        goto usage_label;
+    if (-1 == SLang_pop_int ((int *) &arg1))
+        goto usage_label;
+    issue_usage = 0;
+
+    retval = slang_api__cure_get_range (arg1, arg2);
+    (void) SLang_push_malloced_string (retval);
+    goto free_and_return;
+  free_and_return:
+    /* drop */
+  usage_label:
+    if (issue_usage)
+        Slirp_usage (17, 17, 0);
+}
+
+static void
+sl_cure_insert_string (void)
+{
+    char *arg1;
+    int issue_usage = 1;
+
+    if (SLang_Num_Function_Args != 1)
+        goto usage_label;
+    if (-1 == SLang_pop_string ((char **) &arg1))
+        goto usage_label;
+    issue_usage = 0;
+
+    slang_api__cure_insert_string (arg1);
+    goto free_and_return;
+  free_and_return:
+    /* drop */
+    SLang_free_slstring (arg1);
+  usage_label:
+    if (issue_usage)
+        Slirp_usage (18, 18, 0);
+}
+
+static void
+sl_cure_delete_range (void)
+{
+    int arg1;
+    int arg2;
+    int issue_usage = 1;
+
+    if (SLang_Num_Function_Args != 2)
+        goto usage_label;
+    if (-1 == SLang_pop_int ((int *) &arg2))
+        goto usage_label;
+    if (-1 == SLang_pop_int ((int *) &arg1))
+        goto usage_label;
+    issue_usage = 0;
+
+    slang_api__cure_delete_range (arg1, arg2);
+    goto free_and_return;
+  free_and_return:
+    /* drop */
+  usage_label:
+    if (issue_usage)
+        Slirp_usage (19, 19, 0);
+}
+
+static void
+sl_cure_replace_range (void)
+{
+    int arg1;
+    int arg2;
+    char *arg3;
+    int issue_usage = 1;
+
+    if (SLang_Num_Function_Args != 3)
+        goto usage_label;
+    if (-1 == SLang_pop_string ((char **) &arg3))
+        goto usage_label;
+    if (-1 == SLang_pop_int ((int *) &arg2))
+        goto free_and_return_3;
+    if (-1 == SLang_pop_int ((int *) &arg1))
+        goto free_and_return_3;
+    issue_usage = 0;
+
+    slang_api__cure_replace_range (arg1, arg2, arg3);
+    goto free_and_return;
+  free_and_return:
+    /* drop */
+  free_and_return_3:
+    SLang_free_slstring (arg3);
+  usage_label:
+    if (issue_usage)
+        Slirp_usage (20, 20, 0);
+}
+
 
 static SLang_Intrin_Fun_Type slang_api_functions_Funcs[] = {
     MAKE_INTRINSIC_0 ((char *) "set_action_hook", sl_set_action_hook, SLANG_VOID_TYPE),
@@ -936,6 +1037,10 @@ static SLang_Intrin_Fun_Type slang_api_functions_Funcs[] = {
     MAKE_INTRINSIC_0 ((char *) "listbox_auto", sl_listbox_auto, SLANG_VOID_TYPE),
     MAKE_INTRINSIC_0 ((char *) "cure_get_byte", sl_cure_get_byte, SLANG_VOID_TYPE),
     MAKE_INTRINSIC_0 ((char *) "cure_insert_ahead", sl_cure_insert_ahead, SLANG_VOID_TYPE),
+    MAKE_INTRINSIC_0 ((char *) "cure_get_range", sl_cure_get_range, SLANG_VOID_TYPE),
+    MAKE_INTRINSIC_0 ((char *) "cure_insert_string", sl_cure_insert_string, SLANG_VOID_TYPE),
+    MAKE_INTRINSIC_0 ((char *) "cure_delete_range", sl_cure_delete_range, SLANG_VOID_TYPE),
+    MAKE_INTRINSIC_0 ((char *) "cure_replace_range", sl_cure_replace_range, SLANG_VOID_TYPE),
     SLANG_END_INTRIN_FUN_TABLE
 };                              /* }}} */
 
@@ -957,6 +1062,10 @@ static const char *usage_strings[] = {  /* {{{ */
     "int = listbox_auto(string,string[])",
     "int = cure_get_byte(int)",
     "cure_insert_ahead(int)",
+    "string = cure_get_range(int,int)",
+    "cure_insert_string(string)",
+    "cure_delete_range(int,int)",
+    "cure_replace_range(int,int,string)",
     NULL
 };                              /* }}} */
 
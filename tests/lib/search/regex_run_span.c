@@ -0,0 +1,148 @@
+/*
+   libmc - checks for searching data provided by spans
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "lib/search/regex"
+
+#include "tests/mctest.h"
+
+#include "lib/search.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* data is split into spans of this size */
+#define SPAN_SIZE 3
+
+static const char test_data[] = "foo bar\nbaz qux foo\n\nlast line foo bar";
+
+/* --------------------------------------------------------------------------------------------- */
+
+static mc_search_cbret_t
+test_search_fn (const void *user_data, gsize char_offset, int *current_char)
+{
+    const char *data = (const char *) user_data;
+
+    *current_char = char_offset < strlen (data) ? (unsigned char) data[char_offset] : '\n';
+
+    return MC_SEARCH_CB_OK;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static const char *
+test_span_fn (const void *user_data, gsize char_offset, gsize * len)
+{
+    const char *data = (const char *) user_data;
+    gsize data_len;
+
+    data_len = strlen (data);
+    if (char_offset >= data_len)
+    {
+        *len = 0;
+        return NULL;
+    }
+
+    *len = MIN (SPAN_SIZE - char_offset % SPAN_SIZE, data_len - char_offset);
+
+    return data + char_offset;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_regex_run_span_ds") */
+/* *INDENT-OFF* */
+static const struct test_regex_run_span_ds
+{
+    const char *pattern;
+    mc_search_type_t type;
+    gsize start;
+    gsize end;
+} test_regex_run_span_ds[] =
+{
+    { "foo", MC_SEARCH_T_NORMAL, 0, sizeof (test_data) - 1 },
+    { "foo", MC_SEARCH_T_NORMAL, 1, sizeof (test_data) - 1 },
+    { "foo", MC_SEARCH_T_NORMAL, 17, sizeof (test_data) - 1 },
+    { "foo", MC_SEARCH_T_NORMAL, 1, 18 },
+    { "foo", MC_SEARCH_T_NORMAL, 1, 19 },
+    { "bar$", MC_SEARCH_T_REGEX, 0, sizeof (test_data) - 1 },
+    { "bar$", MC_SEARCH_T_REGEX, 6, 8 },
+    { "^$", MC_SEARCH_T_REGEX, 0, sizeof (test_data) - 1 },
+    { "^l[a-z]+", MC_SEARCH_T_REGEX, 0, sizeof (test_data) - 1 },
+    { "x{2}", MC_SEARCH_T_REGEX, 0, sizeof (test_data) - 1 },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_regex_run_span_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_regex_run_span, test_regex_run_span_ds)
+/* *INDENT-ON* */
+{
+    /* given */
+    mc_search_t *search;
+    gboolean expected_result, actual_result;
+    gsize expected_len = 0, actual_len = 0;
+    off_t expected_offset;
+
+    search = mc_search_new (data->pattern, NULL);
+    search->search_type = data->type;
+    search->is_case_sensitive = TRUE;
+    search->search_fn = test_search_fn;
+
+    expected_result = mc_search_run (search, test_data, data->start, data->end, &expected_len);
+    expected_offset = search->normal_offset;
+
+    /* when */
+    search->span_fn = test_span_fn;
+    actual_result = mc_search_run (search, test_data, data->start, data->end, &actual_len);
+
+    /* then */
+    mctest_assert_int_eq (actual_result, expected_result);
+    if (expected_result)
+    {
+        mctest_assert_int_eq (search->normal_offset, expected_offset);
+        mctest_assert_int_eq (actual_len, expected_len);
+    }
+    else
+        mctest_assert_int_eq (search->error, MC_SEARCH_E_NOTFOUND);
+
+    mc_search_free (search);
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_regex_run_span, test_regex_run_span_ds);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,58 @@
+/*
+   Common code for tests of indexes kept along with editor buffer.
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* state of pseudo-random numbers, the same sequence is generated on every run */
+static guint32 test_random_seed = 1;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* get pseudo-random number in range [0, n) */
+static inline guint
+test_random (guint n)
+{
+    test_random_seed = test_random_seed * 1103515245 + 12345;
+    return (test_random_seed >> 16) % n;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline void
+test_buffer_insert (edit_buffer_t * buf, off_t offset, const char *text, gsize len)
+{
+    edit_buffer_move_gap (buf, offset - buf->curs1);
+    edit_buffer_insert_string (buf, text, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static inline void
+test_buffer_delete (edit_buffer_t * buf, off_t offset, off_t len)
+{
+    edit_buffer_move_gap (buf, offset - buf->curs1);
+    edit_buffer_delete_bytes (buf, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,224 @@
+/*
+   src/editor - tests for index of brackets of editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/editwidget.h"
+#include "src/editor/editbracket.h"
+
+#include "edit__common.c"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static WEdit edit;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+fill_buffer (const GString * text)
+{
+    edit_buffer_init (&edit.buffer, 0);
+    test_buffer_insert (&edit.buffer, 0, text->str, text->len);
+    edit_brackets_init (&edit.brackets);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static GString *
+make_text (gsize len)
+{
+    GString *text;
+
+    text = g_string_sized_new (len);
+
+    while (text->len < len)
+        g_string_append_c (text, "{}[]()ab\n{(["[test_random (12)]);
+
+    return text;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Find matching bracket without the index.
+ */
+
+static off_t
+find_match (off_t offset, off_t start, off_t finish)
+{
+    const char *const b = "{}{[][()(", *p;
+    int c, d, inc = -1, depth = 1;
+    off_t q;
+
+    c = edit_buffer_get_byte (&edit.buffer, offset);
+    p = strchr (b, c);
+    if (c == '\0' || p == NULL)
+        return -1;
+
+    d = p[1];
+    if (strchr ("{[(", c) != NULL)
+        inc = 1;
+
+    for (q = offset + inc; q >= start && q < finish; q += inc)
+    {
+        int a;
+
+        a = edit_buffer_get_byte (&edit.buffer, q);
+        depth += (a == c) - (a == d);
+        if (depth == 0)
+            return q;
+    }
+
+    return -1;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_matches (off_t step)
+{
+    off_t offset;
+
+    for (offset = 0; offset < edit.buffer.size; offset += step)
+    {
+        mctest_assert_int_eq (edit_brackets_find (&edit, offset, 0, edit.buffer.size),
+                              find_match (offset, 0, edit.buffer.size));
+        mctest_assert_int_eq (edit_brackets_find (&edit, offset, offset - 5000, offset + 7000),
+                              find_match (offset, MAX (offset - 5000, 0),
+                                          MIN (offset + 7000, edit.buffer.size)));
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_text (off_t offset, const char *text)
+{
+    test_buffer_insert (&edit.buffer, offset, text, strlen (text));
+    edit_brackets_update (&edit.brackets, offset, 0, (off_t) strlen (text));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+delete_text (off_t offset, off_t len)
+{
+    test_buffer_delete (&edit.buffer, offset, len);
+    edit_brackets_update (&edit.brackets, offset, len, 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_brackets_clean (&edit.brackets);
+    edit_buffer_clean (&edit.buffer);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_brackets_find)
+/* *INDENT-ON* */
+{
+    GString *text;
+
+    /* given */
+    text = make_text (100000);
+    fill_buffer (text);
+    g_string_free (text, TRUE);
+
+    /* then */
+    mctest_assert_int_eq (edit_brackets_find (&edit, -1, 0, edit.buffer.size), -1);
+    mctest_assert_int_eq (edit_brackets_find (&edit, edit.buffer.size, 0, edit.buffer.size), -1);
+    check_matches (37);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_brackets_update)
+/* *INDENT-ON* */
+{
+    GString *text;
+
+    /* given */
+    text = make_text (60000);
+    fill_buffer (text);
+    check_matches (101);
+
+    /* when: small changes */
+    insert_text (5, "((");
+    delete_text (20000, 3);
+    insert_text (edit.buffer.size, "}}");
+    insert_text (0, "{");
+    /* then */
+    check_matches (53);
+
+    /* when: changes across several chunks */
+    delete_text (1000, 20000);
+    insert_text (30000, text->str);
+    delete_text (0, 4096);
+    /* then */
+    check_matches (97);
+
+    /* when: delete all */
+    delete_text (0, edit.buffer.size);
+    insert_text (0, "(])");
+    /* then */
+    mctest_assert_int_eq (edit_brackets_find (&edit, 0, 0, edit.buffer.size), 2);
+    mctest_assert_int_eq (edit_brackets_find (&edit, 1, 0, edit.buffer.size), -1);
+
+    g_string_free (text, TRUE);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, NULL, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_brackets_find);
+    tcase_add_test (tc_core, test_edit_brackets_update);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
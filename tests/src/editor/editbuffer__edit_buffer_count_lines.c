@@ -0,0 +1,184 @@
+/*
+   src/editor - tests for line index of editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static GString *etalon;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static off_t
+etalon_get_line_offset (long line)
+{
+    off_t i;
+
+    for (i = 0; line > 0 && i < (off_t) etalon->len; i++)
+        if (etalon->str[i] == '\n')
+            line--;
+
+    return i;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_buffer (void)
+{
+    long line, lines = 0;
+    off_t i;
+
+    for (i = 0; i < (off_t) etalon->len; i++)
+        if (etalon->str[i] == '\n')
+            lines++;
+
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 0, buf.size), lines);
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 100, buf.size - 100),
+                          lines - (edit_buffer_count_lines (&buf, 0, 100)
+                                   + edit_buffer_count_lines (&buf, buf.size - 100, buf.size)));
+
+    for (line = 0; line < lines; line += 997)
+    {
+        off_t offset;
+
+        offset = etalon_get_line_offset (line);
+        mctest_assert_int_eq (edit_buffer_get_forward_offset (&buf, 0, line, 0), offset);
+        mctest_assert_int_eq (edit_buffer_get_backward_offset (&buf, buf.size, lines - line),
+                              offset);
+    }
+
+    for (i = 0; i < (off_t) etalon->len; i += 4099)
+    {
+        off_t bol, eol;
+
+        for (bol = i; bol > 0 && etalon->str[bol - 1] != '\n'; bol--)
+            ;
+        for (eol = i; eol < (off_t) etalon->len && etalon->str[eol] != '\n'; eol++)
+            ;
+
+        mctest_assert_int_eq (edit_buffer_get_bol (&buf, i), bol);
+        mctest_assert_int_eq (edit_buffer_get_eol (&buf, i), eol);
+    }
+
+    /* move beyond the end of file */
+    mctest_assert_int_eq (edit_buffer_get_forward_offset (&buf, 0, lines + 100, 0),
+                          etalon_get_line_offset (lines));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    off_t i;
+
+    etalon = g_string_new (NULL);
+    edit_buffer_init (&buf, 0);
+
+    for (i = 0; i < 5 * BLOCK_SIZE + 123; i++)
+    {
+        char c;
+
+        c = (i % 23 == 22 || i % 101 == 100) ? '\n' : 'a' + i % 26;
+        g_string_append_c (etalon, c);
+        edit_buffer_insert (&buf, c);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_string_free (etalon, TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_buffer_count_lines)
+/* *INDENT-ON* */
+{
+    off_t i;
+
+    /* when */
+    edit_buffer_move_gap (&buf, -3 * BLOCK_SIZE - 7);
+    /* then */
+    check_buffer ();
+
+    /* when: modify the buffer while line index is in use */
+    for (i = 0; i < 1000; i++)
+        edit_buffer_insert (&buf, '\n');
+    for (i = 0; i < 1000; i++)
+        g_string_insert_c (etalon, buf.curs1 - 1000, '\n');
+    for (i = 0; i < 50; i++)
+    {
+        g_string_erase (etalon, buf.curs1, 1);
+        edit_buffer_delete (&buf);
+    }
+    edit_buffer_move_gap (&buf, 2 * BLOCK_SIZE);
+    for (i = 0; i < 70; i++)
+    {
+        g_string_erase (etalon, buf.curs1 - 1, 1);
+        edit_buffer_backspace (&buf);
+    }
+    edit_buffer_move_gap (&buf, -BLOCK_SIZE);
+    /* then */
+    check_buffer ();
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_buffer_count_lines);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
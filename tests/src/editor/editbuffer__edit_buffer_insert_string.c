@@ -0,0 +1,144 @@
+/*
+   src/editor - tests for insertion of strings into editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static GString *etalon;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_buffer (void)
+{
+    long lines = 0;
+    off_t i;
+
+    mctest_assert_int_eq (buf.size, (off_t) etalon->len);
+
+    for (i = 0; i < (off_t) etalon->len; i++)
+    {
+        mctest_assert_int_eq (edit_buffer_get_byte (&buf, i), (unsigned char) etalon->str[i]);
+        if (etalon->str[i] == '\n')
+            lines++;
+    }
+
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 0, buf.size), lines);
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 0, buf.curs1),
+                          edit_buffer_count_lines (&buf, 0, BLOCK_SIZE)
+                          + edit_buffer_count_lines (&buf, BLOCK_SIZE, buf.curs1));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_string (const char *text, gsize len)
+{
+    g_string_insert_len (etalon, buf.curs1, text, len);
+    edit_buffer_insert_string (&buf, text, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    etalon = g_string_new (NULL);
+    edit_buffer_init (&buf, 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_string_free (etalon, TRUE);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_buffer_insert_string)
+/* *INDENT-ON* */
+{
+    GString *text;
+    off_t i;
+
+    /* given */
+    text = g_string_new (NULL);
+    for (i = 0; i < 3 * BLOCK_SIZE + 17; i++)
+        g_string_append_c (text, (i % 23 == 22 || i % 101 == 100) ? '\n' : 'a' + i % 26);
+
+    /* when: strings crossing block boundaries */
+    insert_string (text->str, 100);
+    insert_string (text->str, BLOCK_SIZE - 100);
+    insert_string (text->str, text->len);
+    /* then */
+    check_buffer ();
+
+    /* when: insert in the middle with line index in use */
+    edit_buffer_move_gap (&buf, -2 * BLOCK_SIZE - 5);
+    insert_string ("\n\0\n", 3);
+    insert_string (text->str, 2 * BLOCK_SIZE);
+    insert_string ("", 0);
+    /* then */
+    check_buffer ();
+
+    g_string_free (text, TRUE);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_buffer_insert_string);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,185 @@
+/*
+   src/editor - tests for edit_buffer_load_part() function
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static GString *etalon;
+static char test_file_name[64];
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_buffer (void)
+{
+    off_t i;
+
+    mctest_assert_int_eq (buf.curs1 + buf.curs2, (off_t) etalon->len);
+    mctest_assert_int_eq (buf.size, (off_t) etalon->len);
+    mctest_assert_int_eq (buf.b1->len, (buf.curs1 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    mctest_assert_int_eq (buf.b2->len, (buf.curs2 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    for (i = 0; i < (off_t) etalon->len; i++)
+        mctest_assert_int_eq (edit_buffer_get_byte (&buf, i), (unsigned char) etalon->str[i]);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_string_free (etalon, TRUE);
+    unlink (test_file_name);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_edit_buffer_load_part_ds") */
+/* *INDENT-OFF* */
+static const struct test_edit_buffer_load_part_ds
+{
+    off_t size;
+    off_t reported_size;
+    gboolean stop;
+} test_edit_buffer_load_part_ds[] =
+{
+    {   /* 0. file is loaded completely */
+        3 * BLOCK_SIZE + 321,
+        3 * BLOCK_SIZE + 321,
+        FALSE
+    },
+    {   /* 1. file is shorter than reported */
+        2 * BLOCK_SIZE + 321,
+        3 * BLOCK_SIZE,
+        FALSE
+    },
+    {   /* 2. file is longer than reported */
+        3 * BLOCK_SIZE + 321,
+        2 * BLOCK_SIZE + 7,
+        FALSE
+    },
+    {   /* 3. loading is stopped */
+        3 * BLOCK_SIZE + 321,
+        3 * BLOCK_SIZE + 321,
+        TRUE
+    },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_edit_buffer_load_part_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_buffer_load_part, test_edit_buffer_load_part_ds)
+/* *INDENT-ON* */
+{
+    int fd;
+    off_t i;
+    off_t loaded;
+
+    /* given */
+    etalon = g_string_sized_new (data->size);
+    for (i = 0; i < data->size; i++)
+        g_string_append_c (etalon, (i % 41 == 40) ? '\n' : 'a' + i % 26);
+
+    strcpy (test_file_name, "editbuffer__edit_buffer_load_part.XXXXXX");
+    fd = mkstemp (test_file_name);
+    mctest_assert_true (fd >= 0);
+    mctest_assert_int_eq (write (fd, etalon->str, etalon->len), (ssize_t) etalon->len);
+    lseek (fd, 0, SEEK_SET);
+
+    edit_buffer_init (&buf, data->reported_size);
+    buf.curs_line = 0;
+
+    /* when */
+    edit_buffer_load_start (&buf);
+    loaded = edit_buffer_load_part (&buf, fd, BLOCK_SIZE + 100);
+
+    /* then: unloaded part consists of newlines */
+    mctest_assert_int_eq (loaded, BLOCK_SIZE + 100);
+    mctest_assert_true (edit_buffer_loading_pending (&buf));
+    mctest_assert_true (edit_buffer_lines_pending (&buf));
+    mctest_assert_int_eq (buf.lines, edit_buffer_count_lines (&buf, 0, buf.size));
+    mctest_assert_int_eq (edit_buffer_get_byte (&buf, loaded - 1),
+                          (unsigned char) etalon->str[loaded - 1]);
+    mctest_assert_int_eq (edit_buffer_get_byte (&buf, loaded), '\n');
+
+    /* when: move the cursor within the loaded part */
+    edit_buffer_move_gap (&buf, loaded - 10);
+    edit_buffer_move_gap (&buf, -BLOCK_SIZE);
+
+    if (data->stop)
+    {
+        edit_buffer_load_stop (&buf);
+        g_string_truncate (etalon, loaded);
+    }
+    else
+    {
+        while (edit_buffer_loading_pending (&buf))
+            mctest_assert_true (edit_buffer_load_part (&buf, fd, BLOCK_SIZE / 2) >= 0);
+    }
+    close (fd);
+
+    /* then */
+    mctest_assert_false (edit_buffer_lines_pending (&buf));
+    mctest_assert_int_eq (buf.curs1, loaded - 10 - BLOCK_SIZE);
+    mctest_assert_int_eq (buf.curs_line, edit_buffer_count_lines (&buf, 0, buf.curs1));
+    mctest_assert_int_eq (buf.lines, edit_buffer_count_lines (&buf, 0, buf.size));
+    check_buffer ();
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, NULL, teardown);
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_edit_buffer_load_part,
+                                   test_edit_buffer_load_part_ds);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
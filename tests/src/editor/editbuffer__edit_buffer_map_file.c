@@ -0,0 +1,231 @@
+/*
+   src/editor - tests for edit_buffer_map_file() function
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static GString *etalon;
+static char test_file_name[64];
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_buffer (void)
+{
+    off_t i;
+
+    mctest_assert_int_eq (buf.curs1 + buf.curs2, (off_t) etalon->len);
+    mctest_assert_int_eq (buf.size, (off_t) etalon->len);
+    mctest_assert_int_eq (buf.b1->len, (buf.curs1 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    mctest_assert_int_eq (buf.b2->len, (buf.curs2 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    for (i = 0; i < (off_t) etalon->len; i++)
+        mctest_assert_int_eq (edit_buffer_get_byte (&buf, i), (unsigned char) etalon->str[i]);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* write file of lines of 40 letters, map it into buffer and return the number of lines */
+static long
+map_test_file (off_t size)
+{
+    int fd;
+    off_t i;
+    long lines = 0;
+
+    etalon = g_string_sized_new (size);
+    for (i = 0; i < size; i++)
+    {
+        char c;
+
+        c = (i % 41 == 40) ? '\n' : 'a' + i % 26;
+        g_string_append_c (etalon, c);
+        if (c == '\n')
+            lines++;
+    }
+
+    strcpy (test_file_name, "editbuffer__edit_buffer_map_file.XXXXXX");
+    fd = mkstemp (test_file_name);
+    mctest_assert_true (fd >= 0);
+    mctest_assert_int_eq (write (fd, etalon->str, etalon->len), (ssize_t) etalon->len);
+
+    edit_buffer_init (&buf, size);
+    buf.curs_line = 0;
+
+    mctest_assert_true (edit_buffer_map_file (&buf, fd, size));
+    close (fd);
+
+    return lines;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_string_free (etalon, TRUE);
+    unlink (test_file_name);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_edit_buffer_map_file_ds") */
+/* *INDENT-OFF* */
+static const struct test_edit_buffer_map_file_ds
+{
+    off_t size;
+    off_t insert_pos;
+} test_edit_buffer_map_file_ds[] =
+{
+    {   /* 0. aligned file */
+        3 * BLOCK_SIZE,
+        BLOCK_SIZE
+    },
+    {   /* 1. unaligned file */
+        2 * BLOCK_SIZE + 321,
+        BLOCK_SIZE + 100
+    },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_edit_buffer_map_file_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_buffer_map_file, test_edit_buffer_map_file_ds)
+/* *INDENT-ON* */
+{
+    long lines;
+
+    /* when */
+    lines = map_test_file (data->size);
+
+    /* then */
+    check_buffer ();
+    mctest_assert_int_eq (buf.lines, data->size);
+    mctest_assert_true (edit_buffer_lines_pending (&buf));
+
+    while (edit_buffer_count_mapped_lines (&buf, BLOCK_SIZE / 2))
+        ;
+    mctest_assert_int_eq (buf.lines, lines);
+    mctest_assert_false (edit_buffer_lines_pending (&buf));
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 0, data->size), lines);
+
+    /* when: modify the mapped blocks */
+    edit_buffer_move_gap (&buf, data->insert_pos);
+    edit_buffer_insert (&buf, 'X');
+    edit_buffer_insert_ahead (&buf, 'Y');
+    g_string_insert_c (etalon, data->insert_pos, 'X');
+    g_string_insert_c (etalon, data->insert_pos + 1, 'Y');
+    edit_buffer_move_gap (&buf, 2 * BLOCK_SIZE);
+    edit_buffer_backspace (&buf);
+    g_string_erase (etalon, buf.curs1, 1);
+    edit_buffer_move_gap (&buf, -buf.curs1);
+    edit_buffer_delete (&buf);
+    g_string_erase (etalon, 0, 1);
+
+    /* then */
+    check_buffer ();
+
+    /* when */
+    edit_buffer_unmap (&buf);
+
+    /* then */
+    mctest_assert_null (buf.map);
+    check_buffer ();
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test(dataSource = "test_edit_buffer_map_file_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_buffer_map_file_truncated, test_edit_buffer_map_file_ds)
+/* *INDENT-ON* */
+{
+    off_t i;
+
+    /* given */
+    (void) map_test_file (data->size);
+
+    /* when: another process truncates the file */
+    mctest_assert_int_eq (truncate (test_file_name, data->insert_pos), 0);
+    while (edit_buffer_count_mapped_lines (&buf, BLOCK_SIZE / 2))
+        ;
+
+    /* then: lost part of file is read as null bytes instead of killing the process */
+    mctest_assert_true (edit_buffer_map_truncated (&buf));
+    for (i = data->insert_pos; i < data->size; i++)
+        etalon->str[i] = '\0';
+    check_buffer ();
+
+    /* when */
+    edit_buffer_unmap (&buf);
+
+    /* then */
+    mctest_assert_null (buf.map);
+    mctest_assert_false (edit_buffer_map_truncated (&buf));
+    check_buffer ();
+    mctest_assert_int_eq (buf.lines, (long) (data->insert_pos / 41));
+    mctest_assert_int_eq (edit_buffer_count_lines (&buf, 0, data->size), buf.lines);
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, NULL, teardown);
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_edit_buffer_map_file,
+                                   test_edit_buffer_map_file_ds);
+    mctest_add_parameterized_test (tc_core, test_edit_buffer_map_file_truncated,
+                                   test_edit_buffer_map_file_ds);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
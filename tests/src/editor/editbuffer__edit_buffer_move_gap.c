@@ -0,0 +1,245 @@
+/*
+   src/editor - tests for edit_buffer_move_gap() function
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static char *etalon;
+static off_t etalon_size;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+fill_buffer (off_t size)
+{
+    off_t i;
+
+    etalon_size = size;
+    etalon = g_malloc (size + 1);
+
+    for (i = 0; i < size; i++)
+        etalon[i] = (i % 37 == 36) ? '\n' : 'a' + i % 26;
+
+    edit_buffer_init (&buf, 0);
+    buf.curs_line = 0;
+
+    for (i = size - 1; i >= 0; i--)
+        edit_buffer_insert_ahead (&buf, etalon[i]);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_buffer (off_t curs1)
+{
+    off_t i;
+    long lines = 0;
+
+    mctest_assert_int_eq (buf.curs1, curs1);
+    mctest_assert_int_eq (buf.curs1 + buf.curs2, etalon_size);
+    mctest_assert_int_eq (buf.b1->len, (buf.curs1 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    mctest_assert_int_eq (buf.b2->len, (buf.curs2 + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    for (i = 0; i < etalon_size; i++)
+        mctest_assert_int_eq (edit_buffer_get_byte (&buf, i), (unsigned char) etalon[i]);
+
+    for (i = 0; i < curs1; i++)
+        if (etalon[i] == '\n')
+            lines++;
+
+    mctest_assert_int_eq (buf.curs_line, lines);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_free (etalon);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_edit_buffer_move_gap_ds") */
+/* *INDENT-OFF* */
+static const struct test_edit_buffer_move_gap_ds
+{
+    off_t size;
+    off_t moves[4];
+} test_edit_buffer_move_gap_ds[] =
+{
+    {   /* 0. small file */
+        100,
+        { 1, 50, -20, 1000 }
+    },
+    {   /* 1. both cursors are aligned to block size */
+        4 * BLOCK_SIZE,
+        { BLOCK_SIZE, 2 * BLOCK_SIZE, -3 * BLOCK_SIZE, 4 * BLOCK_SIZE }
+    },
+    {   /* 2. unaligned file */
+        3 * BLOCK_SIZE + 123,
+        { BLOCK_SIZE + 1, 2 * BLOCK_SIZE, -BLOCK_SIZE - 77, -10 * BLOCK_SIZE }
+    },
+    {   /* 3. short moves across block boundary */
+        2 * BLOCK_SIZE + 5,
+        { BLOCK_SIZE - 3, 7, -9, 3 }
+    },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_edit_buffer_move_gap_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_buffer_move_gap, test_edit_buffer_move_gap_ds)
+/* *INDENT-ON* */
+{
+    size_t i;
+    off_t curs1 = 0;
+
+    /* given */
+    fill_buffer (data->size);
+
+    for (i = 0; i < G_N_ELEMENTS (data->moves); i++)
+    {
+        off_t expected, actual;
+
+        expected = MAX (0, MIN (etalon_size, curs1 + data->moves[i])) - curs1;
+
+        /* when */
+        actual = edit_buffer_move_gap (&buf, data->moves[i]);
+        curs1 += expected;
+
+        /* then */
+        mctest_assert_int_eq (actual, expected);
+        check_buffer (curs1);
+    }
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_buffer_pool)
+/* *INDENT-ON* */
+{
+    const edit_buffer_pool_stats_t *stats;
+    gsize allocated, reused;
+
+    /* given */
+    fill_buffer (3 * BLOCK_SIZE);
+    edit_buffer_move_gap (&buf, BLOCK_SIZE + 10);
+    edit_buffer_clean (&buf);
+    g_free (etalon);
+
+    stats = edit_buffer_get_pool_stats ();
+    allocated = stats->allocated;
+    reused = stats->reused;
+    mctest_assert_true (stats->cached >= 3);
+
+    /* when */
+    fill_buffer (3 * BLOCK_SIZE);
+
+    /* then: released blocks are reused */
+    mctest_assert_int_eq (stats->allocated, allocated);
+    mctest_assert_int_eq (stats->reused, reused + 3);
+    check_buffer (0);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_buffer_get_range)
+/* *INDENT-ON* */
+{
+    GString *range;
+
+    /* given: gap in the middle of a block */
+    fill_buffer (3 * BLOCK_SIZE + 100);
+    edit_buffer_move_gap (&buf, BLOCK_SIZE + 10);
+
+    /* when: range spans the gap and block boundaries */
+    range = edit_buffer_get_range (&buf, 5, 2 * BLOCK_SIZE + 50);
+
+    /* then */
+    mctest_assert_int_eq (range->len, 2 * BLOCK_SIZE + 45);
+    mctest_assert_int_eq (memcmp (range->str, etalon + 5, range->len), 0);
+    g_string_free (range, TRUE);
+
+    /* when: range is clamped to the buffer */
+    range = edit_buffer_get_range (&buf, etalon_size - 3, etalon_size + 10);
+
+    /* then */
+    mctest_assert_int_eq (range->len, 3);
+    mctest_assert_int_eq (memcmp (range->str, etalon + etalon_size - 3, 3), 0);
+    g_string_free (range, TRUE);
+
+    /* when: empty range */
+    range = edit_buffer_get_range (&buf, 10, 10);
+
+    /* then */
+    mctest_assert_int_eq (range->len, 0);
+    g_string_free (range, TRUE);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, NULL, teardown);
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_edit_buffer_move_gap,
+                                   test_edit_buffer_move_gap_ds);
+    tcase_add_test (tc_core, test_edit_buffer_pool);
+    tcase_add_test (tc_core, test_edit_buffer_get_range);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
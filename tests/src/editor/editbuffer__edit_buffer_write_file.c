@@ -0,0 +1,171 @@
+/*
+   src/editor - tests for edit_buffer_write_file() function
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "lib/strutil.h"
+
+#include "src/vfs/local/local.c"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* block size of editor buffer */
+#define BLOCK_SIZE 65536
+
+static edit_buffer_t buf;
+static GString *etalon;
+static char test_file_name[64];
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    str_init_strings (NULL);
+
+    vfs_init ();
+    vfs_init_localfs ();
+    vfs_setup_work_dir ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_buffer_clean (&buf);
+    g_string_free (etalon, TRUE);
+    unlink (test_file_name);
+
+    vfs_shut ();
+
+    str_uninit_strings ();
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_edit_buffer_write_file_ds") */
+/* *INDENT-OFF* */
+static const struct test_edit_buffer_write_file_ds
+{
+    off_t size;
+    off_t cursor;
+} test_edit_buffer_write_file_ds[] =
+{
+    {   /* 0. empty buffer */
+        0,
+        0
+    },
+    {   /* 1. cursor at the beginning */
+        3 * BLOCK_SIZE + 321,
+        0
+    },
+    {   /* 2. cursor in the middle */
+        3 * BLOCK_SIZE + 321,
+        BLOCK_SIZE + 100
+    },
+    {   /* 3. more blocks than written at once */
+        100 * BLOCK_SIZE + 1,
+        50 * BLOCK_SIZE
+    },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_edit_buffer_write_file_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_buffer_write_file, test_edit_buffer_write_file_ds)
+/* *INDENT-ON* */
+{
+    vfs_path_t *vpath;
+    int fd;
+    off_t i;
+    gchar *content = NULL;
+    gsize len = 0;
+
+    /* given */
+    etalon = g_string_sized_new (data->size);
+    edit_buffer_init (&buf, 0);
+    buf.curs_line = 0;
+    for (i = 0; i < data->size; i++)
+    {
+        char c;
+
+        c = (i % 41 == 40) ? '\n' : 'a' + i % 26;
+        g_string_append_c (etalon, c);
+        edit_buffer_insert (&buf, c);
+    }
+    edit_buffer_move_gap (&buf, data->cursor - buf.curs1);
+
+    strcpy (test_file_name, "editbuffer__edit_buffer_write_file.XXXXXX");
+    fd = mkstemp (test_file_name);
+    mctest_assert_true (fd >= 0);
+    close (fd);
+
+    vpath = vfs_path_from_str (test_file_name);
+    fd = mc_open (vpath, O_WRONLY | O_TRUNC);
+    vfs_path_free (vpath);
+    mctest_assert_true (fd >= 0);
+
+    /* when */
+    mctest_assert_int_eq (edit_buffer_write_file (&buf, fd), data->size);
+    mc_close (fd);
+
+    /* then */
+    mctest_assert_true (g_file_get_contents (test_file_name, &content, &len, NULL));
+    mctest_assert_int_eq (len, etalon->len);
+    mctest_assert_int_eq (memcmp (content, etalon->str, len), 0);
+    g_free (content);
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_edit_buffer_write_file,
+                                   test_edit_buffer_write_file_ds);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
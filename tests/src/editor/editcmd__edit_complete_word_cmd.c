@@ -167,6 +167,8 @@ my_setup (void)
                         "editor_wordcompletion_collect_all_files", TRUE);
 
     option_filesize_threshold = (char *) "64M";
+    option_mmap_threshold = (char *) "64M";
+    option_max_undo_size = (char *) "8M";
 
     test_edit = edit_init (NULL, 0, 0, 24, 80, vfs_path_from_str ("test-data.txt"), 1);
     memset (&owner, 0, sizeof (owner));
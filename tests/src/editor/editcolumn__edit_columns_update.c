@@ -0,0 +1,165 @@
+/*
+   src/editor - tests for index of columns of long lines of editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/editcolumn.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_columns_t columns;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    off_t i;
+
+    edit_columns_init (&columns);
+
+    /* line at 1000 with tabs: column is twice the distance */
+    for (i = 1; i <= 4; i++)
+        edit_columns_add (&columns, 1000, 1000 + i * EDIT_COLUMN_STEP, i * 2 * EDIT_COLUMN_STEP);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_columns_clean (&columns);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_columns_lookup)
+/* *INDENT-ON* */
+{
+    long col;
+
+    /* unknown line */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 0, 0, 100000, &col), 0);
+    mctest_assert_int_eq (col, 0);
+
+    /* offset to column */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 0, 1000 + 2 * EDIT_COLUMN_STEP,
+                                               &col), 1000 + 2 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 4 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 0, 1000 + 2 * EDIT_COLUMN_STEP - 1,
+                                               &col), 1000 + EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 2 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 0, 1001, &col), 1000);
+    mctest_assert_int_eq (col, 0);
+
+    /* column to offset: checkpoint must be before the column */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 4 * EDIT_COLUMN_STEP, 0, &col),
+                          1000 + EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 2 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 100 * EDIT_COLUMN_STEP, 0, &col),
+                          1000 + 4 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 8 * EDIT_COLUMN_STEP);
+
+    /* checkpoints out of order are ignored */
+    edit_columns_add (&columns, 1000, 1000 + EDIT_COLUMN_STEP / 2, 1);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 0, 1000 + EDIT_COLUMN_STEP, &col),
+                          1000 + EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 2 * EDIT_COLUMN_STEP);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_columns_update)
+/* *INDENT-ON* */
+{
+    long col;
+
+    /* when: change above the line */
+    edit_columns_update (&columns, 10, 5, 105);
+    /* then */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1000, 0, 100000, &col), 1000);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1100, 0, 100000, &col),
+                          1100 + 4 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 8 * EDIT_COLUMN_STEP);
+
+    /* when: change in the line */
+    edit_columns_update (&columns, 1100 + 2 * EDIT_COLUMN_STEP + 1, 1, 0);
+    /* then: checkpoints after the change are removed */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1100, 0, 100000, &col),
+                          1100 + 2 * EDIT_COLUMN_STEP);
+    mctest_assert_int_eq (col, 4 * EDIT_COLUMN_STEP);
+
+    /* when: change at the checkpoint */
+    edit_columns_update (&columns, 1100 + 2 * EDIT_COLUMN_STEP, 0, 1);
+    /* then */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1100, 0, 100000, &col),
+                          1100 + EDIT_COLUMN_STEP);
+
+    /* when: newline before the line is deleted */
+    edit_columns_update (&columns, 1099, 1, 0);
+    /* then: the line is forgotten */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1100, 0, 100000, &col), 1100);
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1099, 0, 100000, &col), 1099);
+    mctest_assert_int_eq (col, 0);
+
+    /* when: settings are changed */
+    edit_columns_add (&columns, 1099, 1099 + EDIT_COLUMN_STEP, 2 * EDIT_COLUMN_STEP);
+    edit_columns_reset (&columns);
+    /* then: all lines are forgotten */
+    mctest_assert_int_eq (edit_columns_lookup (&columns, 1099, 0, 100000, &col), 1099);
+    mctest_assert_int_eq (col, 0);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_columns_lookup);
+    tcase_add_test (tc_core, test_edit_columns_update);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,215 @@
+/*
+   src/editor - tests for markers of positions in editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/editmarker.h"
+
+#include "edit__common.c"
+
+/* --------------------------------------------------------------------------------------------- */
+
+#define ETALON_SIZE 300
+
+static edit_markers_t markers;
+
+/* positions and values of markers kept in a plain array */
+static off_t etalon_pos[ETALON_SIZE];
+static int etalon_value[ETALON_SIZE];
+static guint etalon_len;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_marker (off_t pos, int value)
+{
+    guint i;
+
+    for (i = etalon_len; i != 0 && etalon_pos[i - 1] > pos; i--)
+    {
+        etalon_pos[i] = etalon_pos[i - 1];
+        etalon_value[i] = etalon_value[i - 1];
+    }
+    etalon_pos[i] = pos;
+    etalon_value[i] = value;
+    etalon_len++;
+
+    mctest_assert_int_eq (edit_markers_insert (&markers, pos, value), i);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+remove_marker (guint index)
+{
+    etalon_len--;
+    memmove (etalon_pos + index, etalon_pos + index + 1, (etalon_len - index) * sizeof (off_t));
+    memmove (etalon_value + index, etalon_value + index + 1, (etalon_len - index) * sizeof (int));
+
+    edit_markers_remove (&markers, index);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+shift_markers (off_t pos, off_t delta)
+{
+    guint i;
+
+    for (i = 0; i < etalon_len; i++)
+        if (etalon_pos[i] > pos)
+            etalon_pos[i] = MAX (etalon_pos[i] + delta, pos);
+
+    edit_markers_shift (&markers, pos, delta);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_markers (void)
+{
+    guint i;
+
+    mctest_assert_int_eq (edit_markers_count (&markers), etalon_len);
+
+    for (i = 0; i < etalon_len; i++)
+    {
+        mctest_assert_int_eq (edit_markers_get_pos (&markers, i), etalon_pos[i]);
+        mctest_assert_int_eq (edit_markers_get_value (&markers, i), etalon_value[i]);
+        mctest_assert_int_eq (edit_markers_get_pos (&markers, edit_markers_find (&markers,
+                                                                                 etalon_pos[i])),
+                              etalon_pos[i]);
+    }
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    edit_markers_init (&markers);
+    etalon_len = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_markers_clean (&markers);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_markers_insert)
+/* *INDENT-ON* */
+{
+    /* empty set */
+    mctest_assert_int_eq (edit_markers_count (&markers), 0);
+    mctest_assert_int_eq (edit_markers_find (&markers, 10), 0);
+    edit_markers_shift (&markers, 0, 10);
+    edit_markers_remove_value (&markers, 1);
+
+    /* markers at the same position are kept in order of insertion */
+    insert_marker (10, 1);
+    insert_marker (20, 2);
+    insert_marker (10, 3);
+    insert_marker (5, 4);
+    check_markers ();
+    mctest_assert_int_eq (edit_markers_find (&markers, 10), 1);
+    mctest_assert_int_eq (edit_markers_find (&markers, 11), 3);
+    mctest_assert_int_eq (edit_markers_find (&markers, 21), 4);
+
+    /* remove by value */
+    edit_markers_remove_value (&markers, 3);
+    remove_marker (2);
+    check_markers ();
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_markers_shift)
+/* *INDENT-ON* */
+{
+    int i;
+
+    for (i = 0; i < 2000; i++)
+    {
+        off_t pos;
+        int op;
+
+        op = (int) test_random (8);
+        pos = (off_t) test_random (1000);
+
+        if (op == 0 && etalon_len < ETALON_SIZE)
+            insert_marker (pos, i);
+        else if (op == 1 && etalon_len < ETALON_SIZE)
+            /* add to the end */
+            insert_marker (etalon_len == 0 ? pos : etalon_pos[etalon_len - 1] + pos % 3, i);
+        else if (op == 2 && etalon_len != 0)
+            remove_marker (pos % etalon_len);
+        else if (op < 5)
+            shift_markers (pos, (off_t) test_random (7) + 1);
+        else
+            shift_markers (pos, -(off_t) test_random (30) - 1);
+
+        if (i % 50 == 0)
+            check_markers ();
+    }
+
+    check_markers ();
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_markers_insert);
+    tcase_add_test (tc_core, test_edit_markers_shift);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
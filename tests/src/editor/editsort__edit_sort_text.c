@@ -0,0 +1,145 @@
+/*
+   src/editor - tests for sorting of lines of text
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/editsort.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @DataSource("test_edit_sort_text_ds") */
+/* *INDENT-OFF* */
+static const struct test_edit_sort_text_ds
+{
+    const char *input_text;
+    const char *input_options;
+    const char *expected_text;
+} test_edit_sort_text_ds[] =
+{
+    { "", "", "" },
+    { "b\na\nc", "", "a\nb\nc\n" },
+    { "b\na\nc\n", "-r", "c\nb\na\n" },
+    { "B\na\nb\nA\n", "", "A\nB\na\nb\n" },
+    { "B\na\nb\nA\n", "-f -s", "a\nA\nB\nb\n" },
+    { "10\n9\n-1\n-0\n0.5\n\n", "-n", "-1\n\n-0\n0.5\n9\n10\n" },
+    { "10\n9\n100\n", "--numeric-sort --reverse", "100\n10\n9\n" },
+    { "a\nb\na\nb\n", "-u", "a\nb\n" },
+    { "A\na\nB\n", "-fu", "A\nB\n" },
+    { "v1.10\nv1.9\nv1.09a\n", "-V", "v1.9\nv1.09a\nv1.10\n" },
+    { "x 3\ny 1\nz 2\n", "-k2", "y 1\nz 2\nx 3\n" },
+    { "x 3 a\ny 1 c\nz 1 b\n", "-k 2,2n -k3r", "y 1 c\nz 1 b\nx 3 a\n" },
+    { "a,3\nb,10\nc,2\n", "-t , -k2n", "c,2\na,3\nb,10\n" },
+    { "a:3:x\nb:3:a\nc:1:z\n", "'-t:' -k2,2 -s", "c:1:z\na:3:x\nb:3:a\n" },
+    { "  b\na\n", "-b", "a\n  b\n" },
+    { "xb1\nxa2\n", "-k1.2", "xa2\nxb1\n" },
+    /* not supported: sort(1) has to be used */
+    { "a\n", "-h", NULL },
+    { "a\n", "-o file", NULL },
+    { "a\n", "file", NULL },
+    { "a\n", "-k", NULL },
+    { "a\n", "-t ab", NULL },
+};
+/* *INDENT-ON* */
+
+/* @Test(dataSource = "test_edit_sort_text_ds") */
+/* *INDENT-OFF* */
+START_PARAMETRIZED_TEST (test_edit_sort_text, test_edit_sort_text_ds)
+/* *INDENT-ON* */
+{
+    /* given */
+    GString *actual_text;
+
+    /* when */
+    actual_text =
+        edit_sort_text (data->input_text, strlen (data->input_text), data->input_options);
+
+    /* then */
+    if (data->expected_text == NULL)
+        mctest_assert_null (actual_text);
+    else
+    {
+        mctest_assert_not_null (actual_text);
+        mctest_assert_str_eq (actual_text->str, data->expected_text);
+        g_string_free (actual_text, TRUE);
+    }
+}
+/* *INDENT-OFF* */
+END_PARAMETRIZED_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_sort_text_large)
+/* *INDENT-ON* */
+{
+    /* given */
+    GString *text, *actual_text;
+    const char *p, *prev = NULL;
+    int i;
+
+    text = g_string_new (NULL);
+    for (i = 0; i < 100000; i++)
+        g_string_append_printf (text, "%d\n", (i * 7919) % 100003);
+
+    /* when */
+    actual_text = edit_sort_text (text->str, text->len, "-n");
+
+    /* then */
+    mctest_assert_not_null (actual_text);
+    mctest_assert_int_eq (actual_text->len, text->len);
+
+    for (p = actual_text->str; *p != '\0'; p = strchr (p, '\n') + 1)
+    {
+        if (prev != NULL)
+            mctest_assert_true (atoi (prev) <= atoi (p));
+        prev = p;
+    }
+
+    g_string_free (actual_text, TRUE);
+    g_string_free (text, TRUE);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    /* Add new tests here: *************** */
+    mctest_add_parameterized_test (tc_core, test_edit_sort_text, test_edit_sort_text_ds);
+    tcase_add_test (tc_core, test_edit_sort_text_large);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
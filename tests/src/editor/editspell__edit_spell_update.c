@@ -0,0 +1,264 @@
+/*
+   src/editor - tests for misspelled words of editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+#include "src/editor/editspell.h"
+
+#include "edit__common.c"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_buffer_t buf;
+static edit_spell_t spell;
+static guint check_count;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* words with 'x' are misspelled */
+static gboolean
+check_word (const char *word, gsize len)
+{
+    check_count++;
+    mctest_assert_int_eq (strlen (word), len);
+    return (strchr (word, 'x') == NULL);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_text (off_t offset, const char *text, off_t len)
+{
+    test_buffer_insert (&buf, offset, text, (gsize) len);
+    edit_spell_update (&spell, offset, 0, len);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+delete_text (off_t offset, off_t len)
+{
+    test_buffer_delete (&buf, offset, len);
+    edit_spell_update (&spell, offset, len, 0);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+check_word_at (off_t pos, off_t start, off_t finish)
+{
+    off_t s, f;
+
+    mctest_assert_true (edit_spell_get_word (&spell, pos, &s, &f));
+    mctest_assert_int_eq (s, start);
+    mctest_assert_int_eq (f, finish);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check that misspelled words in checked text are the same as ones found from scratch.
+ */
+
+static void
+check_words (void)
+{
+    edit_spell_t etalon;
+    guint i;
+
+    edit_spell_init (&etalon);
+    while (edit_spell_scan (&etalon, &buf, 1000, check_word))
+        ;
+
+    for (i = 0; i < edit_markers_count (&etalon.words); i++)
+    {
+        off_t start, finish;
+
+        start = edit_markers_get_pos (&etalon.words, i);
+        finish = start + edit_markers_get_value (&etalon.words, i);
+        if (edit_spell_is_checked (&spell, start, finish))
+            check_word_at (start, start, finish);
+    }
+
+    for (i = 0; i < edit_markers_count (&spell.words); i++)
+    {
+        off_t start, finish;
+
+        start = edit_markers_get_pos (&spell.words, i);
+        finish = start + edit_markers_get_value (&spell.words, i);
+        if (edit_spell_is_checked (&spell, start, finish))
+        {
+            off_t s, f;
+
+            mctest_assert_true (edit_spell_get_word (&etalon, start, &s, &f));
+            mctest_assert_int_eq (s, start);
+            mctest_assert_int_eq (f, finish);
+        }
+    }
+
+    edit_spell_clean (&etalon);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    edit_buffer_init (&buf, 0);
+    buf.curs_line = 0;
+    edit_spell_init (&spell);
+    check_count = 0;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_spell_clean (&spell);
+    edit_buffer_clean (&buf);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_spell_scan)
+/* *INDENT-ON* */
+{
+    const char *text = "one twxo,three\nfoxur x86 sixty\n"
+        "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx";
+
+    /* given */
+    insert_text (0, text, (off_t) strlen (text));
+
+    /* when: check in small parts */
+    while (edit_spell_scan (&spell, &buf, 3, check_word))
+        ;
+
+    /* then: words with digits and too long words aren't checked */
+    mctest_assert_int_eq (edit_markers_count (&spell.words), 3);
+    check_word_at (0, 4, 8);
+    check_word_at (8, 15, 20);
+    check_word_at (20, 25, 30);
+    mctest_assert_true (edit_spell_is_checked (&spell, 0, buf.size));
+    mctest_assert_int_eq (check_count, 5);
+
+    /* when: a word is changed */
+    delete_text (29, 1);
+    /* then */
+    mctest_assert_int_eq (edit_markers_count (&spell.words), 2);
+    mctest_assert_true (!edit_spell_is_checked (&spell, 25, 29));
+    edit_spell_scan (&spell, &buf, 1, check_word);
+    mctest_assert_true (edit_spell_is_checked (&spell, 0, buf.size));
+    check_word_at (20, 25, 29);
+
+    /* when: words are joined */
+    delete_text (3, 1);
+    insert_text (0, "ex ", 3);
+    while (edit_spell_scan (&spell, &buf, 1, check_word))
+        ;
+    /* then */
+    check_word_at (0, 0, 2);
+    check_word_at (2, 3, 10);
+    check_word_at (10, 17, 22);
+    check_words ();
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_spell_update)
+/* *INDENT-ON* */
+{
+    static const char chars[] = "abxcd x \n.,-";
+    int i;
+
+    for (i = 0; i < 3000; i++)
+    {
+        char text[16];
+        off_t pos, len;
+        int op, j;
+
+        op = (int) test_random (6);
+        pos = (off_t) test_random ((guint) buf.size + 1);
+        len = (off_t) test_random (sizeof (text));
+
+        if (op < 2)
+        {
+            for (j = 0; j < len; j++)
+                text[j] = chars[test_random (sizeof (chars) - 1)];
+            insert_text (pos, text, len);
+        }
+        else if (op == 2)
+            delete_text (pos, MIN (len % 8, buf.size - pos));
+        else if (op == 3)
+            edit_spell_scan (&spell, &buf, len * 4 + 1, check_word);
+        else if (op == 4)
+            check_words ();
+        else if (i % 100 == 5)
+        {
+            while (edit_spell_scan (&spell, &buf, len * 4 + 1, check_word))
+                ;
+            mctest_assert_true (edit_spell_is_checked (&spell, 0, buf.size));
+            check_words ();
+        }
+    }
+
+    while (edit_spell_scan (&spell, &buf, 100, check_word))
+        ;
+    mctest_assert_true (edit_spell_is_checked (&spell, 0, buf.size));
+    check_words ();
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_spell_scan);
+    tcase_add_test (tc_core, test_edit_spell_update);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
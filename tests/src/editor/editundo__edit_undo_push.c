@@ -0,0 +1,226 @@
+/*
+   src/editor - tests for undo journal of editor
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editundo.h"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_undo_t undo;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    edit_undo_init (&undo, 64 * 1024);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_undo_clean (&undo);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_undo_runs)
+/* *INDENT-ON* */
+{
+    int i;
+
+    /* when */
+    edit_undo_push (&undo, KEY_PRESS + 10, 1);
+    edit_undo_push (&undo, KEY_PRESS + 10, 1);
+    for (i = 0; i < 10000; i++)
+        edit_undo_push (&undo, 256 + 'a' + i % 26, 1);
+    edit_undo_push (&undo, CURS_LEFT, 100);
+    edit_undo_push (&undo, CURS_RIGHT, 30);
+    edit_undo_push (&undo, BACKSPACE, 5);
+    edit_undo_push (&undo, CURS_RIGHT, 3);
+    edit_undo_push (&undo, CURS_LEFT, 3);
+    edit_undo_push (&undo, BACKSPACE, 2);
+
+    /* then */
+    mctest_assert_int_eq (undo.records->len, 4);
+    mctest_assert_int_eq (undo.size < 20000, TRUE);
+
+    mctest_assert_int_eq (edit_undo_pop (&undo), BACKSPACE);
+    mctest_assert_int_eq (edit_undo_pop_run (&undo, BACKSPACE), 6);
+    mctest_assert_int_eq (edit_undo_pop (&undo), CURS_LEFT);
+    mctest_assert_int_eq (edit_undo_pop_run (&undo, CURS_LEFT), 69);
+    for (i = 9999; i >= 0; i--)
+        mctest_assert_int_eq (edit_undo_pop (&undo), 256 + 'a' + i % 26);
+    mctest_assert_int_eq (edit_undo_pop (&undo), KEY_PRESS + 10);
+    mctest_assert_int_eq (edit_undo_pop (&undo), STACK_BOTTOM);
+    mctest_assert_int_eq (undo.size, 0);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_undo_evict)
+/* *INDENT-ON* */
+{
+    int i;
+
+    /* when: old groups don't fit */
+    for (i = 0; i < 1000; i++)
+    {
+        edit_undo_push (&undo, KEY_PRESS + i, 1);
+        edit_undo_push (&undo, 'x', 100);
+    }
+
+    /* then: the oldest groups are dropped as a whole */
+    mctest_assert_int_eq (undo.size <= undo.limit, TRUE);
+    mctest_assert_int_eq (g_array_index (undo.records, edit_undo_record_t, 0).action >= KEY_PRESS,
+                          TRUE);
+    mctest_assert_int_eq (edit_undo_pop (&undo), 'x');
+
+    /* when: the current group doesn't fit */
+    edit_undo_push (&undo, KEY_PRESS, 1);
+    edit_undo_push (&undo, 'y', 100 * 1024);
+    edit_undo_push (&undo, 'z', 1);
+
+    /* then: it is dropped together with the rest of its actions */
+    mctest_assert_int_eq (edit_undo_peek (&undo), STACK_BOTTOM);
+
+    /* when */
+    edit_undo_push (&undo, KEY_PRESS + 1, 1);
+    edit_undo_push (&undo, 'z', 1);
+
+    /* then: the next group is recorded */
+    mctest_assert_int_eq (edit_undo_pop (&undo), 'z');
+    mctest_assert_int_eq (edit_undo_pop (&undo), KEY_PRESS + 1);
+    mctest_assert_int_eq (edit_undo_pop (&undo), STACK_BOTTOM);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_undo_log)
+/* *INDENT-ON* */
+{
+    char name[] = "editundo__edit_undo_push.XXXXXX";
+    int fd, i;
+    off_t cursor = 0;
+
+    fd = mkstemp (name);
+    mctest_assert_true (fd >= 0);
+    close (fd);
+
+    undo.limit = 0;
+    edit_undo_push (&undo, KEY_PRESS, 1);
+    for (i = 0; i < 100000; i++)
+        edit_undo_push (&undo, 'a' + i % 26, 1);
+    edit_undo_push (&undo, KEY_PRESS + 1, 1);
+    edit_undo_push (&undo, CURS_LEFT, 7);
+
+    /* when */
+    mctest_assert_int_eq (edit_undo_save (&undo, name, 1000, 12345, 99), TRUE);
+    edit_undo_reset (&undo);
+    /* then: log is saved for other file */
+    mctest_assert_int_eq (edit_undo_load (&undo, name, 1000, 12346, &cursor), FALSE);
+
+    /* when: append to the log */
+    mctest_assert_int_eq (edit_undo_load (&undo, name, 1000, 12345, &cursor), TRUE);
+    mctest_assert_int_eq (cursor, 99);
+    mctest_assert_int_eq (undo.records->len, 0);
+    edit_undo_push (&undo, KEY_PRESS + 2, 1);
+    edit_undo_push (&undo, DELCHAR, 3);
+    mctest_assert_int_eq (edit_undo_save (&undo, name, 1000, 12345, 98), TRUE);
+    edit_undo_reset (&undo);
+    mctest_assert_int_eq (edit_undo_load (&undo, name, 1000, 12345, &cursor), TRUE);
+    mctest_assert_int_eq (cursor, 98);
+
+    /* then: records are read back from the log */
+    mctest_assert_int_eq (edit_undo_pop (&undo), DELCHAR);
+    mctest_assert_int_eq (edit_undo_pop_run (&undo, DELCHAR), 2);
+    mctest_assert_int_eq (edit_undo_pop (&undo), KEY_PRESS + 2);
+    mctest_assert_int_eq (edit_undo_pop (&undo), CURS_LEFT);
+    mctest_assert_int_eq (edit_undo_pop_run (&undo, CURS_LEFT), 6);
+    mctest_assert_int_eq (edit_undo_pop (&undo), KEY_PRESS + 1);
+    mctest_assert_int_eq (undo.log != NULL, TRUE);
+
+    /* when: rewrite the log which is partially read back */
+    mctest_assert_int_eq (edit_undo_save (&undo, name, 1000, 12345, 97), TRUE);
+    edit_undo_reset (&undo);
+    mctest_assert_int_eq (edit_undo_load (&undo, name, 1000, 12345, &cursor), TRUE);
+
+    /* then */
+    for (i = 99999; i >= 0; i--)
+        mctest_assert_int_eq (edit_undo_pop (&undo), 'a' + i % 26);
+    mctest_assert_int_eq (edit_undo_pop (&undo), KEY_PRESS);
+    mctest_assert_int_eq (edit_undo_pop (&undo), STACK_BOTTOM);
+    mctest_assert_int_eq (undo.log == NULL, TRUE);
+
+    /* when: empty journal removes the log */
+    mctest_assert_int_eq (edit_undo_save (&undo, name, 1000, 12345, 0), TRUE);
+    /* then */
+    mctest_assert_int_eq (access (name, F_OK), -1);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_undo_runs);
+    tcase_add_test (tc_core, test_edit_undo_evict);
+    tcase_add_test (tc_core, test_edit_undo_log);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
@@ -0,0 +1,219 @@
+/*
+   src/editor - tests for index of words of editor buffer
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "src/editor/edit-impl.h"
+#include "src/editor/editbuffer.h"
+#include "src/editor/editwords.h"
+
+#include "edit__common.c"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static edit_buffer_t buf;
+static edit_words_t words;
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+fill_buffer (const char *text)
+{
+    edit_buffer_init (&buf, 0);
+    buf.curs_line = 0;
+    test_buffer_insert (&buf, 0, text, strlen (text));
+
+    edit_words_init (&words);
+    edit_words_build (&words, &buf);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static guint
+count_words (const edit_words_t * w, const char *prefix, const char *word)
+{
+    GHashTable *found;
+    guint count;
+
+    found = g_hash_table_new (g_str_hash, g_str_equal);
+    edit_words_collect (w, prefix, strlen (prefix), found);
+    count = GPOINTER_TO_UINT (g_hash_table_lookup (found, word));
+    g_hash_table_destroy (found);
+
+    return count;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_text (off_t offset, const char *text)
+{
+    edit_words_update (&words, &buf, offset, offset, -1);
+    test_buffer_insert (&buf, offset, text, strlen (text));
+    edit_words_update (&words, &buf, offset, buf.curs1, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+delete_text (off_t offset, off_t len)
+{
+    edit_words_update (&words, &buf, offset, offset + len, -1);
+    test_buffer_delete (&buf, offset, len);
+    edit_words_update (&words, &buf, offset, offset, 1);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+/**
+ * Check that the updated index is the same as one built from scratch.
+ */
+
+static void
+check_index (const char *prefix)
+{
+    edit_words_t etalon;
+    GHashTable *found, *expected;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    edit_words_init (&etalon);
+    edit_words_build (&etalon, &buf);
+
+    found = g_hash_table_new (g_str_hash, g_str_equal);
+    expected = g_hash_table_new (g_str_hash, g_str_equal);
+    edit_words_collect (&words, prefix, strlen (prefix), found);
+    edit_words_collect (&etalon, prefix, strlen (prefix), expected);
+
+    mctest_assert_int_eq (g_hash_table_size (found), g_hash_table_size (expected));
+
+    g_hash_table_iter_init (&iter, expected);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+        mctest_assert_int_eq (GPOINTER_TO_UINT (g_hash_table_lookup (found, key)),
+                              GPOINTER_TO_UINT (value));
+
+    g_hash_table_destroy (expected);
+    g_hash_table_destroy (found);
+    edit_words_clean (&etalon);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    edit_words_clean (&words);
+    edit_buffer_clean (&buf);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_words_build)
+/* *INDENT-ON* */
+{
+    /* given */
+    fill_buffer ("foo foobar\nfoo(bar) <foobaz> foo.bar");
+
+    /* then */
+    mctest_assert_int_eq (count_words (&words, "fo", "foo"), 3);
+    mctest_assert_int_eq (count_words (&words, "fo", "foobar"), 1);
+    /* word inside "<foobaz>" */
+    mctest_assert_int_eq (count_words (&words, "fo", "foobaz>"), 1);
+    mctest_assert_int_eq (count_words (&words, "<", "<foobaz>"), 1);
+    /* prefix itself is not a completion */
+    mctest_assert_int_eq (count_words (&words, "foo", "foo"), 0);
+    mctest_assert_int_eq (count_words (&words, "ba", "bar"), 2);
+    mctest_assert_int_eq (count_words (&words, "x", "foo"), 0);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_words_update)
+/* *INDENT-ON* */
+{
+    /* given */
+    fill_buffer ("alpha beta alphabet\ngamma alpha");
+
+    /* when: split a word */
+    insert_text (3, " ");
+    /* then */
+    check_index ("a");
+    check_index ("h");
+    mctest_assert_int_eq (count_words (&words, "al", "alpha"), 1);
+
+    /* when: join words */
+    delete_text (3, 1);
+    delete_text (5, 1);
+    /* then */
+    check_index ("a");
+    check_index ("b");
+    mctest_assert_int_eq (count_words (&words, "al", "alphabeta"), 1);
+
+    /* when: replace words across lines */
+    delete_text (10, 13);
+    insert_text (10, "delta\nalpha(x)");
+    /* then */
+    check_index ("a");
+    check_index ("d");
+    check_index ("x");
+    mctest_assert_int_eq (count_words (&words, "al", "alpha"), 2);
+
+    /* when: change at both ends of buffer */
+    insert_text (0, "z");
+    insert_text (buf.size, "z");
+    /* then */
+    check_index ("z");
+    check_index ("a");
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, NULL, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_words_build);
+    tcase_add_test (tc_core, test_edit_words_update);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */
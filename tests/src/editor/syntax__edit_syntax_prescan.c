@@ -0,0 +1,159 @@
+/*
+   src/editor - tests for edit_syntax_prescan() function
+
+   Copyright (C) 2020
+   Free Software Foundation, Inc.
+
+   This file is part of the Midnight Commander.
+
+   The Midnight Commander is free software: you can redistribute it
+   and/or modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the License,
+   or (at your option) any later version.
+
+   The Midnight Commander is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_SUITE_NAME "/src/editor"
+
+#include "tests/mctest.h"
+
+#include "lib/tty/color-internal.h" /* use_colors */
+
+#include "src/editor/syntax.c"
+
+#include "edit__common.c"
+
+/* --------------------------------------------------------------------------------------------- */
+
+static WEdit edit;
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* rule set with the default context and C comments */
+static GPtrArray *
+make_rules (void)
+{
+    GPtrArray *rules;
+    context_rule_t *r;
+
+    rules = g_ptr_array_new ();
+    g_ptr_array_add (rules, g_new0 (context_rule_t, 1));
+
+    r = g_new0 (context_rule_t, 1);
+    r->left = g_strdup ("/*");
+    r->first_left = '/';
+    r->right = g_strdup ("*/");
+    r->first_right = '*';
+    g_ptr_array_add (rules, r);
+
+    return rules;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+static void
+insert_text (off_t offset, const char *text)
+{
+    test_buffer_insert (&edit.buffer, offset, text, strlen (text));
+    edit_syntax_changed (&edit, offset, 0, (off_t) strlen (text));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* prescan the whole file in small parts, fail if it doesn't finish */
+static void
+prescan (void)
+{
+    int i;
+
+    for (i = 0; edit_syntax_prescan (&edit, 100); i++)
+        mctest_assert_true (i < 1000);
+
+    mctest_assert_int_eq (edit.syntax_dirty, -1);
+    mctest_assert_true (!edit_syntax_prescan_pending (&edit));
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Before */
+static void
+setup (void)
+{
+    int i;
+
+    memset (&edit, 0, sizeof (edit));
+    edit_buffer_init (&edit.buffer, 0);
+    for (i = 0; i < 100; i++)
+        edit_buffer_insert_string (&edit.buffer, "int a = b * c;\n", 15);
+    edit.rules = make_rules ();
+
+    use_colors = TRUE;
+    option_syntax_prescan = TRUE;
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @After */
+static void
+teardown (void)
+{
+    g_ptr_array_foreach (edit.rules, (GFunc) context_rule_free, NULL);
+    g_ptr_array_free (edit.rules, TRUE);
+    if (edit.syntax_marker != NULL)
+        g_array_free (edit.syntax_marker, TRUE);
+    edit_buffer_clean (&edit.buffer);
+}
+
+/* --------------------------------------------------------------------------------------------- */
+
+/* @Test */
+/* *INDENT-OFF* */
+START_TEST (test_edit_syntax_prescan_eof)
+/* *INDENT-ON* */
+{
+    /* given */
+    prescan ();
+
+    /* when: text is typed after the last checkpoint */
+    insert_text (edit.buffer.size, "int c;");
+    /* then */
+    mctest_assert_true (edit_syntax_prescan_pending (&edit));
+    prescan ();
+
+    /* when: a comment is opened and never closed */
+    insert_text (20, "/*");
+    /* then */
+    prescan ();
+    edit_get_rule (&edit, edit.buffer.size - 1);
+    mctest_assert_int_eq (edit.rule.context, 1);
+}
+/* *INDENT-OFF* */
+END_TEST
+/* *INDENT-ON* */
+
+/* --------------------------------------------------------------------------------------------- */
+
+int
+main (void)
+{
+    TCase *tc_core;
+
+    tc_core = tcase_create ("Core");
+
+    tcase_add_checked_fixture (tc_core, setup, teardown);
+
+    /* Add new tests here: *************** */
+    tcase_add_test (tc_core, test_edit_syntax_prescan_eof);
+    /* *********************************** */
+
+    return mctest_run_all (tc_core);
+}
+
+/* --------------------------------------------------------------------------------------------- */